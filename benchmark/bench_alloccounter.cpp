@@ -0,0 +1,33 @@
+#include <bench_base.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new and delete to count the heap allocations of a benchmark.
+
+static std::atomic<size_t> s_allocations{0};
+
+void* operator new(size_t size) {
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+
+namespace jex::bench {
+
+size_t getAllocationCount() {
+    return s_allocations.load();
+}
+
+} // namespace jex::bench
@@ -0,0 +1,127 @@
+#include <bench_base.hpp>
+
+#include <jex_arena.hpp>
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_parallelevaluator.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Compares temporaries of a user function taken from the global allocator against temporaries
+ * taken from the per-context arenas of the parallel evaluator's scratch contexts.
+ * Usage: bench_arena [iterations] [rowCount] [threads]
+ */
+
+// Lower-cases the input into temporary buffers of varying size and counts the words differing
+// from their predecessor.
+template <bool useArena>
+void countWords(int64_t* res, const std::string* in) {
+    size_t size = in->size();
+    std::unique_ptr<char[]> heapLower;
+    std::unique_ptr<size_t[]> heapStarts;
+    char* lower = nullptr;
+    size_t* starts = nullptr;
+    if constexpr (useArena) {
+        Arena* arena = Arena::current();
+        lower = static_cast<char*>(arena->allocate(size + 1, 1));
+        starts = static_cast<size_t*>(arena->allocate(sizeof(size_t) * (size + 1), alignof(size_t)));
+    } else {
+        heapLower = std::make_unique<char[]>(size + 1);
+        heapStarts = std::make_unique<size_t[]>(size + 1);
+        lower = heapLower.get();
+        starts = heapStarts.get();
+    }
+    size_t wordCount = 0;
+    for (size_t i = 0; i < size; ++i) {
+        char c = (*in)[i];
+        lower[i] = c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        if (c != ' ' && (i == 0 || (*in)[i - 1] == ' ')) {
+            starts[wordCount++] = i;
+        }
+    }
+    lower[size] = ' ';
+    int64_t changes = 0;
+    for (size_t w = 0; w < wordCount; ++w) {
+        const char* word = lower + starts[w];
+        size_t len = std::strchr(word, ' ') - word;
+        changes += w == 0 || std::strncmp(lower + starts[w - 1], word, len + 1) != 0;
+    }
+    *res = changes;
+}
+
+class WordsModule : public Module {
+    void registerTypes(Registry&) const override {}
+    void registerFcts(Registry& registry) const override {
+        registry.registerFct(FctDesc<ArgInteger, ArgString>("countWordsHeap", countWords<false>, NO_INTRINSIC, FctFlags::Pure));
+        registry.registerFct(FctDesc<ArgInteger, ArgString>("countWordsArena", countWords<true>, NO_INTRINSIC, FctFlags::Pure));
+    }
+};
+
+static double run(const Environment& env, const char* fctName, size_t arenaBlockSize,
+                  const std::vector<std::string>& lines, size_t iterations, size_t threads, int64_t& checksum) {
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O2;
+    std::string source = std::string("var line : String;\nexpr words : Integer = ") + fctName + "(line);\n";
+    CompileResult res = Compiler::compile(env, source.c_str(), options);
+    auto setLine = reinterpret_cast<void (*)(char*, const std::string*)>(res.getFctPtr("line"));
+    auto fctWords = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("words"));
+    ParallelEvaluator evaluator(res, threads, arenaBlockSize);
+    std::vector<int64_t> output(lines.size());
+    auto evaluate = [&](size_t begin, size_t end, ExecutionContext& scratch) {
+        for (size_t i = begin; i < end; ++i) {
+            setLine(scratch.getDataPtr(), &lines[i]);
+            output[i] = *fctWords(scratch.getDataPtr());
+            scratch.resetArena();
+        }
+    };
+    evaluator.run(lines.size(), 64, evaluate); // Warm up.
+    bench::Timer timer;
+    for (size_t i = 0; i < iterations; ++i) {
+        evaluator.run(lines.size(), 64, evaluate);
+    }
+    double sec = timer.elapsedSec();
+    for (int64_t words : output) {
+        checksum += words;
+    }
+    return sec / iterations / lines.size();
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 20);
+    size_t rowCount = bench::getArg(argc, argv, 2, 1 << 16);
+    size_t threads = bench::getArg(argc, argv, 3, std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::string> lines;
+    lines.reserve(rowCount);
+    const char* words[] = {"Alpha", "beta", "GAMMA", "delta", "alpha", "Epsilon", "zeta", "Beta"};
+    for (size_t i = 0; i < rowCount; ++i) {
+        std::string line;
+        for (size_t w = 0; w < 4 + i % 29; ++w) {
+            line += words[(i * 7 + w * 3) % 8];
+            line += ' ';
+        }
+        lines.push_back(std::move(line));
+    }
+    Environment env;
+    env.addModule(BuiltInsModule());
+    env.addModule(WordsModule());
+    int64_t heapChecksum = 0;
+    int64_t arenaChecksum = 0;
+    double heap = run(env, "countWordsHeap", 0, lines, iterations, threads, heapChecksum);
+    double arena = run(env, "countWordsArena", 64 * 1024, lines, iterations, threads, arenaChecksum);
+    bench::printResult("threads", static_cast<double>(threads), "");
+    bench::printResult("global allocator", heap * 1e9, "ns/row");
+    bench::printResult("context arena", arena * 1e9, "ns/row");
+    bench::printResult("speedup", heap / arena, "x");
+    return heapChecksum == arenaChecksum ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+namespace jex::bench {
+
+/**
+ * Measures wall time since construction.
+ */
+class Timer {
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point d_start = Clock::now();
+
+public:
+    double elapsedSec() const {
+        return std::chrono::duration<double>(Clock::now() - d_start).count();
+    }
+};
+
+/**
+ * Returns the resident set size of the current process in bytes.
+ */
+inline size_t getRssBytes() {
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    statm >> totalPages >> residentPages;
+    return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+/**
+ * Returns the numeric command line argument at the given position or the default value.
+ */
+inline size_t getArg(int argc, char* argv[], int pos, size_t defaultVal) {
+    return pos < argc ? std::strtoull(argv[pos], nullptr, 10) : defaultVal;
+}
+
+/**
+ * Returns the number of calls of the global operator new so far. Only available to benchmarks
+ * linking bench_alloccounter.cpp, which replaces the global operator new and delete.
+ */
+size_t getAllocationCount();
+
+inline void printResult(const std::string& name, double value, const char* unit) {
+    std::cout << std::left << std::setw(48) << name << std::right << std::setw(14)
+              << std::fixed << std::setprecision(2) << value << ' ' << unit << '\n';
+}
+
+} // namespace jex::bench
@@ -0,0 +1,71 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Compares evaluating an expr for many contexts with one call per context against one call of
+ * its batch variant.
+ * Usage: bench_batch [iterations] [rowCount]
+ */
+
+static const char* s_source =
+    "var x : Integer;\n"
+    "var y : Float;\n"
+    "expr score : Float = if(x > 100, y * 1.5, y * 0.5) + max(y, 10.0) * 0.25;\n";
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 1000);
+    size_t rowCount = bench::getArg(argc, argv, 2, 1000);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_batchFcts = true;
+    CompileResult res = Compiler::compile(env, s_source, options);
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto setY = reinterpret_cast<void (*)(char*, double*)>(res.getFctPtr("y"));
+    auto score = reinterpret_cast<double* (*)(char*)>(res.getFctPtr("score"));
+    auto scoreBatch = reinterpret_cast<void (*)(char**, int64_t, double**)>(res.getFctPtr("score.batch"));
+    std::vector<std::unique_ptr<ExecutionContext>> ctxs;
+    std::vector<char*> rctxs;
+    for (size_t i = 0; i < rowCount; ++i) {
+        ctxs.push_back(ExecutionContext::create(res));
+        rctxs.push_back(ctxs.back()->getDataPtr());
+        int64_t x = static_cast<int64_t>(i % 200);
+        double y = static_cast<double>(i);
+        setX(rctxs.back(), &x);
+        setY(rctxs.back(), &y);
+    }
+    std::vector<double*> results(rowCount);
+
+    double singleSum = 0;
+    bench::Timer singleTimer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        for (size_t i = 0; i < rowCount; ++i) {
+            results[i] = score(rctxs[i]);
+        }
+        singleSum += *results[iter % rowCount];
+    }
+    double singleSec = singleTimer.elapsedSec();
+
+    double batchSum = 0;
+    bench::Timer batchTimer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        scoreBatch(rctxs.data(), rowCount, results.data());
+        batchSum += *results[iter % rowCount];
+    }
+    double batchSec = batchTimer.elapsedSec();
+
+    size_t rows = iterations * rowCount;
+    bench::printResult("one call per row", singleSec * 1e9 / rows, "ns/row");
+    bench::printResult("batch call", batchSec * 1e9 / rows, "ns/row");
+    return singleSum == batchSum ? 0 : 1;
+}
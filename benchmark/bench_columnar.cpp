@@ -0,0 +1,105 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Compares the throughput of a numeric rule set evaluated per context (one call per expr and row,
+ * and one batch call per expr) with the columnar kernel.
+ * Usage: bench_columnar [iterations] [rowCount]
+ */
+
+static const char* s_source =
+    "var x : Integer;\n"
+    "var y : Float;\n"
+    "expr a : Float = if(x > 100, y * 1.5, y * 0.5) + y * 0.25;\n"
+    "expr b : Integer = max(x, 10) * 3 - x;\n"
+    "expr c : Float = a * 2.0 - 1.0;\n"
+    "expr d : Bool = x > 50 && y < 1000.0;\n";
+
+static const char* s_exprs[] = {"a", "b", "c", "d"};
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 1000);
+    size_t rowCount = bench::getArg(argc, argv, 2, 4096);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O3;
+    options.d_batchFcts = true;
+    options.d_columnar = true;
+    CompileResult res = Compiler::compile(env, s_source, options);
+    // Row-oriented input.
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto setY = reinterpret_cast<void (*)(char*, double*)>(res.getFctPtr("y"));
+    std::vector<std::unique_ptr<ExecutionContext>> ctxs;
+    std::vector<char*> rctxs;
+    // Columnar input and output.
+    std::vector<int64_t> x(rowCount);
+    std::vector<double> y(rowCount);
+    std::vector<double> a(rowCount);
+    std::vector<int64_t> b(rowCount);
+    std::vector<double> c(rowCount);
+    std::unique_ptr<bool[]> d(new bool[rowCount]);
+    for (size_t i = 0; i < rowCount; ++i) {
+        x[i] = static_cast<int64_t>(i % 200);
+        y[i] = static_cast<double>(i);
+        ctxs.push_back(ExecutionContext::create(res));
+        rctxs.push_back(ctxs.back()->getDataPtr());
+        setX(rctxs.back(), &x[i]);
+        setY(rctxs.back(), &y[i]);
+    }
+
+    using ExprFct = void* (*)(char*);
+    std::vector<ExprFct> exprFcts;
+    using BatchFct = void (*)(char**, int64_t, void**);
+    std::vector<BatchFct> batchFcts;
+    for (const char* expr : s_exprs) {
+        exprFcts.push_back(reinterpret_cast<ExprFct>(res.getFctPtr(expr)));
+        batchFcts.push_back(reinterpret_cast<BatchFct>(res.getFctPtr(std::string(expr) + ".batch")));
+    }
+    bench::Timer rowTimer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        for (char* rctx : rctxs) {
+            for (ExprFct fct : exprFcts) {
+                fct(rctx);
+            }
+        }
+    }
+    double rowSec = rowTimer.elapsedSec();
+
+    bench::Timer batchTimer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        for (BatchFct fct : batchFcts) {
+            fct(rctxs.data(), rowCount, nullptr);
+        }
+    }
+    double batchSec = batchTimer.elapsedSec();
+
+    auto evalColumns = reinterpret_cast<void (*)(void**, int64_t)>(res.getFctPtr("__eval_columns"));
+    void* columns[] = {x.data(), y.data(), a.data(), b.data(), c.data(), d.get()};
+    bench::Timer columnTimer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        evalColumns(columns, rowCount);
+    }
+    double columnSec = columnTimer.elapsedSec();
+
+    // Both paths have to compute the same results.
+    auto fctC = reinterpret_cast<double* (*)(char*)>(res.getFctPtr("c"));
+    size_t last = rowCount - 1;
+    bool valid = *fctC(rctxs[last]) == c[last];
+
+    size_t rows = iterations * rowCount;
+    bench::printResult("per context: one call per expr", rowSec * 1e9 / rows, "ns/row");
+    bench::printResult("per context: batch call per expr", batchSec * 1e9 / rows, "ns/row");
+    bench::printResult("columnar kernel", columnSec * 1e9 / rows, "ns/row");
+    return valid ? 0 : 1;
+}
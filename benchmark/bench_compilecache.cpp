@@ -0,0 +1,49 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compilecache.hpp>
+#include <jex_environment.hpp>
+
+#include <string>
+
+using namespace jex;
+
+/**
+ * Compares the latency of a compile cache miss (full compilation) with a cache hit for a source
+ * that only differs in whitespace.
+ * Usage: bench_compilecache [iterations]
+ */
+
+static std::string createSource(size_t i, const char* space) {
+    std::string num = std::to_string(i);
+    return std::string("var x : Integer;") + space +
+           "var s : String;" + space +
+           "expr a : Integer = x * " + num + " + 1;" + space +
+           "expr b : Bool = a > " + num + " && x < 100;" + space +
+           "expr c : String = substr(s, 0, " + num + " % 5);" + space;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = bench::getArg(argc, argv, 1, 200);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileCache cache;
+    cache.compile(env, createSource(count, "\n"));
+
+    bench::Timer missTimer;
+    for (size_t i = 0; i < count; ++i) {
+        cache.compile(env, createSource(i, "\n"))->getFctPtr("a");
+    }
+    double missSec = missTimer.elapsedSec();
+
+    bench::Timer hitTimer;
+    for (size_t i = 0; i < count; ++i) {
+        cache.compile(env, createSource(i, "  \n\t"))->getFctPtr("a");
+    }
+    double hitSec = hitTimer.elapsedSec();
+
+    bench::printResult("cache miss", missSec * 1e6 / count, "us/program");
+    bench::printResult("cache hit", hitSec * 1e6 / count, "us/program");
+    return cache.getHitCount() == count ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#include <bench_base.hpp>
+
+#include <jex_builtins.hpp>
+#include <jex_compileservice.hpp>
+#include <jex_environment.hpp>
+
+#include <algorithm>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Measures the compile throughput of a CompileService for an increasing number of worker threads.
+ * Usage: bench_compileservice [programCount]
+ */
+
+static std::string createSource(size_t i) {
+    std::string num = std::to_string(i);
+    return "var x : Integer;\n"
+           "var s : String;\n"
+           "expr a : Integer = x * " + num + " + 1;\n"
+           "expr b : Bool = a > " + num + " && x < 100;\n"
+           "expr c : String = substr(s, 0, " + num + " % 5);\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = bench::getArg(argc, argv, 1, 1000);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    bool success = true;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        CompileService service(env, threads);
+        std::vector<std::future<CompileResult>> results;
+        results.reserve(count);
+        bench::Timer timer;
+        for (size_t i = 0; i < count; ++i) {
+            results.push_back(service.submit(createSource(i)));
+        }
+        for (std::future<CompileResult>& result : results) {
+            success &= static_cast<bool>(result.get());
+        }
+        double sec = timer.elapsedSec();
+        bench::printResult(std::to_string(threads) + " threads", count / sec, "programs/s");
+    }
+    return success ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_contextpool.hpp>
+#include <jex_environment.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Compares the packed context layout with the hot/cold layout for a program interleaving value
+ * vars with strings by name. A value expr is evaluated on many contexts, so that the contexts
+ * don't fit into the cache and the number of cache lines touched per context dominates.
+ * Usage: bench_contextlayout [iterations] [contexts]
+ */
+
+static const char* source =
+    "var a0 : Integer;\n"
+    "var a1 : String;\n"
+    "var b0 : Integer;\n"
+    "var b1 : String;\n"
+    "var c0 : Integer;\n"
+    "var c1 : String;\n"
+    "var d0 : Integer;\n"
+    "var d1 : String;\n"
+    "expr e0 : Integer = a0 + b0 + c0 + d0;\n"
+    "expr e1 : String = join(\"-\", a1, b1, c1, d1);\n";
+
+static double run(const CompileOptions& options, size_t iterations, size_t contexts, int64_t& sum) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileResult res = Compiler::compile(env, source, options);
+    using SetFct = void (*)(char*, int64_t*);
+    std::vector<SetFct> setters;
+    for (const char* name : {"a0", "b0", "c0", "d0"}) {
+        setters.push_back(reinterpret_cast<SetFct>(res.getFctPtr(name)));
+    }
+    auto fctE0 = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("e0"));
+    ContextPool pool(res, contexts);
+    std::vector<char*> rctxs;
+    for (size_t i = 0; i < contexts; ++i) {
+        rctxs.push_back(pool.acquire());
+        for (SetFct setter : setters) {
+            int64_t val = static_cast<int64_t>(i);
+            setter(rctxs.back(), &val);
+        }
+    }
+    bench::Timer timer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        for (char* rctx : rctxs) {
+            sum += *fctE0(rctx);
+        }
+    }
+    return timer.elapsedSec();
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 20);
+    size_t contexts = bench::getArg(argc, argv, 2, 200000);
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O2;
+    options.d_resetFct = true;
+    int64_t packedSum = 0;
+    double packedSec = run(options, iterations, contexts, packedSum);
+    options.d_layout.d_splitHotCold = true;
+    int64_t hotColdSum = 0;
+    double hotColdSec = run(options, iterations, contexts, hotColdSum);
+    size_t evaluations = iterations * contexts;
+    bench::printResult("packed layout", packedSec * 1e9 / evaluations, "ns/evaluation");
+    bench::printResult("hot/cold layout", hotColdSec * 1e9 / evaluations, "ns/evaluation");
+    bench::printResult("speedup", packedSec / hotColdSec, "x");
+    return packedSum == hotColdSum ? 0 : 1;
+}
@@ -0,0 +1,79 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_contextpool.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Compares creating and destroying short-lived contexts with ExecutionContext::create against
+ * acquiring and releasing them from a ContextPool. Each round uses `live` contexts at once.
+ * Usage: bench_contextpool [rounds] [live]
+ */
+
+static const char* source =
+    "var x : Integer;\n"
+    "var y : Float;\n"
+    "var name : String;\n"
+    "expr a : Integer = x * 2;\n"
+    "expr b : Float = y + 1.5;\n"
+    "expr label : String = join(\"-\", name, String(a));\n";
+
+int main(int argc, char* argv[]) {
+    size_t rounds = bench::getArg(argc, argv, 1, 100000);
+    size_t live = bench::getArg(argc, argv, 2, 16);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O2;
+    options.d_resetFct = true;
+    CompileResult res = Compiler::compile(env, source, options);
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto fctA = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("a"));
+
+    int64_t createSum = 0;
+    std::vector<std::unique_ptr<ExecutionContext>> ctxs(live);
+    bench::Timer createTimer;
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i < live; ++i) {
+            ctxs[i] = ExecutionContext::create(res);
+            int64_t x = static_cast<int64_t>(i);
+            setX(ctxs[i]->getDataPtr(), &x);
+            createSum += *fctA(ctxs[i]->getDataPtr());
+        }
+        for (std::unique_ptr<ExecutionContext>& ctx : ctxs) {
+            ctx.reset();
+        }
+    }
+    double createSec = createTimer.elapsedSec();
+
+    int64_t poolSum = 0;
+    std::vector<char*> rctxs(live);
+    ContextPool pool(res);
+    bench::Timer poolTimer;
+    for (size_t round = 0; round < rounds; ++round) {
+        for (size_t i = 0; i < live; ++i) {
+            rctxs[i] = pool.acquire();
+            int64_t x = static_cast<int64_t>(i);
+            setX(rctxs[i], &x);
+            poolSum += *fctA(rctxs[i]);
+        }
+        for (char* rctx : rctxs) {
+            pool.release(rctx);
+        }
+    }
+    double poolSec = poolTimer.elapsedSec();
+
+    size_t contexts = rounds * live;
+    bench::printResult("create and destroy context", createSec * 1e9 / contexts, "ns/context");
+    bench::printResult("acquire and release pooled context", poolSec * 1e9 / contexts, "ns/context");
+    bench::printResult("speedup", createSec / poolSec, "x");
+    return createSum == poolSum ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Compares setting the vars through the generated setters and reading the result through the
+ * returned pointer with setting them by a single __set_all call and with accessing the context
+ * directly at the offsets of the layout descriptor.
+ * Usage: bench_directaccess [iterations] [varCount]
+ */
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 5000000);
+    size_t varCount = bench::getArg(argc, argv, 2, 8);
+    std::string source;
+    std::string sum;
+    for (size_t i = 0; i < varCount; ++i) {
+        source += "var v" + std::to_string(i) + " : Integer;\n";
+        sum += (i == 0 ? "v" : " + v") + std::to_string(i);
+    }
+    source += "expr sum : Integer = " + sum + ";\n";
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O2;
+    options.d_setAll = true;
+    CompileResult res = Compiler::compile(env, source, options);
+    using SetFct = void (*)(char*, int64_t*);
+    std::vector<SetFct> setters;
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < varCount; ++i) {
+        std::string name = "v" + std::to_string(i);
+        setters.push_back(reinterpret_cast<SetFct>(res.getFctPtr(name)));
+        offsets.push_back(res.findContextSlot(name)->d_offset);
+    }
+    auto fctSum = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("sum"));
+    auto setAll = reinterpret_cast<void (*)(char*, const int64_t*)>(res.getFctPtr("__set_all"));
+    size_t sumOffset = res.findContextSlot("sum")->d_offset;
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    char* rctx = ctx->getDataPtr();
+
+    int64_t setterTotal = 0;
+    bench::Timer setterTimer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        for (size_t i = 0; i < varCount; ++i) {
+            int64_t val = static_cast<int64_t>(iter + i);
+            setters[i](rctx, &val);
+        }
+        setterTotal += *fctSum(rctx);
+    }
+    double setterSec = setterTimer.elapsedSec();
+
+    // All vars are Integers, so the input record is an array.
+    std::vector<int64_t> input(varCount);
+    int64_t setAllTotal = 0;
+    bench::Timer setAllTimer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        for (size_t i = 0; i < varCount; ++i) {
+            input[i] = static_cast<int64_t>(iter + i);
+        }
+        setAll(rctx, input.data());
+        setAllTotal += *fctSum(rctx);
+    }
+    double setAllSec = setAllTimer.elapsedSec();
+
+    int64_t directTotal = 0;
+    bench::Timer directTimer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        for (size_t i = 0; i < varCount; ++i) {
+            *reinterpret_cast<int64_t*>(rctx + offsets[i]) = static_cast<int64_t>(iter + i);
+        }
+        fctSum(rctx);
+        directTotal += *reinterpret_cast<int64_t*>(rctx + sumOffset);
+    }
+    double directSec = directTimer.elapsedSec();
+
+    bench::printResult("set vars via setters", setterSec * 1e9 / iterations, "ns/iteration");
+    bench::printResult("set vars via __set_all", setAllSec * 1e9 / iterations, "ns/iteration");
+    bench::printResult("set vars via layout offsets", directSec * 1e9 / iterations, "ns/iteration");
+    bench::printResult("speedup __set_all", setterSec / setAllSec, "x");
+    bench::printResult("speedup layout offsets", setterSec / directSec, "x");
+    return setterTotal == setAllTotal && setterTotal == directTotal ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_handles.hpp>
+
+#include <string>
+
+using namespace jex;
+
+/**
+ * Compares requests looking up the setter and expr functions by name against requests calling
+ * handles bound once. Also compares binding all handles with single lookups against binding them
+ * from a bulk-resolved FctTable.
+ * Usage: bench_handles [requests]
+ */
+
+static const char* source =
+    "var x : Integer;\n"
+    "var y : Float;\n"
+    "expr a : Integer = x * 2;\n"
+    "expr b : Float = y + 1.5;\n";
+
+int main(int argc, char* argv[]) {
+    size_t requests = bench::getArg(argc, argv, 1, 100000);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O2;
+    CompileResult res = Compiler::compile(env, source, options);
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    char* rctx = ctx->getDataPtr();
+
+    int64_t lookupSum = 0;
+    bench::Timer lookupTimer;
+    for (size_t i = 0; i < requests; ++i) {
+        auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+        auto fctA = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("a"));
+        int64_t x = static_cast<int64_t>(i);
+        setX(rctx, &x);
+        lookupSum += *fctA(rctx);
+    }
+    double lookupSec = lookupTimer.elapsedSec();
+
+    int64_t handleSum = 0;
+    VarSetter<ArgInteger> setX(res, "x");
+    ExprHandle<ArgInteger> a(res, "a");
+    bench::Timer handleTimer;
+    for (size_t i = 0; i < requests; ++i) {
+        setX(rctx, static_cast<int64_t>(i));
+        handleSum += a(rctx);
+    }
+    double handleSec = handleTimer.elapsedSec();
+
+    size_t binds = std::max(requests / 100, size_t(1));
+    bench::Timer bindTimer;
+    for (size_t i = 0; i < binds; ++i) {
+        VarSetter<ArgInteger>(res, "x");
+        VarSetter<ArgFloat>(res, "y");
+        ExprHandle<ArgInteger>(res, "a");
+        ExprHandle<ArgFloat>(res, "b");
+    }
+    double bindSec = bindTimer.elapsedSec();
+    bench::Timer bulkTimer;
+    for (size_t i = 0; i < binds; ++i) {
+        FctTable fcts = res.resolveAll();
+        VarSetter<ArgInteger>(res, fcts, "x");
+        VarSetter<ArgFloat>(res, fcts, "y");
+        ExprHandle<ArgInteger>(res, fcts, "a");
+        ExprHandle<ArgFloat>(res, fcts, "b");
+    }
+    double bulkSec = bulkTimer.elapsedSec();
+
+    bench::printResult("request with lookups by name", lookupSec * 1e9 / requests, "ns/request");
+    bench::printResult("request with bound handles", handleSec * 1e9 / requests, "ns/request");
+    bench::printResult("speedup", lookupSec / handleSec, "x");
+    bench::printResult("bind handles with single lookups", bindSec * 1e6 / binds, "us/program");
+    bench::printResult("bind handles after resolveAll", bulkSec * 1e6 / binds, "us/program");
+    return lookupSum == handleSum ? 0 : 1;
+}
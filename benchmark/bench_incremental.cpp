@@ -0,0 +1,90 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Compares re-evaluating all exprs with the incremental evaluation of the exprs depending on the
+ * changed vars for a program with many inputs of which only a few change per evaluation.
+ * Usage: bench_incremental [iterations] [varCount] [changedPerIteration]
+ */
+
+static std::string createSource(size_t varCount) {
+    std::string source;
+    for (size_t i = 0; i < varCount; ++i) {
+        source += "var v" + std::to_string(i) + " : Integer;\n";
+    }
+    // Each expr combines two vars, every fifth expr aggregates previous exprs.
+    for (size_t i = 0; i < varCount; ++i) {
+        std::string name = "e" + std::to_string(i);
+        std::string next = "v" + std::to_string((i + 1) % varCount);
+        source += "expr " + name + " : Integer = max(v" + std::to_string(i) + " * 3, " + next + ") - "
+                + next + " / 7";
+        if (i % 5 == 4) {
+            for (size_t prev = i - 4; prev < i; ++prev) {
+                source += " + e" + std::to_string(prev);
+            }
+        }
+        source += ";\n";
+    }
+    return source;
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 1000000);
+    size_t varCount = bench::getArg(argc, argv, 2, 50);
+    size_t changed = bench::getArg(argc, argv, 3, 2);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O2;
+    options.d_evalAll = true;
+    options.d_incremental = true;
+    CompileResult res = Compiler::compile(env, createSource(varCount), options);
+    using SetFct = void (*)(char*, int64_t*);
+    std::vector<SetFct> setters;
+    for (size_t i = 0; i < varCount; ++i) {
+        setters.push_back(reinterpret_cast<SetFct>(res.getFctPtr("v" + std::to_string(i))));
+    }
+    auto evalAll = reinterpret_cast<void (*)(char*)>(res.getFctPtr("__eval_all"));
+    auto evalDirty = reinterpret_cast<void (*)(char*)>(res.getFctPtr("__eval_dirty"));
+    auto fctLast = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("e" + std::to_string(varCount - 1)));
+    std::unique_ptr<ExecutionContext> allCtx = ExecutionContext::create(res);
+    std::unique_ptr<ExecutionContext> dirtyCtx = ExecutionContext::create(res);
+
+    // Changes `changed` consecutive vars per iteration.
+    auto update = [&](char* rctx, size_t iter) {
+        for (size_t i = 0; i < changed; ++i) {
+            int64_t val = static_cast<int64_t>(iter + i);
+            setters[(iter * changed + i) % varCount](rctx, &val);
+        }
+    };
+    bench::Timer allTimer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        update(allCtx->getDataPtr(), iter);
+        evalAll(allCtx->getDataPtr());
+    }
+    double allSec = allTimer.elapsedSec();
+
+    bench::Timer dirtyTimer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        update(dirtyCtx->getDataPtr(), iter);
+        evalDirty(dirtyCtx->getDataPtr());
+    }
+    double dirtySec = dirtyTimer.elapsedSec();
+
+    // Both evaluations have to compute the same results.
+    bool valid = *fctLast(allCtx->getDataPtr()) == *fctLast(dirtyCtx->getDataPtr());
+    bench::printResult("evaluate all exprs", allSec * 1e9 / iterations, "ns/iteration");
+    bench::printResult("evaluate dirty exprs", dirtySec * 1e9 / iterations, "ns/iteration");
+    bench::printResult("speedup", allSec / dirtySec, "x");
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,77 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_codegen.hpp>
+#include <jex_codemodule.hpp>
+#include <jex_compileenv.hpp>
+#include <jex_constantfolding.hpp>
+#include <jex_environment.hpp>
+#include <jex_jitsession.hpp>
+#include <jex_parser.hpp>
+#include <jex_typeinference.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Compares compiling many small programs with a fresh JIT session per compilation (the former
+ * behavior of Backend::jit) against compiling them in one shared JitSession.
+ * Usage: bench_jitsession [programCount]
+ */
+
+static CompileResult compileWithSession(const Environment& env, const std::string& source,
+                                        std::shared_ptr<JitSession> session) {
+    CompileEnv compileEnv(env);
+    Parser parser(compileEnv, source.c_str());
+    parser.parse();
+    TypeInference typeInference(compileEnv);
+    typeInference.run();
+    ConstantFolding constFolding(compileEnv, true);
+    constFolding.run();
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O2});
+    codeGen.createIR();
+    Backend backend(compileEnv, std::move(session));
+    return backend.jit(codeGen.releaseModule());
+}
+
+static std::string createSource(size_t i) {
+    std::string num = std::to_string(i);
+    return "var x : Integer;\n"
+           "var s : String;\n"
+           "expr a : Integer = x * " + num + " + 1;\n"
+           "expr b : Bool = a > " + num + " && x < 100;\n"
+           "expr c : String = substr(s, 0, " + num + " % 5);\n";
+}
+
+template <typename SessionFct>
+static void run(const char* name, const Environment& env, size_t count, SessionFct getSession) {
+    std::vector<CompileResult> results;
+    results.reserve(count);
+    size_t rssBefore = bench::getRssBytes();
+    bench::Timer timer;
+    for (size_t i = 0; i < count; ++i) {
+        results.push_back(compileWithSession(env, createSource(i), getSession()));
+        // Force materialization of the program.
+        results.back().getFctPtr("a");
+    }
+    double elapsed = timer.elapsedSec();
+    size_t rssAfter = bench::getRssBytes();
+    std::cout << name << ":\n";
+    bench::printResult("  compile latency", elapsed * 1e6 / count, "us/program");
+    bench::printResult("  RSS growth", static_cast<double>(rssAfter - rssBefore) / 1024 / count, "KiB/program");
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = bench::getArg(argc, argv, 1, 500);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    // Warm-up to exclude one-time initialization.
+    compileWithSession(env, createSource(0), JitSession::getDefault());
+    run("Shared session", env, count, [] { return JitSession::getDefault(); });
+    run("Session per compilation", env, count, [] { return std::make_shared<JitSession>(); });
+    return 0;
+}
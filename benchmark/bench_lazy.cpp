@@ -0,0 +1,65 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <string>
+
+using namespace jex;
+
+/**
+ * Compares the time until the first evaluation of a single expression in a program with many
+ * expressions for eager and lazy compilation.
+ * Usage: bench_lazy [iterations] [exprCount]
+ */
+
+static std::string createSource(size_t exprCount) {
+    std::string source = "var x : Integer;\nvar s : String;\n";
+    for (size_t i = 0; i < exprCount; ++i) {
+        std::string num = std::to_string(i);
+        source += "expr e" + num + " : Integer = max(x, " + num + ") * 3 + x % " + num + " + 1;\n";
+        source += "expr t" + num + " : String = substr(s, " + num + " % 5, 3);\n";
+    }
+    return source;
+}
+
+static double timeFirstEvaluation(const Environment& env, const std::string& source,
+                                  const CompileOptions& options, size_t iterations, size_t* codeBytes) {
+    int64_t sum = 0;
+    bench::Timer timer;
+    for (size_t i = 0; i < iterations; ++i) {
+        CompileResult res = Compiler::compile(env, source, options);
+        std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+        int64_t x = 42;
+        reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"))(ctx->getDataPtr(), &x);
+        sum += *reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("e1"))(ctx->getDataPtr());
+        *codeBytes = res.getMemoryUsage().d_codeBytes;
+    }
+    double sec = timer.elapsedSec();
+    return sum != 0 ? sec * 1e3 / iterations : 0;
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 10);
+    size_t exprCount = bench::getArg(argc, argv, 2, 200);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    std::string source = createSource(exprCount);
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O2;
+
+    size_t eagerBytes = 0;
+    double eagerMs = timeFirstEvaluation(env, source, options, iterations, &eagerBytes);
+    options.d_lazy = true;
+    size_t lazyBytes = 0;
+    double lazyMs = timeFirstEvaluation(env, source, options, iterations, &lazyBytes);
+
+    bench::printResult("eager: first evaluation", eagerMs, "ms");
+    bench::printResult("eager: code", eagerBytes / 1024.0, "KiB");
+    bench::printResult("lazy: first evaluation", lazyMs, "ms");
+    bench::printResult("lazy: code", lazyBytes / 1024.0, "KiB");
+    return eagerMs > 0 && lazyMs > 0 ? 0 : 1;
+}
@@ -0,0 +1,83 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_parallelevaluator.hpp>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Measures how the parallel evaluator scales with the number of threads. The thread count is
+ * doubled up to maxThreads, which defaults to the number of hardware threads.
+ * Usage: bench_parallel [iterations] [rowCount] [maxThreads]
+ */
+
+static const char* s_source =
+    "var x : Integer;\n"
+    "var y : Float;\n"
+    "expr a : Float = if(x > 100, y * 1.5, y * 0.5) + y * 0.25;\n"
+    "expr b : Integer = max(x, 10) * 3 - x;\n"
+    "expr c : Float = a * 2.0 - 1.0;\n"
+    "expr s : String = join(\"-\", String(b), \"x\");\n";
+
+static const char* s_exprs[] = {"a", "b", "c", "s"};
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 20);
+    size_t rowCount = bench::getArg(argc, argv, 2, 1 << 18);
+    size_t maxThreads = bench::getArg(argc, argv, 3, std::max(1u, std::thread::hardware_concurrency()));
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O3;
+    CompileResult res = Compiler::compile(env, s_source, options);
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto setY = reinterpret_cast<void (*)(char*, double*)>(res.getFctPtr("y"));
+    std::vector<std::unique_ptr<ExecutionContext>> ctxs;
+    std::vector<char*> rctxs;
+    for (size_t i = 0; i < rowCount; ++i) {
+        ctxs.push_back(ExecutionContext::create(res));
+        rctxs.push_back(ctxs.back()->getDataPtr());
+        int64_t x = static_cast<int64_t>(i % 200);
+        double y = static_cast<double>(i);
+        setX(rctxs.back(), &x);
+        setY(rctxs.back(), &y);
+    }
+    std::vector<ParallelEvaluator::ExprFct> exprFcts;
+    for (const char* expr : s_exprs) {
+        exprFcts.push_back(reinterpret_cast<ParallelEvaluator::ExprFct>(res.getFctPtr(expr)));
+    }
+
+    double baseSec = 0;
+    for (size_t threads = 1; threads <= maxThreads; threads *= 2) {
+        ParallelEvaluator evaluator(res, threads);
+        double busySec = 0;
+        size_t stolen = 0;
+        bench::Timer timer;
+        for (size_t iter = 0; iter < iterations; ++iter) {
+            ParallelEvalStats stats = evaluator.evaluate(exprFcts, rctxs.data(), rowCount);
+            for (const ParallelEvalStats::Worker& worker : stats.d_workers) {
+                busySec += worker.d_busySec;
+                stolen += worker.d_stolenChunks;
+            }
+        }
+        double sec = timer.elapsedSec();
+        if (threads == 1) {
+            baseSec = sec;
+        }
+        std::string prefix = std::to_string(threads) + " threads: ";
+        bench::printResult(prefix + "time per row", sec * 1e9 / (iterations * rowCount), "ns/row");
+        bench::printResult(prefix + "speedup", baseSec / sec, "x");
+        bench::printResult(prefix + "busy time", 100 * busySec / (sec * threads), "%");
+        bench::printResult(prefix + "stolen chunks", static_cast<double>(stolen) / iterations, "/run");
+    }
+    return 0;
+}
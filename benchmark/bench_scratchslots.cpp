@@ -0,0 +1,84 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <string>
+
+using namespace jex;
+
+/**
+ * Compares evaluating string exprs with stack temporaries against evaluating them with scratch
+ * slots (CompileOptions::d_scratchSlots) and with results written into the exprs' slots directly
+ * (CompileOptions::d_inPlaceResults). Counts the heap allocations per evaluation.
+ * Usage: bench_scratchslots [evaluations]
+ */
+
+static const char* source =
+    "var name : String;\n"
+    "var x : Integer;\n"
+    "expr label : String = join(\"/\", substr(name, 0, 20), String(x), name);\n"
+    "expr prefix : String = substr(name, 0, 24);\n";
+
+struct Result {
+    double d_sec;
+    double d_allocations;
+    size_t d_checksum;
+};
+
+static Result run(const Environment& env, bool scratchSlots, bool inPlaceResults, size_t evaluations) {
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O2;
+    options.d_scratchSlots = scratchSlots;
+    options.d_inPlaceResults = inPlaceResults;
+    CompileResult res = Compiler::compile(env, source, options);
+    auto setName = reinterpret_cast<void (*)(char*, std::string*)>(res.getFctPtr("name"));
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto fctLabel = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("label"));
+    auto fctPrefix = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("prefix"));
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    char* rctx = ctx->getDataPtr();
+    std::string name = "a name exceeding the small string buffer";
+    setName(rctx, &name);
+    // Warm up, so that the slots reach their steady state capacity.
+    int64_t x = 0;
+    setX(rctx, &x);
+    fctLabel(rctx);
+    fctPrefix(rctx);
+    size_t checksum = 0;
+    size_t allocationsBefore = bench::getAllocationCount();
+    bench::Timer timer;
+    for (size_t i = 0; i < evaluations; ++i) {
+        x = static_cast<int64_t>(i % 1000);
+        setX(rctx, &x);
+        checksum += fctLabel(rctx)->size() + fctPrefix(rctx)->size();
+    }
+    double sec = timer.elapsedSec();
+    double allocations = static_cast<double>(bench::getAllocationCount() - allocationsBefore) / evaluations;
+    return Result{sec, allocations, checksum};
+}
+
+int main(int argc, char* argv[]) {
+    size_t evaluations = bench::getArg(argc, argv, 1, 1000000);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    Result stack = run(env, false, false, evaluations);
+    Result scratch = run(env, true, false, evaluations);
+    Result inPlace = run(env, false, true, evaluations);
+    Result both = run(env, true, true, evaluations);
+    auto print = [evaluations](const std::string& name, const Result& result) {
+        bench::printResult(name, result.d_sec * 1e9 / evaluations, "ns/eval");
+        bench::printResult(name + " allocations", result.d_allocations, "allocs/eval");
+    };
+    print("stack temporaries", stack);
+    print("scratch slots", scratch);
+    print("in-place results", inPlace);
+    print("scratch slots and in-place results", both);
+    bench::printResult("speedup", stack.d_sec / both.d_sec, "x");
+    bool valid = stack.d_checksum == scratch.d_checksum && stack.d_checksum == inPlace.d_checksum &&
+                 stack.d_checksum == both.d_checksum;
+    return valid ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <string>
+
+using namespace jex;
+
+/**
+ * Compares evaluating all exprs with and without sharing the pure calls repeated across them for
+ * a program deriving many exprs from the same substrings.
+ * Usage: bench_sharedsubexprs [iterations] [exprCount]
+ */
+
+static std::string createSource(size_t exprCount) {
+    std::string source = "var name : String;\nvar pos : Integer;\n";
+    for (size_t i = 0; i < exprCount; ++i) {
+        source += "expr e" + std::to_string(i) + " : String = join(\"" + std::to_string(i)
+                + "\", substr(name, 0, 3), substr(name, pos, 4));\n";
+    }
+    return source;
+}
+
+static double run(const CompileResult& res, size_t iterations, size_t exprCount, std::string& last) {
+    auto setName = reinterpret_cast<void (*)(char*, std::string*)>(res.getFctPtr("name"));
+    auto setPos = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("pos"));
+    auto evalAll = reinterpret_cast<void (*)(char*)>(res.getFctPtr("__eval_all"));
+    auto fctLast = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("e" + std::to_string(exprCount - 1)));
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    std::string name = "a name long enough to not fit into the small string buffer";
+    setName(ctx->getDataPtr(), &name);
+    bench::Timer timer;
+    for (size_t iter = 0; iter < iterations; ++iter) {
+        int64_t pos = static_cast<int64_t>(iter % 20);
+        setPos(ctx->getDataPtr(), &pos);
+        evalAll(ctx->getDataPtr());
+    }
+    double sec = timer.elapsedSec();
+    last = *fctLast(ctx->getDataPtr());
+    return sec;
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 200000);
+    size_t exprCount = bench::getArg(argc, argv, 2, 20);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O2;
+    options.d_evalAll = true;
+    CompileResult separate = Compiler::compile(env, createSource(exprCount), options);
+    options.d_shareSubexprs = true;
+    CompileResult shared = Compiler::compile(env, createSource(exprCount), options);
+
+    std::string separateLast;
+    std::string sharedLast;
+    double separateSec = run(separate, iterations, exprCount, separateLast);
+    double sharedSec = run(shared, iterations, exprCount, sharedLast);
+    bench::printResult("evaluate all exprs", separateSec * 1e9 / iterations, "ns/iteration");
+    bench::printResult("evaluate all exprs with shared calls", sharedSec * 1e9 / iterations, "ns/iteration");
+    bench::printResult("speedup", separateSec / sharedSec, "x");
+    return separateLast == sharedLast ? 0 : 1;
+}
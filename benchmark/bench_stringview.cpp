@@ -0,0 +1,92 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace jex;
+
+/**
+ * Compares binding string inputs to String vars (copied into the context) against binding them
+ * to StringView vars (viewed in place). Counts the heap allocations per row.
+ * Usage: bench_stringview [rows] [passes]
+ */
+
+static std::string makeSource(const char* type) {
+    return std::string("var line : ") + type + ";\n"
+           "expr isError : Bool = substr(line, 0, 5) == \"error\";\n"
+           "expr isSorted : Bool = line < \"m\";\n";
+}
+
+struct Result {
+    double d_sec;
+    double d_allocations;
+    size_t d_checksum;
+};
+
+template <typename T>
+static Result run(const Environment& env, const char* type, const std::vector<std::string>& lines, size_t passes) {
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O2;
+    options.d_scratchSlots = true;
+    options.d_inPlaceResults = true;
+    CompileResult res = Compiler::compile(env, makeSource(type).c_str(), options);
+    auto setLine = reinterpret_cast<void (*)(char*, const T*)>(res.getFctPtr("line"));
+    auto fctIsError = reinterpret_cast<bool* (*)(char*)>(res.getFctPtr("isError"));
+    auto fctIsSorted = reinterpret_cast<bool* (*)(char*)>(res.getFctPtr("isSorted"));
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    char* rctx = ctx->getDataPtr();
+    // Warm up, so that the slots reach their steady state capacity.
+    for (const std::string& line : lines) {
+        T value(line);
+        setLine(rctx, &value);
+        fctIsError(rctx);
+    }
+    size_t checksum = 0;
+    size_t allocationsBefore = bench::getAllocationCount();
+    bench::Timer timer;
+    for (size_t pass = 0; pass < passes; ++pass) {
+        for (const std::string& line : lines) {
+            if constexpr (std::is_same_v<T, std::string_view>) {
+                T value(line);
+                setLine(rctx, &value);
+            } else {
+                setLine(rctx, &line);
+            }
+            checksum += *fctIsError(rctx) + *fctIsSorted(rctx);
+        }
+    }
+    double sec = timer.elapsedSec();
+    size_t rows = lines.size() * passes;
+    double allocations = static_cast<double>(bench::getAllocationCount() - allocationsBefore) / rows;
+    return Result{sec / rows, allocations, checksum};
+}
+
+int main(int argc, char* argv[]) {
+    size_t rowCount = bench::getArg(argc, argv, 1, 10000);
+    size_t passes = bench::getArg(argc, argv, 2, 100);
+    std::vector<std::string> lines;
+    lines.reserve(rowCount);
+    for (size_t i = 0; i < rowCount; ++i) {
+        // Lines of varying length exceeding the small string buffer.
+        std::string line(i % 3 == 0 ? "error: " : "info: ");
+        line += std::string(20 + i % 200, static_cast<char>('a' + i % 26));
+        lines.push_back(std::move(line));
+    }
+    Environment env;
+    env.addModule(BuiltInsModule());
+    Result string = run<std::string>(env, "String", lines, passes);
+    Result view = run<std::string_view>(env, "StringView", lines, passes);
+    bench::printResult("String var", string.d_sec * 1e9, "ns/row");
+    bench::printResult("String var allocations", string.d_allocations, "allocs/row");
+    bench::printResult("StringView var", view.d_sec * 1e9, "ns/row");
+    bench::printResult("StringView var allocations", view.d_allocations, "allocs/row");
+    bench::printResult("speedup", string.d_sec / view.d_sec, "x");
+    return string.d_checksum == view.d_checksum ? 0 : 1;
+}
@@ -0,0 +1,73 @@
+#include <bench_base.hpp>
+
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_compileservice.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_tieredprogram.hpp>
+
+#include <string>
+
+using namespace jex;
+
+/**
+ * Compares the latency until the first evaluation and the evaluation speed of a program compiled
+ * at O2 with a tiered program before and after it got hot.
+ * Usage: bench_tiered [iterations] [exprCount]
+ */
+
+static std::string createSource(size_t exprCount) {
+    std::string source = "var x : Integer;\n";
+    std::string sum = "x";
+    for (size_t i = 1; i < exprCount; ++i) {
+        std::string term = "max(x, " + std::to_string(i) + ") * 3 + x % " + std::to_string(i);
+        source += "expr e" + std::to_string(i) + " : Integer = " + term + ";\n";
+        if (i <= 20) {
+            sum += " + " + term;
+        }
+    }
+    source += "expr r : Integer = " + sum + ";\n";
+    return source;
+}
+
+template <typename Program>
+static double evaluate(Program& program, uintptr_t fctR, size_t iterations) {
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(program);
+    int64_t x = 42;
+    reinterpret_cast<void (*)(char*, int64_t*)>(program.getFctPtr("x"))(ctx->getDataPtr(), &x);
+    int64_t sum = 0;
+    bench::Timer timer;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += *reinterpret_cast<int64_t* (*)(char*)>(fctR)(ctx->getDataPtr());
+    }
+    double sec = timer.elapsedSec();
+    return sum != 0 ? sec * 1e9 / iterations : 0;
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 1000000);
+    size_t exprCount = bench::getArg(argc, argv, 2, 200);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    std::string source = createSource(exprCount);
+    CompileService service(env, 1);
+
+    bench::Timer o2Timer;
+    CompileResult o2 = Compiler::compile(env, source, CompileOptions{OptLevel::O2});
+    uintptr_t o2FctR = o2.getFctPtr("r");
+    bench::printResult("O2: time to first evaluation", o2Timer.elapsedSec() * 1e3, "ms");
+
+    bench::Timer tieredTimer;
+    TieredProgram tiered(source, service, iterations / 2);
+    TieredFct& tieredR = tiered.getFct("r");
+    tieredR.getFctPtr();
+    bench::printResult("tiered: time to first evaluation", tieredTimer.elapsedSec() * 1e3, "ms");
+
+    bench::printResult("O2: evaluation", evaluate(o2, o2FctR, iterations), "ns");
+    bench::printResult("tiered baseline: evaluation", evaluate(tiered, tiered.getBaseline().getFctPtr("r"), iterations), "ns");
+    tiered.optimize();
+    tiered.waitOptimized();
+    bench::printResult("tiered optimized: evaluation", evaluate(tiered, tieredR.getFctPtr(), iterations), "ns");
+    return tiered.isOptimized() ? 0 : 1;
+}
@@ -0,0 +1,103 @@
+#include <bench_base.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_codegen.hpp>
+#include <jex_codemodule.hpp>
+#include <jex_compileenv.hpp>
+#include <jex_constantfolding.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_jitsession.hpp>
+#include <jex_parser.hpp>
+#include <jex_typeinference.hpp>
+
+#include "llvm/Target/TargetMachine.h"
+
+#include <memory>
+#include <string>
+
+using namespace jex;
+
+/**
+ * Compares the evaluation speed of numeric expressions optimized without target information (the
+ * former behavior of CodeGen), for a generic CPU and for the host CPU with all its features.
+ * Usage: bench_vectorize [iterations] [varCount]
+ */
+
+static std::string createSource(size_t varCount) {
+    std::string source;
+    std::string maxArgs;
+    std::string sum;
+    for (size_t i = 0; i < varCount; ++i) {
+        std::string num = std::to_string(i);
+        source += "var i" + num + " : Integer;\n";
+        source += "var f" + num + " : Float;\n";
+        maxArgs += (i == 0 ? "i" : ", i") + num;
+        sum += (i == 0 ? "f" : " + f") + num + " * f" + num;
+    }
+    source += "expr m : Integer = max(" + maxArgs + ");\n";
+    source += "expr s : Float = " + sum + ";\n";
+    return source;
+}
+
+static CompileResult compileFor(const Environment& env, const std::string& source,
+                                const char* cpu, bool useTargetMachine) {
+    CompileOptions options;
+    options.d_cpu = cpu;
+    auto session = std::make_shared<JitSession>(options);
+    std::unique_ptr<llvm::TargetMachine> targetMachine;
+    if (useTargetMachine) {
+        targetMachine = session->createTargetMachine();
+    }
+    CompileEnv compileEnv(env);
+    Parser parser(compileEnv, source.c_str());
+    parser.parse();
+    TypeInference typeInference(compileEnv);
+    typeInference.run();
+    ConstantFolding constFolding(compileEnv, true);
+    constFolding.run();
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O3}, targetMachine.get());
+    codeGen.createIR();
+    Backend backend(compileEnv, std::move(session));
+    return backend.jit(codeGen.releaseModule());
+}
+
+static void run(const char* name, const Environment& env, const std::string& source,
+                size_t varCount, size_t iterations, const char* cpu, bool useTargetMachine) {
+    CompileResult compiled = compileFor(env, source, cpu, useTargetMachine);
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(compiled);
+    char* rctx = ctx->getDataPtr();
+    for (size_t i = 0; i < varCount; ++i) {
+        std::string num = std::to_string(i);
+        int64_t intVal = static_cast<int64_t>((i * 7919) % 1000);
+        double floatVal = static_cast<double>(i) * 0.5;
+        reinterpret_cast<void (*)(char*, int64_t*)>(compiled.getFctPtr("i" + num))(rctx, &intVal);
+        reinterpret_cast<void (*)(char*, double*)>(compiled.getFctPtr("f" + num))(rctx, &floatVal);
+    }
+    auto fctM = reinterpret_cast<int64_t* (*)(char*)>(compiled.getFctPtr("m"));
+    auto fctS = reinterpret_cast<double* (*)(char*)>(compiled.getFctPtr("s"));
+    int64_t checksum = 0;
+    bench::Timer timer;
+    for (size_t i = 0; i < iterations; ++i) {
+        checksum += *fctM(rctx);
+        checksum += static_cast<int64_t>(*fctS(rctx));
+    }
+    double sec = timer.elapsedSec();
+    bench::printResult(name, sec * 1e9 / iterations, "ns/evaluation");
+    if (checksum == 0) {
+        std::cout << "unexpected checksum\n"; // Keeps the evaluation from being optimized away.
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t iterations = bench::getArg(argc, argv, 1, 1000000);
+    size_t varCount = bench::getArg(argc, argv, 2, 64);
+    Environment env;
+    env.addModule(BuiltInsModule());
+    std::string source = createSource(varCount);
+    run("no target machine", env, source, varCount, iterations, "host", false);
+    run("cpu generic", env, source, varCount, iterations, "generic", true);
+    run("cpu host", env, source, varCount, iterations, "host", true);
+    return 0;
+}
@@ -0,0 +1,167 @@
+#include <jex_aotemitter.hpp>
+
+#include <jex_aotprogram.hpp>
+#include <jex_backend.hpp>
+#include <jex_compileenv.hpp>
+#include <jex_constantstore.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_fctlibrary.hpp>
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include <cassert>
+#include <string_view>
+#include <vector>
+
+namespace jex {
+
+namespace {
+
+llvm::Constant* createDataGlobal(llvm::Module& module, std::string_view data, const std::string& name) {
+    llvm::Constant* init = llvm::ConstantDataArray::getString(module.getContext(),
+        llvm::StringRef(data.data(), data.size()), /*AddNull*/true);
+    auto* global = new llvm::GlobalVariable(module, init->getType(), /*isConstant*/true,
+        llvm::GlobalValue::PrivateLinkage, init, name);
+    return llvm::ConstantExpr::getPointerCast(global, llvm::Type::getInt8PtrTy(module.getContext()));
+}
+
+llvm::Constant* createTable(llvm::Module& module, llvm::StructType* entryType,
+                            const std::vector<llvm::Constant*>& entries, const std::string& name) {
+    llvm::ArrayType* arrayType = llvm::ArrayType::get(entryType, entries.size());
+    auto* global = new llvm::GlobalVariable(module, arrayType, /*isConstant*/true,
+        llvm::GlobalValue::PrivateLinkage, llvm::ConstantArray::get(arrayType, entries), name);
+    return llvm::ConstantExpr::getPointerCast(global, entryType->getPointerTo());
+}
+
+// Replaces all uses of the function with a pointer loaded from the slot.
+void redirectToSlot(llvm::Function& fct, llvm::GlobalVariable& slot) {
+    std::vector<llvm::User*> users(fct.user_begin(), fct.user_end());
+    for (llvm::User* user : users) {
+        if (auto* expr = llvm::dyn_cast<llvm::ConstantExpr>(user)) {
+            // E.g. a call through a bitcast: Materialize the expression for each instruction.
+            std::vector<llvm::User*> exprUsers(expr->user_begin(), expr->user_end());
+            for (llvm::User* exprUser : exprUsers) {
+                auto* inst = llvm::dyn_cast<llvm::Instruction>(exprUser);
+                if (inst == nullptr || llvm::isa<llvm::PHINode>(inst)) {
+                    throw InternalError("Unsupported use of function " + fct.getName().str());
+                }
+                llvm::Instruction* exprInst = expr->getAsInstruction();
+                exprInst->insertBefore(inst);
+                inst->replaceUsesOfWith(expr, exprInst);
+                auto* fctPtr = new llvm::LoadInst(fct.getType(), &slot, "fctPtr", exprInst);
+                exprInst->replaceUsesOfWith(&fct, fctPtr);
+            }
+            continue;
+        }
+        auto* inst = llvm::dyn_cast<llvm::Instruction>(user);
+        if (inst == nullptr || llvm::isa<llvm::PHINode>(inst)) {
+            throw InternalError("Unsupported use of function " + fct.getName().str());
+        }
+        auto* fctPtr = new llvm::LoadInst(fct.getType(), &slot, "fctPtr", inst);
+        inst->replaceUsesOfWith(&fct, fctPtr);
+    }
+}
+
+} // anonymous namespace
+
+AotEmitter::AotEmitter(CompileEnv& env)
+: d_env(env) {
+    Backend::initialize();
+}
+
+void AotEmitter::prepareModule(llvm::Module& module) {
+    llvm::LLVMContext& ctx = module.getContext();
+    llvm::Type* i64Type = llvm::Type::getInt64Ty(ctx);
+    llvm::Type* i8PtrType = llvm::Type::getInt8PtrTy(ctx);
+    // Call registered functions through pointer slots bound by the loader.
+    llvm::StructType* fctEntryType = llvm::StructType::get(ctx, {i8PtrType, i8PtrType->getPointerTo()});
+    std::vector<llvm::Constant*> fctEntries;
+    for (llvm::Function& fct : llvm::make_early_inc_range(module.functions())) {
+        if (!fct.isDeclaration() || d_env.fctLibrary().findFctByMangledName(fct.getName()) == nullptr) {
+            continue;
+        }
+        std::string name = fct.getName().str();
+        auto* slot = new llvm::GlobalVariable(module, fct.getType(), /*isConstant*/false,
+            llvm::GlobalValue::InternalLinkage, llvm::Constant::getNullValue(fct.getType()), "__jex_fct." + name);
+        redirectToSlot(fct, *slot);
+        fct.eraseFromParent();
+        fctEntries.push_back(llvm::ConstantStruct::get(fctEntryType, {
+            createDataGlobal(module, name, "__jex_fctname." + name),
+            llvm::ConstantExpr::getPointerCast(slot, i8PtrType->getPointerTo())}));
+    }
+    // Replace external constants with storage initialized by the loader.
+    llvm::StructType* constEntryType = llvm::StructType::get(ctx, {i64Type, i8PtrType, i8PtrType, i64Type});
+    std::vector<llvm::Constant*> constEntries;
+    for (auto& [name, constant] : d_env.constants()) {
+        llvm::GlobalVariable* global = module.getNamedGlobal(name);
+        if (global == nullptr || !global->isDeclaration()) {
+            continue; // Unused or emitted as initializer.
+        }
+        const TypeInfo* type = constant.type;
+        AotConstantKind kind;
+        std::string_view data;
+        if (type != nullptr && type->kind() == TypeKind::Value) {
+            kind = AotConstantKind::Bytes;
+            data = std::string_view(static_cast<const char*>(constant.getPtr()), type->size());
+        } else if (type != nullptr && type->kind() == TypeKind::Complex && type->name() == "String") {
+            kind = AotConstantKind::String;
+            data = *static_cast<const std::string*>(constant.getPtr());
+        } else {
+            throw InternalError("Constant '" + name + "' can't be compiled ahead of time");
+        }
+        global->setInitializer(llvm::Constant::getNullValue(global->getValueType()));
+        global->setConstant(false);
+        global->setLinkage(llvm::GlobalValue::InternalLinkage);
+        global->setAlignment(llvm::MaybeAlign(type->alignment()));
+        constEntries.push_back(llvm::ConstantStruct::get(constEntryType, {
+            llvm::ConstantInt::get(i64Type, static_cast<uint64_t>(kind)),
+            llvm::ConstantExpr::getPointerCast(global, i8PtrType),
+            createDataGlobal(module, data, "__jex_constdata." + name),
+            llvm::ConstantInt::get(i64Type, data.size())}));
+    }
+    // Program descriptor, see AotProgramDesc.
+    llvm::StructType* descType = llvm::StructType::get(ctx, {
+        i64Type, i64Type, i64Type, i64Type, fctEntryType->getPointerTo(), i64Type,
+        constEntryType->getPointerTo()});
+    llvm::Constant* desc = llvm::ConstantStruct::get(descType, {
+        llvm::ConstantInt::get(i64Type, AotProgramDesc::s_version),
+        llvm::ConstantInt::get(i64Type, d_env.getContextSize()),
+        llvm::ConstantInt::get(i64Type, d_env.getContextAlignment()),
+        llvm::ConstantInt::get(i64Type, fctEntries.size()),
+        createTable(module, fctEntryType, fctEntries, "__jex_fcts"),
+        llvm::ConstantInt::get(i64Type, constEntries.size()),
+        createTable(module, constEntryType, constEntries, "__jex_constants")});
+    new llvm::GlobalVariable(module, descType, /*isConstant*/true, llvm::GlobalValue::ExternalLinkage,
+        desc, "__jex_program");
+    assert(!llvm::verifyModule(module, &llvm::errs()));
+}
+
+void AotEmitter::emitObject(llvm::Module& module, const std::string& fileName,
+                            llvm::TargetMachine& targetMachine) {
+    assert(targetMachine.isPositionIndependent());
+    prepareModule(module);
+    module.setTargetTriple(targetMachine.getTargetTriple().str());
+    module.setDataLayout(targetMachine.createDataLayout());
+    std::error_code errCode;
+    llvm::raw_fd_ostream out(fileName, errCode, llvm::sys::fs::OF_None);
+    if (errCode) {
+        throw InternalError("Error opening '" + fileName + "': " + errCode.message());
+    }
+    llvm::legacy::PassManager passMgr;
+    if (targetMachine.addPassesToEmitFile(passMgr, out, nullptr, llvm::CGFT_ObjectFile)) {
+        throw InternalError("Target can't emit object files");
+    }
+    passMgr.run(module);
+    out.flush();
+}
+
+} // namespace jex
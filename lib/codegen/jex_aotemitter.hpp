@@ -0,0 +1,42 @@
+#pragma once
+
+#include <jex_base.hpp>
+
+#include <string>
+
+namespace llvm {
+    class Module;
+    class TargetMachine;
+}
+
+namespace jex {
+
+class CompileEnv;
+
+/**
+ * Emits a compiled module as a native object file for ahead-of-time compilation.
+ * The object can be linked into a shared library and loaded with AotProgram.
+ */
+class AotEmitter : NoCopy {
+    CompileEnv& d_env;
+
+public:
+    AotEmitter(CompileEnv& env);
+
+    /**
+     * Makes the module independent of the JIT: Calls to registered functions are redirected
+     * through pointer slots, constants become storage to be filled by the loader and the
+     * "__jex_program" descriptor (see AotProgramDesc) is added.
+     * Throws an InternalError for constants which can't be serialized.
+     */
+    void prepareModule(llvm::Module& module);
+
+    /**
+     * Prepares the module and writes it as an object file for the given target machine, which
+     * has to use position independent code (see createTargetMachine()).
+     */
+    void emitObject(llvm::Module& module, const std::string& fileName,
+                    llvm::TargetMachine& targetMachine);
+};
+
+} // namespace jex
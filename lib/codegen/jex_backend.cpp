@@ -1,50 +1,58 @@
 #include <jex_backend.hpp>
 
+#include <jex_codegen.hpp>
 #include <jex_codemodule.hpp>
 #include <jex_compileenv.hpp>
+#include <jex_compilereport.hpp>
 #include <jex_constantstore.hpp>
+#include <jex_diskobjectcache.hpp>
 #include <jex_errorhandling.hpp>
 #include <jex_fctinfo.hpp>
 #include <jex_fctlibrary.hpp>
+#include <jex_jitsession.hpp>
+#include <jex_llvmerror.hpp>
 
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LazyReexports.h"
 #include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/IR/InstIterator.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/ValueMapper.h"
 #include "llvm/Support/Host.h"
 #include "llvm/Support/TargetSelect.h"
 
 namespace jex {
 
-[[noreturn]] static void throwLlvmError(llvm::Error err, const char* errPrefix) {
-    std::string errMsg;
-    llvm::raw_string_ostream errStr(errMsg);
-    llvm::logAllUnhandledErrors(std::move(err), errStr, errPrefix);
-    throw InternalError(errMsg);
+CompileResult::CompileResult(CompileResult&& other) noexcept
+: d_messages(std::move(other.d_messages))
+, d_session(std::move(other.d_session))
+, d_lib(std::exchange(other.d_lib, nullptr))
+, d_stubsMgr(std::move(other.d_stubsMgr))
+, d_constants(std::move(other.d_constants))
+, d_contextSize(other.d_contextSize)
+, d_contextAlignment(other.d_contextAlignment)
+, d_contextSlots(std::move(other.d_contextSlots))
+, d_inputRecord(std::move(other.d_inputRecord))
+, d_definedFcts(std::move(other.d_definedFcts))
+, d_report(std::move(other.d_report)) {
 }
 
-static void checked(llvm::Error err, const char* errPrefix) {
-    if (err) {
-        throwLlvmError(std::move(err), errPrefix);
+CompileResult::~CompileResult() {
+    // Remove the code before the constants it refers to get destructed.
+    if (d_lib != nullptr) {
+        d_session->releaseProgramLib(*d_lib);
     }
 }
 
-template <typename T>
-static T checked(llvm::Expected<T> expectedObj, const char* errPrefix) {
-    if (!expectedObj) {
-        throwLlvmError(expectedObj.takeError(), errPrefix);
-    }
-    return std::move(*expectedObj);
-}
-
-
-CompileResult::CompileResult(CompileResult&& other) noexcept = default;
-CompileResult::~CompileResult() = default;
-
 CompileResult::CompileResult(std::unique_ptr<std::set<MsgInfo>> messages,
-                             std::unique_ptr<llvm::orc::LLJIT>  jit,
+                             std::shared_ptr<JitSession>        session,
+                             llvm::orc::JITDylib&               lib,
                              std::unique_ptr<ConstantStore>     constants,
                              size_t                             contextSize)
 : d_messages(std::move(messages))
-, d_jit(std::move(jit))
+, d_session(std::move(session))
+, d_lib(&lib)
 , d_constants(std::move(constants))
 , d_contextSize(contextSize) {
 }
@@ -52,14 +60,65 @@ CompileResult::CompileResult(std::unique_ptr<std::set<MsgInfo>> messages,
 CompileResult::CompileResult(std::unique_ptr<std::set<MsgInfo>> messages)
 : d_messages(std::move(messages)) {}
 
+const ContextSlotDesc* CompileResult::findContextSlot(std::string_view name) const {
+    for (const ContextSlotDesc& slot : getContextSlots()) {
+        if (slot.d_name == name) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
 uintptr_t CompileResult::getFctPtr(std::string_view fctName) const {
-    if (!d_jit) {
+    if (d_lib == nullptr) {
         throw InternalError("Cannot get function pointer as compilation failed.");
     }
-    llvm::JITEvaluatedSymbol sym = checked(d_jit->lookup(fctName), "Error looking up function pointer: ");
+    llvm::JITEvaluatedSymbol sym = checked(d_session->jit().lookup(*d_lib, fctName), "Error looking up function pointer: ");
     return static_cast<uintptr_t>(sym.getAddress());
 }
 
+void CompileResult::materialize(const std::vector<std::string>& fctNames) const {
+    if (d_lib == nullptr) {
+        throw InternalError("Cannot materialize functions as compilation failed.");
+    }
+    llvm::orc::SymbolLookupSet symbols;
+    for (const std::string& fctName : fctNames) {
+        symbols.add(d_session->jit().mangleAndIntern(fctName));
+    }
+    checked(d_session->jit().getExecutionSession().lookup(llvm::orc::makeJITDylibSearchOrder(d_lib),
+                                                          std::move(symbols)),
+            "Error materializing functions: ");
+}
+
+FctTable CompileResult::resolveAll() const {
+    if (d_lib == nullptr) {
+        throw InternalError("Cannot resolve functions as compilation failed.");
+    }
+    llvm::orc::LLJIT& jit = d_session->jit();
+    std::vector<llvm::orc::SymbolStringPtr> names;
+    llvm::orc::SymbolLookupSet symbols;
+    for (const std::string& fctName : d_definedFcts) {
+        names.push_back(jit.mangleAndIntern(fctName));
+        symbols.add(names.back());
+    }
+    llvm::orc::SymbolMap resolved = checked(
+        jit.getExecutionSession().lookup(llvm::orc::makeJITDylibSearchOrder(d_lib), std::move(symbols)),
+        "Error resolving functions: ");
+    std::unordered_map<std::string, uintptr_t> fcts;
+    for (size_t i = 0; i < names.size(); ++i) {
+        fcts.emplace(d_definedFcts[i], static_cast<uintptr_t>(resolved.find(names[i])->second.getAddress()));
+    }
+    return FctTable(std::move(fcts));
+}
+
+MemoryUsage CompileResult::getMemoryUsage() const {
+    if (d_lib == nullptr) {
+        return MemoryUsage{};
+    }
+    return MemoryUsage{d_session->getCodeBytes(*d_lib), d_session->getDataBytes(*d_lib),
+                       d_constants->getByteSize()};
+}
+
 std::ostream& operator<<(std::ostream& str, const CompileResult& compileResult) {
     for (const MsgInfo& msg : compileResult.getMessages()) {
         str << msg;
@@ -68,39 +127,217 @@ std::ostream& operator<<(std::ostream& str, const CompileResult& compileResult)
 }
 
 Backend::Backend(CompileEnv& env)
-: d_env(env) {
+: Backend(env, JitSession::getDefault()) {
+}
+
+Backend::Backend(CompileEnv& env, std::shared_ptr<JitSession> session)
+: d_env(env)
+, d_session(std::move(session)) {
     initialize();
 }
 
 Backend::~Backend() = default;
 
 CompileResult Backend::jit(std::unique_ptr<CodeModule> module) {
-    // Create lljit and add IR module.
-    module->llvmModule().setTargetTriple(llvm::sys::getDefaultTargetTriple());
-    std::unique_ptr<llvm::orc::LLJIT> jit = checked(llvm::orc::LLJITBuilder().create(), "Error creating LLJITBuilder: ");
-    checked(jit->addIRModule(llvm::orc::ThreadSafeModule(module->releaseModule(), module->releaseContext())),
-            "Error adding IR module: ");
-    // Create library for functions registered in the function library.
-    // Add all functions used in the module.
-    llvm::orc::JITDylib& lib = jit->getMainJITDylib();
-    llvm::orc::ExecutionSession& es = jit->getExecutionSession();
+    if (module->llvmModule().getTargetTriple().empty()) {
+        module->llvmModule().setTargetTriple(llvm::sys::getDefaultTargetTriple());
+    }
+    // Take the object prefetched for the module first, so that it is released if the
+    // compilation fails.
+    std::unique_ptr<llvm::MemoryBuffer> cachedObject;
+    if (DiskObjectCache* objectCache = d_session->getObjectCache()) {
+        cachedObject = objectCache->takeObject(module->llvmModule());
+    }
+    // Create a library for the program inside of the shared session.
+    CompileResult result(d_env.releaseMessages(), d_session, d_session->createProgramLib(),
+                         d_env.releaseConstants(), d_env.getContextSize());
+    result.d_contextAlignment = d_env.getContextAlignment();
+    result.d_report = d_env.releaseReport();
+    result.d_contextSlots = d_env.getContextSlots();
+    result.d_inputRecord = d_env.getInputRecord();
+    for (const llvm::Function& fct : module->llvmModule()) {
+        if (!fct.isDeclaration() && !fct.hasLocalLinkage()) {
+            result.d_definedFcts.push_back(fct.getName().str());
+        }
+    }
+    llvm::orc::JITDylib& lib = *result.d_lib;
+    llvm::orc::ExecutionSession& es = d_session->jit().getExecutionSession();
     llvm::orc::SymbolMap symbols;
-    // Link external functions.
-    for (const FctInfo* fct : d_env.usedFcts()) {
+    // Link external functions. They are defined once in the session's function library, only
+    // functions clashing with a different function of the same name are defined locally.
+    for (const FctInfo* fct : d_session->defineFcts(d_env.usedFcts())) {
         symbols.insert(std::make_pair(es.intern(fct->d_mangledName), llvm::JITEvaluatedSymbol::fromPointer(fct->d_fctPtr)));
     }
     // Link external constants.
-    for (auto&[name, constant] : d_env.constants()) {
+    for (auto&[name, constant] : *result.d_constants) {
         symbols.insert(std::make_pair(es.intern(name), llvm::JITEvaluatedSymbol::fromPointer(constant.valuePtr.get())));
     }
     checked(lib.define(absoluteSymbols(symbols)), "Error adding fct symbols: ");
-    return CompileResult(d_env.releaseMessages(), std::move(jit), d_env.releaseConstants(), d_env.getContextSize());
+    if (CodeGen::getLazyOptLevel(module->llvmModule())) {
+        addLazy(result, std::move(module));
+        return result;
+    }
+    if (cachedObject) {
+        // The module skipped its optimization, the cached object replaces it.
+        checked(d_session->jit().addObjectFile(lib, std::move(cachedObject)), "Error adding cached object: ");
+        return result;
+    }
+    checked(d_session->jit().addIRModule(lib, llvm::orc::ThreadSafeModule(module->releaseModule(), module->releaseContext())),
+            "Error adding IR module: ");
+    return result;
+}
+
+// Adds the globals referenced by the constant (e.g. via a constant expression) to the work list.
+static void collectGlobals(const llvm::Constant& constant, std::vector<const llvm::GlobalValue*>& worklist) {
+    if (const auto* global = llvm::dyn_cast<llvm::GlobalValue>(&constant)) {
+        worklist.push_back(global);
+        return;
+    }
+    for (const llvm::Use& op : constant.operands()) {
+        collectGlobals(*llvm::cast<llvm::Constant>(op.get()), worklist);
+    }
+}
+
+// Returns true if the global has to be defined in each module referring to it.
+static bool isCopiedGlobal(const llvm::GlobalValue& global) {
+    // Exported functions called by other functions (e.g. an expr by its batch variant) get an
+    // internal copy, so that they can be inlined instead of being called through their stub.
+    return global.hasLocalLinkage() || (llvm::isa<llvm::Function>(global) && !global.isDeclaration());
+}
+
+/**
+ * Creates a module containing only the given function and everything it refers to: Internal
+ * functions and globals as well as called functions are copied, all other referenced globals are
+ * declared.
+ * Only the size of the function and its dependencies is processed, so splitting a module into
+ * all of its functions is linear in the size of the module.
+ */
+static std::unique_ptr<llvm::Module> extractFunction(llvm::Function& entry, const std::string& name) {
+    llvm::Module& module = *entry.getParent();
+    auto part = std::make_unique<llvm::Module>(module.getModuleIdentifier() + "." + name, module.getContext());
+    part->setTargetTriple(module.getTargetTriple());
+    part->setDataLayout(module.getDataLayout());
+    if (llvm::NamedMDNode* flags = module.getModuleFlagsMetadata()) {
+        llvm::NamedMDNode* partFlags = part->getOrInsertModuleFlagsMetadata();
+        for (llvm::MDNode* flag : flags->operands()) {
+            partFlags->addOperand(flag);
+        }
+    }
+    // Collect all globals (transitively) referenced by the function.
+    std::vector<const llvm::GlobalValue*> worklist{&entry};
+    llvm::SmallPtrSet<const llvm::GlobalValue*, 16> used;
+    while (!worklist.empty()) {
+        const llvm::GlobalValue* global = worklist.back();
+        worklist.pop_back();
+        if (!used.insert(global).second || (global != &entry && !isCopiedGlobal(*global))) {
+            continue;
+        }
+        if (const auto* fct = llvm::dyn_cast<llvm::Function>(global)) {
+            for (const llvm::Instruction& inst : llvm::instructions(*fct)) {
+                for (const llvm::Use& op : inst.operands()) {
+                    if (const auto* constant = llvm::dyn_cast<llvm::Constant>(op.get())) {
+                        collectGlobals(*constant, worklist);
+                    }
+                }
+            }
+        } else if (const auto* var = llvm::dyn_cast<llvm::GlobalVariable>(global)) {
+            if (var->hasInitializer()) {
+                collectGlobals(*var->getInitializer(), worklist);
+            }
+        }
+    }
+    // Create the globals in the new module, defining the entry and all local ones.
+    llvm::ValueToValueMapTy valueMap;
+    std::vector<llvm::Function*> clonedFcts;
+    std::vector<std::pair<const llvm::GlobalVariable*, llvm::GlobalVariable*>> clonedVars;
+    for (const llvm::GlobalValue* global : used) {
+        bool define = global == &entry || isCopiedGlobal(*global);
+        if (const auto* fct = llvm::dyn_cast<llvm::Function>(global)) {
+            llvm::Function* newFct = nullptr;
+            if (define && !fct->isDeclaration()) {
+                // Clone inside of the original module and move it over, references are remapped
+                // below.
+                llvm::ValueToValueMapTy argMap;
+                newFct = llvm::CloneFunction(const_cast<llvm::Function*>(fct), argMap);
+                newFct->removeFromParent();
+                part->getFunctionList().push_back(newFct);
+                clonedFcts.push_back(newFct);
+                if (global != &entry) {
+                    newFct->setLinkage(llvm::GlobalValue::InternalLinkage);
+                }
+            } else {
+                newFct = llvm::Function::Create(fct->getFunctionType(), fct->getLinkage(),
+                                                fct->getAddressSpace(), "", part.get());
+                newFct->copyAttributesFrom(fct);
+            }
+            newFct->setName(fct->getName());
+            valueMap[fct] = newFct;
+        } else {
+            const auto* var = llvm::cast<llvm::GlobalVariable>(global);
+            auto* newVar = new llvm::GlobalVariable(*part, var->getValueType(), var->isConstant(),
+                var->getLinkage(), nullptr, var->getName(), nullptr, var->getThreadLocalMode(),
+                var->getAddressSpace());
+            newVar->copyAttributesFrom(var);
+            if (define && var->hasInitializer()) {
+                clonedVars.emplace_back(var, newVar);
+            }
+            valueMap[var] = newVar;
+        }
+    }
+    for (auto& [var, newVar] : clonedVars) {
+        newVar->setInitializer(llvm::MapValue(var->getInitializer(), valueMap));
+    }
+    for (llvm::Function* fct : clonedFcts) {
+        llvm::RemapFunction(*fct, valueMap, llvm::RF_IgnoreMissingLocals);
+    }
+    llvm::cast<llvm::Function>(valueMap[&entry])->setName(name);
+    return part;
+}
+
+void Backend::addLazy(CompileResult& result, std::unique_ptr<CodeModule> module) {
+    // Split the module into one module per exported function. Internal functions (intrinsics)
+    // and globals are copied into each module using them. Each exported function is renamed and
+    // reexported under its original name through a stub which compiles its module on first call.
+    std::unique_ptr<llvm::Module> llvmModule = module->releaseModule();
+    llvm::orc::ThreadSafeContext context(module->releaseContext());
+    llvm::orc::ExecutionSession& es = d_session->jit().getExecutionSession();
+    std::vector<std::unique_ptr<llvm::Module>> parts;
+    llvm::orc::SymbolAliasMap aliases;
+    std::vector<llvm::Function*> entries;
+    for (llvm::Function& fct : *llvmModule) {
+        if (!fct.isDeclaration() && !fct.hasLocalLinkage()) {
+            entries.push_back(&fct);
+        }
+    }
+    for (llvm::Function* fct : entries) {
+        std::string implName = fct->getName().str() + ".lazy";
+        parts.push_back(extractFunction(*fct, implName));
+        aliases[es.intern(fct->getName())] = llvm::orc::SymbolAliasMapEntry(es.intern(implName),
+            llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable);
+    }
+    // All parts share the context, so the original module has to be gone before it is used
+    // concurrently.
+    llvmModule.reset();
+    llvm::orc::JITDylib& lib = *result.d_lib;
+    for (std::unique_ptr<llvm::Module>& part : parts) {
+        checked(d_session->jit().addIRModule(lib, llvm::orc::ThreadSafeModule(std::move(part), context)),
+                "Error adding IR module: ");
+    }
+    result.d_stubsMgr = d_session->createStubsManager();
+    checked(lib.define(llvm::orc::lazyReexports(d_session->getLazyCallThroughManager(), *result.d_stubsMgr,
+                                                lib, std::move(aliases))),
+            "Error adding lazy reexports: ");
 }
 
 void Backend::initialize() {
-    llvm::InitializeNativeTarget();
-    llvm::InitializeNativeTargetAsmPrinter();
-    llvm::InitializeNativeTargetAsmParser();
+    // Target registration isn't thread-safe, so only do it once.
+    static const bool initialized = [] {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        llvm::InitializeNativeTargetAsmParser();
+        return true;
+    }();
+    (void)initialized;
 }
 
 } // namespace jex
@@ -1,16 +1,21 @@
 #pragma once
 
 #include <jex_base.hpp>
+#include <jex_contextlayout.hpp>
+#include <jex_handles.hpp>
 
 #include <cassert>
+#include <cstddef>
 #include <iosfwd>
 #include <memory>
 #include <set>
+#include <string>
 #include <string_view>
+#include <vector>
 
 namespace llvm::orc {
-    class LLJIT;
-    class ThreadSafeModule;
+    class IndirectStubsManager;
+    class JITDylib;
 }
 
 namespace jex {
@@ -18,19 +23,45 @@ namespace jex {
 class CodeModule;
 class CompileEnv;
 class ConstantStore;
+struct CompileReport;
+class JitSession;
 struct MsgInfo;
 
+/**
+ * Memory held by a compiled program.
+ */
+struct MemoryUsage {
+    size_t d_codeBytes = 0;
+    size_t d_dataBytes = 0;
+    size_t d_constantBytes = 0;
+
+    size_t total() const {
+        return d_codeBytes + d_dataBytes + d_constantBytes;
+    }
+};
+
 class CompileResult {
     friend class Backend;
     friend class Compiler;
 
     std::unique_ptr<std::set<MsgInfo>> d_messages;
-    std::unique_ptr<llvm::orc::LLJIT> d_jit;
+    std::shared_ptr<JitSession> d_session;
+    // Library containing the program's code, owned by the session.
+    llvm::orc::JITDylib* d_lib = nullptr;
+    // Stubs of lazily compiled functions, only set for lazy programs.
+    std::unique_ptr<llvm::orc::IndirectStubsManager> d_stubsMgr;
     std::unique_ptr<ConstantStore> d_constants;
     size_t d_contextSize = 0;
+    size_t d_contextAlignment = alignof(std::max_align_t);
+    std::vector<ContextSlotDesc> d_contextSlots;
+    std::vector<ContextSlotDesc> d_inputRecord;
+    // Names of all functions defined by the program.
+    std::vector<std::string> d_definedFcts;
+    std::unique_ptr<CompileReport> d_report;
 
     CompileResult(std::unique_ptr<std::set<MsgInfo>> messages,
-                  std::unique_ptr<llvm::orc::LLJIT>  jit,
+                  std::shared_ptr<JitSession>        session,
+                  llvm::orc::JITDylib&               lib,
                   std::unique_ptr<ConstantStore>     constants,
                   size_t                             contextSize);
     CompileResult(std::unique_ptr<std::set<MsgInfo>> messages);
@@ -43,7 +74,7 @@ public:
     ~CompileResult();
 
     explicit operator bool() const {
-        return static_cast<bool>(d_jit);
+        return d_lib != nullptr;
     }
 
     const std::set<MsgInfo>& getMessages() const {
@@ -54,22 +85,85 @@ public:
         assert(*this); // May not be called if the compile result isn't valid.
         return d_contextSize;
     }
+    // Returns the alignment contexts have to be allocated with.
+    size_t getContextAlignment() const {
+        assert(*this); // May not be called if the compile result isn't valid.
+        return d_contextAlignment;
+    }
+
+    /**
+     * Returns the layout of the vars and exprs in the context ordered by offset. Value types can
+     * be read and written directly at their offsets, complex types are C++ objects constructed
+     * by __init_rctx. Writing a var directly doesn't mark the exprs depending on it as dirty.
+     */
+    const std::vector<ContextSlotDesc>& getContextSlots() const {
+        assert(*this); // May not be called if the compile result isn't valid.
+        return d_contextSlots;
+    }
+    // Returns the slot of the var or expr with the given name or null if there isn't any.
+    const ContextSlotDesc* findContextSlot(std::string_view name) const;
+    /**
+     * Returns the layout of the input record read by __set_all: the vars in declaration order
+     * with their offsets in the record, laid out like the members of a C struct.
+     */
+    const std::vector<ContextSlotDesc>& getInputRecord() const {
+        assert(*this); // May not be called if the compile result isn't valid.
+        return d_inputRecord;
+    }
 
+    // Looks up the function by name. Prefer binding handles (see jex_handles.hpp) on hot paths.
     uintptr_t getFctPtr(std::string_view fctName) const;
+
+    const std::vector<std::string>& getDefinedFcts() const {
+        return d_definedFcts;
+    }
+    /**
+     * Resolves all functions defined by the program in a single lookup, e.g. at load time. Lazy
+     * functions resolve to their stubs, so they are still compiled on their first call.
+     */
+    FctTable resolveAll() const;
+
+    /**
+     * Compiles the given functions now instead of on their first lookup.
+     */
+    void materialize(const std::vector<std::string>& fctNames) const;
+
+    /**
+     * Returns the compile report or null if it wasn't requested.
+     */
+    const CompileReport* getReport() const {
+        return d_report.get();
+    }
+
+    /**
+     * Returns the memory currently held by the program. Code is only allocated once it got
+     * materialized, i.e. on the first getFctPtr() call.
+     */
+    MemoryUsage getMemoryUsage() const;
 };
 
 std::ostream& operator<<(std::ostream& str, const CompileResult& compileResult);
 
 class Backend :  NoCopy {
     CompileEnv& d_env;
+    std::shared_ptr<JitSession> d_session;
 
 public:
     static void initialize();
 
+    // Uses the process-wide default JitSession.
     Backend(CompileEnv& env);
+    Backend(CompileEnv& env, std::shared_ptr<JitSession> session);
     ~Backend();
 
+    /**
+     * Adds the module to a new program library. Modules created by CodeGen in lazy mode are split
+     * per function and each function is only optimized and compiled on its first call.
+     */
     CompileResult jit(std::unique_ptr<CodeModule> module);
+
+private:
+    void addLazy(CompileResult& result, std::unique_ptr<CodeModule> module);
 };
 
 } // namespace jex
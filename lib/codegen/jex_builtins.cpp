@@ -7,7 +7,11 @@
 #include "llvm/IR/IRBuilder.h"
 
 #include <cassert>
+#include <charconv>
+#include <cstdio>
 #include <functional>
+#include <limits>
+#include <type_traits>
 
 namespace jex {
 
@@ -18,6 +22,22 @@ void stringCtor(std::string* res, T val) {
     new(res) std::string(std::to_string(val));
 }
 
+template <typename T>
+void stringAssign(std::string* res, T val) {
+    // Formats like std::to_string but into a stack buffer, so res keeps its capacity. "%f" prints
+    // all integral digits of a double, so the buffer has to fit the largest exponent.
+    char buf[std::numeric_limits<double>::max_exponent10 + 20];
+    if constexpr (std::is_floating_point_v<T>) {
+        int len = std::snprintf(buf, sizeof(buf), "%f", val);
+        assert(len > 0 && static_cast<size_t>(len) < sizeof(buf));
+        res->assign(buf, len);
+    } else {
+        std::to_chars_result result = std::to_chars(buf, buf + sizeof(buf), static_cast<int64_t>(val));
+        assert(result.ec == std::errc());
+        res->assign(buf, result.ptr);
+    }
+}
+
 template <typename T>
 void integerCtor(int64_t* res, T val) {
     *res = static_cast<int64_t>(val);
@@ -66,12 +86,12 @@ void max(T* res, const VarArg<T>* args) {
     *res = maxVal;
 }
 
-void join(std::string* res, const std::string* separator, const VarArg<const std::string*>* args) {
+void joinAssign(std::string* res, const std::string* separator, const VarArg<const std::string*>* args) {
     size_t cap = (args->size() - 1) * separator->size() + 1; // +1 for null-terminator
     for (const std::string* str : *args) {
         cap += str->size();
     }
-    new(res) std::string();
+    res->clear();
     res->reserve(cap);
     bool first = true;
     for (const std::string* str : *args) {
@@ -84,6 +104,11 @@ void join(std::string* res, const std::string* separator, const VarArg<const std
     }
 }
 
+void join(std::string* res, const std::string* separator, const VarArg<const std::string*>* args) {
+    new(res) std::string();
+    joinAssign(res, separator, args);
+}
+
 void generateMax(IntrinsicGen& gen) {
     llvm::Type* elemType = gen.fct().getArg(0)->getType()->getPointerElementType();
     llvm::IRBuilder<>& builder = gen.builder();
@@ -179,6 +204,69 @@ void substr(std::string* res, const std::string* in, int64_t pos, int64_t count)
     new (res) std::string(in->substr(pos, count));
 }
 
+void substrAssign(std::string* res, const std::string* in, int64_t pos, int64_t count) {
+    assert(pos >= 0);
+    assert(count >= 0);
+    res->assign(*in, pos, count);
+}
+
+void stringFromView(std::string* res, const std::string_view* view) {
+    new (res) std::string(*view);
+}
+
+void stringAssignView(std::string* res, const std::string_view* view) {
+    res->assign(*view);
+}
+
+void substrView(std::string_view* res, const std::string_view* in, int64_t pos, int64_t count) {
+    assert(pos >= 0);
+    assert(count >= 0);
+    *res = in->substr(pos, count);
+}
+
+void joinViewAssign(std::string* res, const std::string* separator, const VarArg<const std::string_view*>* args) {
+    size_t cap = (args->size() - 1) * separator->size() + 1; // +1 for null-terminator
+    for (const std::string_view* str : *args) {
+        cap += str->size();
+    }
+    res->clear();
+    res->reserve(cap);
+    bool first = true;
+    for (const std::string_view* str : *args) {
+        if (first) {
+            first = false;
+        } else {
+            *res += *separator;
+        }
+        *res += *str;
+    }
+}
+
+void joinView(std::string* res, const std::string* separator, const VarArg<const std::string_view*>* args) {
+    new(res) std::string();
+    joinViewAssign(res, separator, args);
+}
+
+// Compares a StringView with a StringView or String without copying either of them.
+template <typename Op, typename L, typename R>
+void cmpView(bool* res, const L* a, const R* b) {
+    assert(res != nullptr);
+    *res = Op()(std::string_view(*a), std::string_view(*b));
+}
+
+template <typename L, typename R>
+void registerViewCmps(Registry& registry) {
+    using Cmp = FctDesc<ArgBool, L, R>;
+    using LT = typename L::Type;
+    using RT = typename R::Type;
+    registry.registerFct(Cmp("operator_eq", cmpView<std::equal_to<>, LT, RT>, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(Cmp("operator_ne", cmpView<std::not_equal_to<>, LT, RT>, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(Cmp("operator_lt", cmpView<std::less<>, LT, RT>, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(Cmp("operator_gt", cmpView<std::greater<>, LT, RT>, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(Cmp("operator_le", cmpView<std::less_equal<>, LT, RT>, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(Cmp("operator_ge", cmpView<std::greater_equal<>, LT, RT>, NO_INTRINSIC, FctFlags::Pure));
+}
+
 } // anonymous namespace
 
 void BuiltInsModule::registerTypes(Registry& registry) const {
@@ -190,6 +278,8 @@ void BuiltInsModule::registerTypes(Registry& registry) const {
     registry.registerType<ArgFloat>(
         [](llvm::LLVMContext& ctx) { return llvm::Type::getDoubleTy(ctx); }, zeroInitialized);
     registry.registerType<ArgString>();
+    // An empty view is all zeros. The LLVM type is an opaque struct, the view is only passed by pointer.
+    registry.registerType<ArgStringView>(nullptr, zeroInitialized);
 }
 
 void BuiltInsModule::registerFcts(Registry& registry) const {
@@ -261,15 +351,34 @@ void BuiltInsModule::registerFcts(Registry& registry) const {
     registry.registerFct(FctDesc<ArgString, ArgBool>(ArgString::name, stringCtor, NO_INTRINSIC, FctFlags::Pure));
     registry.registerFct(FctDesc<ArgString, ArgInteger>(ArgString::name, stringCtor, NO_INTRINSIC, FctFlags::Pure));
     registry.registerFct(FctDesc<ArgString, ArgFloat>(ArgString::name, stringCtor, NO_INTRINSIC, FctFlags::Pure));
+    // Assign variants reusing the capacity of the result (see FctLibrary::findAssignVariant).
+    const std::string stringAssignName = std::string("_assign_") + ArgString::name;
+    registry.registerFct(FctDesc<ArgString, ArgBool>(stringAssignName, stringAssign, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(FctDesc<ArgString, ArgInteger>(stringAssignName, stringAssign, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(FctDesc<ArgString, ArgFloat>(stringAssignName, stringAssign, NO_INTRINSIC, FctFlags::Pure));
 
     registry.registerFct(FctDesc<ArgString, ArgString, ArgInteger, ArgInteger>("substr", substr, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(FctDesc<ArgString, ArgString, ArgInteger, ArgInteger>("_assign_substr", substrAssign, NO_INTRINSIC, FctFlags::Pure));
     registry.registerFct(FctDesc<ArgString, ArgString, ArgVarArg<ArgString>>("join", join, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(FctDesc<ArgString, ArgString, ArgVarArg<ArgString>>("_assign_join", joinAssign, NO_INTRINSIC, FctFlags::Pure));
     registry.registerFct(FctDesc<ArgBool, ArgString, ArgString>("operator_eq", cmpPtr<std::equal_to<>>, NO_INTRINSIC, FctFlags::Pure));
     registry.registerFct(FctDesc<ArgBool, ArgString, ArgString>("operator_ne", cmpPtr<std::not_equal_to<>>, NO_INTRINSIC, FctFlags::Pure));
     registry.registerFct(FctDesc<ArgBool, ArgString, ArgString>("operator_lt", cmpPtr<std::less<>>, NO_INTRINSIC, FctFlags::Pure));
     registry.registerFct(FctDesc<ArgBool, ArgString, ArgString>("operator_gt", cmpPtr<std::greater<>>, NO_INTRINSIC, FctFlags::Pure));
     registry.registerFct(FctDesc<ArgBool, ArgString, ArgString>("operator_le", cmpPtr<std::less_equal<>>, NO_INTRINSIC, FctFlags::Pure));
     registry.registerFct(FctDesc<ArgBool, ArgString, ArgString>("operator_ge", cmpPtr<std::greater_equal<>>, NO_INTRINSIC, FctFlags::Pure));
+
+    // === StringView ===
+    // Conversion to an owning String, the only function copying the viewed bytes.
+    registry.registerFct(FctDesc<ArgString, ArgStringView>(ArgString::name, stringFromView, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(FctDesc<ArgString, ArgStringView>(stringAssignName, stringAssignView, NO_INTRINSIC, FctFlags::Pure));
+    // The result views into the input.
+    registry.registerFct(FctDesc<ArgStringView, ArgStringView, ArgInteger, ArgInteger>("substr", substrView, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(FctDesc<ArgString, ArgString, ArgVarArg<ArgStringView>>("join", joinView, NO_INTRINSIC, FctFlags::Pure));
+    registry.registerFct(FctDesc<ArgString, ArgString, ArgVarArg<ArgStringView>>("_assign_join", joinViewAssign, NO_INTRINSIC, FctFlags::Pure));
+    registerViewCmps<ArgStringView, ArgStringView>(registry);
+    registerViewCmps<ArgStringView, ArgString>(registry);
+    registerViewCmps<ArgString, ArgStringView>(registry);
 }
 
 } // namespace jex
@@ -3,6 +3,8 @@
 #include <jex_registry.hpp>
 
 #include <cstdint>
+#include <string>
+#include <string_view>
 
 namespace jex {
 
@@ -18,6 +20,11 @@ using ArgBool = ArgValue<bool, BoolName>;
 static constexpr char StringName[] = "String";
 using ArgString = ArgObject<std::string, StringName>;
 
+// Non-owning view for binding string inputs without copying them into the context. The viewed
+// bytes have to stay valid while exprs depending on the var are evaluated.
+static constexpr char StringViewName[] = "StringView";
+using ArgStringView = ArgValue<std::string_view, StringViewName>;
+
 /**
  * Defines a module containing the built-in types and functions.
  */
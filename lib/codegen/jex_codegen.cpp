@@ -3,12 +3,22 @@
 #include <jex_codegenvisitor.hpp>
 #include <jex_codemodule.hpp>
 #include <jex_compileenv.hpp>
+#include <jex_compilereport.hpp>
+#include <jex_diskobjectcache.hpp>
+#include <jex_environment.hpp>
+#include <jex_fctinfo.hpp>
 
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/raw_os_ostream.h"
+#include "llvm/Target/TargetMachine.h"
 
 namespace jex {
 
+// Module flag storing the optimization level of lazily compiled modules.
+static constexpr char s_lazyOptLevelFlag[] = "jex.lazyOptLevel";
+
 static llvm::PassBuilder::OptimizationLevel toLlvmOptLevel(OptLevel level) {
     using llvmOpt = llvm::PassBuilder::OptimizationLevel;
     switch (level) {
@@ -20,25 +30,66 @@ static llvm::PassBuilder::OptimizationLevel toLlvmOptLevel(OptLevel level) {
     return llvmOpt::O0; // LCOV_EXCL_LINE unreachable;
 }
 
-CodeGen::CodeGen(CompileEnv& env, OptLevel optLevel)
+CodeGen::CodeGen(CompileEnv& env, const CompileOptions& options,
+                 llvm::TargetMachine* targetMachine, DiskObjectCache* objectCache)
 : d_env(env)
 , d_module()
-, d_optLevel(optLevel) {
+, d_options(options)
+, d_targetMachine(targetMachine)
+, d_objectCache(objectCache) {
 }
 
-CodeGen::~CodeGen() = default;
+CodeGen::~CodeGen() {
+    // A module which was never released doesn't reach the JIT, so it won't take its object.
+    if (d_module && d_objectCache != nullptr) {
+        d_objectCache->discard(d_module->llvmModule());
+    }
+}
 
 const llvm::Module& CodeGen::getLlvmModule() const {
     return d_module->llvmModule();
 }
 
 void CodeGen::createIR() {
-    CodeGenVisitor codeGenVisitor(d_env);
-    codeGenVisitor.createIR();
-    // Any errors in code generation should be hard failures.
-    assert(!d_env.hasErrors());
-    d_module = codeGenVisitor.releaseModule();
-    optimize();
+    {
+        CompilePhase phase(d_env.report(), "code generation");
+        CodeGenVisitor codeGenVisitor(d_env, d_options);
+        codeGenVisitor.createIR();
+        // Any errors in code generation should be hard failures.
+        assert(!d_env.hasErrors());
+        d_module = codeGenVisitor.releaseModule();
+    }
+    llvm::Module& module = d_module->llvmModule();
+    CompileReport* report = d_env.report();
+    if (report != nullptr) {
+        report->d_irInstructionsBefore = module.getInstructionCount();
+        report->d_irInstructionsAfter = report->d_irInstructionsBefore;
+    }
+    if (d_targetMachine != nullptr) {
+        module.setTargetTriple(d_targetMachine->getTargetTriple().str());
+        module.setDataLayout(d_targetMachine->createDataLayout());
+    }
+    if (d_options.d_lazy) {
+        module.addModuleFlag(llvm::Module::Error, s_lazyOptLevelFlag, static_cast<uint32_t>(d_options.d_optLevel));
+        return; // Optimized per function on demand.
+    }
+    if (d_objectCache != nullptr) {
+        module.setModuleIdentifier(d_objectCache->computeKey(module, d_options.d_optLevel,
+            d_env.environment().fingerprint(/*includeFctAddresses*/false)));
+        if (d_objectCache->prefetch(module)) {
+            return; // The compiled object is loaded from the cache.
+        }
+    }
+    {
+        CompilePhase phase(report, "optimization");
+        optimize();
+    }
+    if (d_objectCache != nullptr && (d_optimized || d_options.d_optLevel == OptLevel::O0)) {
+        DiskObjectCache::markCacheable(module);
+    }
+    if (report != nullptr) {
+        report->d_irInstructionsAfter = module.getInstructionCount();
+    }
 }
 
 void CodeGen::printIR(std::ostream& out) {
@@ -48,12 +99,20 @@ void CodeGen::printIR(std::ostream& out) {
 }
 
 void CodeGen::optimize() {
-    if (d_optLevel == OptLevel::O0) {
+    if (d_options.d_optLevel == OptLevel::O0) {
         return; // Skip all optimizations.
     }
+    optimizeModule(d_module->llvmModule(), d_options.d_optLevel, d_targetMachine);
+    d_optimized = true;
+}
+
+void CodeGen::optimizeModule(llvm::Module& module, OptLevel optLevel, llvm::TargetMachine* targetMachine) {
+    if (optLevel == OptLevel::O0) {
+        return;
+    }
     // Build optimization pipeline.
-    llvm::PassBuilder passBuilder;
-    llvm::ModulePassManager passMgr = passBuilder.buildPerModuleDefaultPipeline(toLlvmOptLevel(d_optLevel));
+    llvm::PassBuilder passBuilder(/*DebugLogging*/false, targetMachine);
+    llvm::ModulePassManager passMgr = passBuilder.buildPerModuleDefaultPipeline(toLlvmOptLevel(optLevel));
     // Boilerplate code to have all the analysis manger objects on stack and registered.
     llvm::LoopAnalysisManager loopAnalysisManager;
     llvm::FunctionAnalysisManager functionAnalysisManager;
@@ -66,7 +125,15 @@ void CodeGen::optimize() {
     passBuilder.crossRegisterProxies(
         loopAnalysisManager, functionAnalysisManager, cGSCCAnalysisManager, moduleAnalysisManager);
     // Run the optimization passes.
-    passMgr.run(d_module->llvmModule(), moduleAnalysisManager);
+    passMgr.run(module, moduleAnalysisManager);
+}
+
+std::optional<OptLevel> CodeGen::getLazyOptLevel(const llvm::Module& module) {
+    auto* flag = llvm::mdconst::extract_or_null<llvm::ConstantInt>(module.getModuleFlag(s_lazyOptLevelFlag));
+    if (flag == nullptr) {
+        return std::nullopt;
+    }
+    return static_cast<OptLevel>(flag->getZExtValue());
 }
 
 std::unique_ptr<CodeModule> CodeGen::releaseModule() {
@@ -1,36 +1,66 @@
 #pragma once
 
 #include <jex_base.hpp>
+#include <jex_compileoptions.hpp>
 
 #include <memory>
+#include <optional>
 
 namespace llvm {
     class Module;
+    class TargetMachine;
 }
 
 namespace jex {
 
 class CodeModule;
 class CompileEnv;
-
-enum class OptLevel {
-    O0 = 0, O1, O2, O3
-};
+class DiskObjectCache;
 
 class CodeGen : NoCopy {
     CompileEnv& d_env;
     std::unique_ptr<CodeModule> d_module;
-    OptLevel d_optLevel;
+    CompileOptions d_options;
+    llvm::TargetMachine* d_targetMachine;
+    DiskObjectCache* d_objectCache;
+    bool d_optimized = false;
 
 public:
-    CodeGen(CompileEnv& env, OptLevel optLevel);
+    /**
+     * The options select the optimization level and the optional functions to generate, see
+     * CodeGenVisitor. With d_lazy the module isn't optimized by createIR(). Instead, the
+     * optimization level is recorded in the module, so that the backend can compile and optimize
+     * each function on demand.
+     * If a target machine is given, the module is created for its target and optimized with its
+     * cost model (e.g. vectorized for the available vector registers).
+     * If an object cache is given, the module gets tagged with its cache key and the
+     * optimization is skipped if the cache already contains the compiled object. The object
+     * cache isn't used for lazy modules.
+     */
+    CodeGen(CompileEnv& env, const CompileOptions& options,
+            llvm::TargetMachine* targetMachine = nullptr, DiskObjectCache* objectCache = nullptr);
     ~CodeGen();
 
     void createIR();
+    // Returns true if the optimization pipeline was run on the module.
+    bool isOptimized() const {
+        return d_optimized;
+    }
     void printIR(std::ostream& out);
     const llvm::Module& getLlvmModule() const;
     std::unique_ptr<CodeModule> releaseModule();
 
+    /**
+     * Runs the optimization pipeline for the given level on the module.
+     */
+    static void optimizeModule(llvm::Module& module, OptLevel optLevel,
+                               llvm::TargetMachine* targetMachine);
+    /**
+     * Returns the optimization level of a module created in lazy mode or nothing if the module
+     * isn't lazy.
+     */
+    static std::optional<OptLevel> getLazyOptLevel(const llvm::Module& module);
+
 private:
     void optimize();
 };
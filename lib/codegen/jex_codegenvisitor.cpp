@@ -5,17 +5,21 @@
 #include <jex_codemodule.hpp>
 #include <jex_constantstore.hpp>
 #include <jex_compileenv.hpp>
+#include <jex_contextlayout.hpp>
+#include <jex_dependencygraph.hpp>
 #include <jex_errorhandling.hpp>
 #include <jex_fctinfo.hpp>
 #include <jex_fctlibrary.hpp>
+#include <jex_sharedsubexprs.hpp>
 #include <jex_symboltable.hpp>
 #include <jex_unwind.hpp>
 
 #include "llvm/Support/FormatVariadic.h"
 
-#include <set>
+#include <algorithm>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 
 namespace jex {
 
@@ -23,8 +27,113 @@ static llvm::StringRef toLlvm(std::string_view str) {
     return llvm::StringRef(str.data(), str.length());
 }
 
-CodeGenVisitor::CodeGenVisitor(CompileEnv& env)
-: d_env(env) {
+namespace {
+
+// Collects the calls producing complex temporaries which have an assign variant.
+class ScratchCalls : public BasicAstVisitor {
+    const FctLibrary& d_fcts;
+    // Calls writing their results into the slot of their expr instead.
+    const std::unordered_set<const IAstExpression*>& d_inPlace;
+    std::vector<std::pair<const IAstExpression*, const FctInfo*>> d_calls;
+
+public:
+    ScratchCalls(const FctLibrary& fcts, const std::unordered_set<const IAstExpression*>& inPlace)
+    : d_fcts(fcts)
+    , d_inPlace(inPlace) {
+    }
+
+    const std::vector<std::pair<const IAstExpression*, const FctInfo*>>& getCalls() const {
+        return d_calls;
+    }
+
+    void visit(AstBinaryExpr& node) override {
+        BasicAstVisitor::visit(node);
+        add(node, node.d_fctInfo);
+    }
+    void visit(AstUnaryExpr& node) override {
+        BasicAstVisitor::visit(node);
+        add(node, node.d_fctInfo);
+    }
+    void visit(AstFctCall& node) override {
+        BasicAstVisitor::visit(node);
+        add(node, node.d_fctInfo);
+    }
+
+private:
+    void add(const IAstExpression& node, const FctInfo* fctInfo) {
+        if (!node.isTemporary() || node.d_resultType->kind() != TypeKind::Complex || d_inPlace.count(&node) != 0) {
+            return;
+        }
+        if (const FctInfo* assignFct = d_fcts.findAssignVariant(*fctInfo)) {
+            d_calls.emplace_back(&node, assignFct);
+        }
+    }
+};
+
+/**
+ * Collects the calls computing the complex result of an expr which can write into the expr's slot
+ * directly. This isn't possible if the expr reads its own slot, as the previous result would
+ * then be overwritten while it is still in use. Only calls with an assign variant qualify, others
+ * would have to destruct the previous result before the call, which leaves a destructed object
+ * in the slot if the call throws.
+ */
+class InPlaceCalls : public BasicAstVisitor {
+    const FctLibrary& d_fcts;
+    const AstVariableDef* d_def = nullptr;
+    const IAstExpression* d_call = nullptr;
+    bool d_readsSelf = false;
+    std::unordered_set<const IAstExpression*> d_calls;
+
+public:
+    explicit InPlaceCalls(const FctLibrary& fcts)
+    : d_fcts(fcts) {
+    }
+
+    const std::unordered_set<const IAstExpression*>& getCalls() const {
+        return d_calls;
+    }
+
+    void visit(AstVariableDef& node) override {
+        if (node.d_kind != VariableKind::Expr || node.d_resultType->kind() != TypeKind::Complex) {
+            return;
+        }
+        d_def = &node;
+        d_call = nullptr;
+        d_readsSelf = false;
+        node.d_expr->accept(*this);
+        if (d_call != nullptr && !d_readsSelf) {
+            d_calls.insert(d_call);
+        }
+    }
+    void visit(AstBinaryExpr& node) override {
+        setCall(node, node.d_fctInfo);
+        BasicAstVisitor::visit(node);
+    }
+    void visit(AstUnaryExpr& node) override {
+        setCall(node, node.d_fctInfo);
+        BasicAstVisitor::visit(node);
+    }
+    void visit(AstFctCall& node) override {
+        setCall(node, node.d_fctInfo);
+        BasicAstVisitor::visit(node);
+    }
+    void visit(AstIdentifier& node) override {
+        d_readsSelf = d_readsSelf || node.d_symbol == d_def->d_name->d_symbol;
+    }
+
+private:
+    void setCall(const IAstExpression& node, const FctInfo* fctInfo) {
+        if (&node == d_def->d_expr && d_fcts.findAssignVariant(*fctInfo) != nullptr) {
+            d_call = &node;
+        }
+    }
+};
+
+} // namespace
+
+CodeGenVisitor::CodeGenVisitor(CompileEnv& env, const CompileOptions& options)
+: d_env(env)
+, d_options(options) {
 }
 
 CodeGenVisitor::~CodeGenVisitor() = default;
@@ -68,6 +177,20 @@ void CodeGenVisitor::createDestruct(const Symbol* sym) {
     d_builder->CreateCall(dtorCallee, {getVarPtr(sym)});
 }
 
+void CodeGenVisitor::createReset(const Symbol* sym) {
+    TypeInfoId type = sym->type;
+    if (type->kind() == TypeKind::Value) {
+        // Value types don't need to be destructed, they are simply initialized again.
+        createInit(sym);
+        return;
+    }
+    // Complex types are cleared in place instead of being destructed and constructed again, so
+    // that they keep their resources (e.g. the capacity of a string) for the next use.
+    const FctInfo& clear = d_env.fctLibrary().getClear(type);
+    assert(clear.d_retType == type && "clear function has invalid return type");
+    d_builder->CreateCall(d_utils->getOrCreateFct(&clear), {getVarPtr(sym)});
+}
+
 template<typename Iter>
 void CodeGenVisitor::createInitDestructFct(Iter symBegin, Iter symEnd, const char* prefix,
                                            void(CodeGenVisitor::*createCall)(const Symbol*)) {
@@ -90,58 +213,151 @@ void CodeGenVisitor::createInitDestructFct(Iter symBegin, Iter symEnd, const cha
 }
 
 void CodeGenVisitor::createIR() {
-    d_offsets.clear();
+    d_dirtyBits.clear();
     d_module = std::make_unique<CodeModule>(d_env);
     d_utils = std::make_unique<CodeGenUtils>(d_env, *d_module);
     d_builder = std::make_unique<llvm::IRBuilder<>>(d_module->llvmContext());
-    // Order by alignment descending, then by symbol name ascending.
-    auto cmp = [](const Symbol* a, const Symbol* b) {
-        return a->type->alignment() > b->type->alignment() ? true : a->name < b->name;
-    };
-    std::set<const Symbol*, decltype(cmp)> vars(cmp);
+    std::vector<const Symbol*> symbols;
     for (AstVariableDef* varDef: d_env.getRoot()->d_varDefs) {
         // Skip constants as they are stored in the constant store and don't need to be
         // part of the context.
         if (varDef->d_kind != VariableKind::Const) {
-            vars.insert(varDef->d_name->d_symbol);
+            symbols.push_back(varDef->d_name->d_symbol);
         }
     }
-    size_t offset = 0;
-    for (const Symbol* sym : vars) {
-        d_offsets.emplace(sym, offset);
-        offset += sym->type->size();
+    if (d_options.d_shareSubexprs && (d_options.d_evalAll || !d_options.d_evalOutputs.empty())) {
+        createSharedSymbols();
+        for (const std::unique_ptr<Symbol>& sym : d_sharedSymbols) {
+            symbols.push_back(sym.get());
+        }
+    }
+    if (d_options.d_inPlaceResults) {
+        InPlaceCalls inPlace(d_env.fctLibrary());
+        d_env.getRoot()->accept(inPlace);
+        d_inPlace = inPlace.getCalls();
+    }
+    if (d_options.d_scratchSlots) {
+        createScratchSymbols();
+        for (const std::unique_ptr<Symbol>& sym : d_scratchSymbols) {
+            symbols.push_back(sym.get());
+        }
+    }
+    if (d_options.d_evalAll || !d_options.d_evalOutputs.empty() || d_options.d_incremental) {
+        d_graph = std::make_unique<DependencyGraph>(*d_env.getRoot());
+    }
+    if (d_options.d_incremental) {
+        for (const AstVariableDef* expr : d_graph->getEvaluationOrder()) {
+            d_dirtyBits.emplace(expr, d_dirtyBits.size());
+        }
+    }
+    // The dirty bitset is stored as 64 bit words in the hot part, it is touched by every setter.
+    size_t dirtySize = (d_dirtyBits.size() + 63) / 64 * sizeof(uint64_t);
+    d_layout = std::make_unique<ContextLayout>(symbols, d_options.d_layout, dirtySize);
+    d_dirtyOffset = d_layout->getHotReserveOffset();
+    // Initialize and destruct the context in layout order.
+    std::vector<const Symbol*> vars;
+    for (const ContextLayout::Slot& slot : d_layout->getSlots()) {
+        vars.push_back(slot.d_symbol);
+    }
+    d_env.setContextSize(d_layout->getContextSize());
+    d_env.setContextAlignment(d_layout->getContextAlignment());
+    d_env.setContextSlots(describeContextSlots());
+    d_env.setInputRecord(describeInputRecord());
+    if (d_options.d_columnar) {
+        for (AstVariableDef* varDef: d_env.getRoot()->d_varDefs) {
+            if (varDef->d_kind == VariableKind::Const) {
+                continue;
+            }
+            if (varDef->d_resultType->kind() != TypeKind::Value) {
+                throw InternalError("Columnar evaluation only supports value types, '" +
+                    std::string(varDef->d_name->d_name) + "' is of type " + varDef->d_resultType->name());
+            }
+            d_columns.emplace(varDef->d_name->d_symbol, d_columns.size());
+        }
+        d_columnAccessGroup = llvm::MDNode::getDistinct(d_module->llvmContext(), {});
     }
-    d_env.setContextSize(offset);
     d_rctxType = llvm::StructType::create(d_module->llvmContext(), "Rctx");
     d_env.getRoot()->accept(*this);
     // Generate lifetime functions for context.
     createInitDestructFct(vars.begin(), vars.end(), "__init", &CodeGenVisitor::createInit);
+    createInitDirtyMasks();
     createInitDestructFct(vars.begin(), vars.end(), "__destruct", &CodeGenVisitor::createDestruct);
+    if (d_options.d_resetFct) {
+        createInitDestructFct(vars.begin(), vars.end(), "__reset", &CodeGenVisitor::createReset);
+        createInitDirtyMasks();
+    }
+    if (d_options.d_columnar) {
+        createColumnarKernel();
+    }
+    if (d_options.d_setAll) {
+        createSetAllFcts();
+    }
+    if (d_shared) {
+        createSharedFcts();
+    }
+    if (d_options.d_evalAll) {
+        createEvalFct("__eval_all", d_graph->getEvaluationOrder());
+    }
+    if (!d_options.d_evalOutputs.empty()) {
+        std::vector<const AstVariableDef*> outputs;
+        for (const std::string& name : d_options.d_evalOutputs) {
+            const AstVariableDef* expr = d_graph->findExpr(name);
+            if (expr == nullptr) {
+                throw InternalError("Unknown expr '" + name + "' selected as output");
+            }
+            outputs.push_back(expr);
+        }
+        createEvalFct("__eval_outputs", d_graph->getEvaluationOrder(outputs));
+    }
+    if (d_options.d_incremental) {
+        createDirtyEvalFct();
+    }
 }
 
 llvm::Value* CodeGenVisitor::visitExpression(IAstExpression& node) {
     assert(d_result == nullptr);
+    if (d_useShared) {
+        if (std::optional<size_t> shared = d_shared->find(&node)) {
+            // Computed already, read it from its slot like a variable.
+            llvm::Value* slot = getVarPtr(d_sharedSymbols[*shared].get());
+            if (node.d_resultType->callConv() == TypeInfo::CallConv::ByValue) {
+                return d_builder->CreateLoad(slot);
+            }
+            return slot;
+        }
+    }
     node.accept(*this);
     assert(d_result != nullptr);
     return std::exchange(d_result, nullptr);
 }
 
 llvm::Value* CodeGenVisitor::getVarPtr(const Symbol* varSym) {
+    if (d_inRowFct) {
+        // Get the column and apply the row index to it.
+        llvm::Type* bytePtrTy = llvm::Type::getInt8PtrTy(d_module->llvmContext());
+        llvm::Value* columnIdx = llvm::ConstantInt::get(d_module->llvmContext(), llvm::APInt(64, d_columns.at(varSym)));
+        llvm::Value* columnPtr = d_builder->CreateGEP(bytePtrTy, d_currFct->getArg(0), columnIdx, "columnPtr");
+        llvm::Type* varTy = d_utils->getType(varSym->type);
+        llvm::Value* column = d_builder->CreatePointerCast(d_builder->CreateLoad(bytePtrTy, columnPtr),
+                                                           varTy->getPointerTo(), "column");
+        return d_builder->CreateGEP(varTy, column, d_currFct->getArg(1), "varPtrTyped");
+    }
     // Get rctx as i8*.
     llvm::Value* rctx = d_currFct->getArg(0);
     llvm::Type* bytePtrTy = llvm::Type::getInt8PtrTy(d_module->llvmContext());
     llvm::Value* rctxAsI8Ptr = d_builder->CreatePointerCast(rctx, bytePtrTy, "rctxAsBytePtr");
     // Apply offset to rctx pointer.
-    llvm::Value* offset = llvm::ConstantInt::get(d_module->llvmContext(), llvm::APInt(64, d_offsets[varSym]));
+    llvm::Value* offset = llvm::ConstantInt::get(d_module->llvmContext(), llvm::APInt(64, d_layout->getOffset(varSym)));
     llvm::Value* varPtr = d_builder->CreateGEP(bytePtrTy->getPointerElementType(), rctxAsI8Ptr, offset, "varPtr");
     // Reinterpret cast to target type.
     return d_builder->CreatePointerCast(varPtr, d_utils->getType(varSym->type)->getPointerTo(), "varPtrTyped");
 }
 
-void CodeGenVisitor::createAssign(llvm::Value* result, llvm::Value* source, TypeInfoId type) {
+void CodeGenVisitor::createAssign(llvm::Value* result, llvm::Value* source, TypeInfoId type, bool move) {
     assert(type->kind() == TypeKind::Complex && "Assign should only be called for complex types");
     assert(result->getType() == source->getType() && "Assign expects two pointers of the same type");
-    const FctInfo& assign = d_env.fctLibrary().getAssign(type);
+    const FctLibrary& fcts = d_env.fctLibrary();
+    const FctInfo& assign = move ? fcts.getMoveAssign(type) : fcts.getAssign(type);
     assert(assign.d_retType == type && "Return type of assign has to be equal to its parameter type");
     llvm::FunctionCallee assignCallee = d_utils->getOrCreateFct(&assign);
     d_builder->CreateCall(assignCallee, {result, source});
@@ -173,16 +389,85 @@ void CodeGenVisitor::createStoreVariableFct(AstVariableDef& node) {
     d_currFct->getArg(0)->setName("rctx");
     d_currFct->getArg(1)->setName("valPtr");
     d_builder->SetInsertPoint(createBlock("entry"));
-    // Perform assignment.
+    createStoreVariable(node, d_currFct->getArg(1));
+    if (d_options.d_incremental) {
+        // Mark all exprs depending on the variable dirty.
+        createMarkDirty(d_currFct->getArg(0), d_graph->getDependents(&node));
+    }
+    d_builder->CreateRetVoid();
+    d_currFct = nullptr;
+}
+
+void CodeGenVisitor::createStoreVariable(const AstVariableDef& node, llvm::Value* valPtr) {
     if (node.d_resultType->kind() == TypeKind::Value) {
         // Store value via load and store instruction.
-        llvm::Value* val = d_builder->CreateLoad(d_currFct->getArg(1));
+        llvm::Value* val = d_builder->CreateLoad(valPtr);
         d_builder->CreateStore(val, getVarPtr(node.d_name->d_symbol));
     } else {
-        createAssign(getVarPtr(node.d_name->d_symbol), d_currFct->getArg(1), node.d_resultType);
+        createAssign(getVarPtr(node.d_name->d_symbol), valPtr, node.d_resultType);
     }
-    d_builder->CreateRetVoid();
-    d_currFct = nullptr;
+}
+
+void CodeGenVisitor::createMarkDirty(llvm::Value* rctx, const std::vector<const AstVariableDef*>& exprs) {
+    std::vector<uint64_t> masks = getDirtyMasks(exprs);
+    for (size_t word = 0; word < masks.size(); ++word) {
+        if (masks[word] != 0) {
+            llvm::Value* wordPtr = getDirtyWordPtr(rctx, word);
+            llvm::Value* dirty = d_builder->CreateLoad(d_builder->getInt64Ty(), wordPtr, "dirty");
+            d_builder->CreateStore(d_builder->CreateOr(dirty, masks[word]), wordPtr);
+        }
+    }
+}
+
+void CodeGenVisitor::createSetAllFcts() {
+    std::vector<const AstVariableDef*> vars;
+    std::unordered_set<const AstVariableDef*> dependents;
+    for (const AstVariableDef* varDef : d_env.getRoot()->d_varDefs) {
+        if (varDef->d_kind == VariableKind::Var) {
+            vars.push_back(varDef);
+            if (d_options.d_incremental) {
+                std::vector<const AstVariableDef*> varDependents = d_graph->getDependents(varDef);
+                dependents.insert(varDependents.begin(), varDependents.end());
+            }
+        }
+    }
+    const std::vector<ContextSlotDesc>& record = d_env.getInputRecord();
+    assert(record.size() == vars.size());
+    llvm::Type* i8PtrTy = d_builder->getInt8PtrTy();
+    auto createFct = [&](const char* name, llvm::Type* inputTy, const char* inputName) {
+        llvm::FunctionType* fctType = llvm::FunctionType::get(
+            d_builder->getVoidTy(), {d_rctxType->getPointerTo(), inputTy}, false);
+        d_currFct = llvm::Function::Create(
+            fctType, llvm::GlobalValue::LinkageTypes::ExternalLinkage, name, d_module->llvmModule());
+        d_currFct->getArg(0)->setName("rctx");
+        d_currFct->getArg(1)->setName(inputName);
+        d_builder->SetInsertPoint(createBlock("entry"));
+    };
+    auto finishFct = [&]() {
+        if (d_options.d_incremental) {
+            createMarkDirty(d_currFct->getArg(0), {dependents.begin(), dependents.end()});
+        }
+        d_builder->CreateRetVoid();
+        d_currFct = nullptr;
+    };
+    // Create function void __set_all(Rctx* rctx, i8* input) reading the input record.
+    createFct("__set_all", i8PtrTy, "input");
+    for (size_t i = 0; i < vars.size(); ++i) {
+        llvm::Value* fieldPtr = d_builder->CreateGEP(d_builder->getInt8Ty(), d_currFct->getArg(1),
+            d_builder->getInt64(record[i].d_offset), "fieldPtr");
+        llvm::Type* valuePtrTy = d_utils->getType(vars[i]->d_resultType)->getPointerTo();
+        createStoreVariable(*vars[i], d_builder->CreatePointerCast(fieldPtr, valuePtrTy, "fieldPtrTyped"));
+    }
+    finishFct();
+    // Create function void __set_all_ptrs(Rctx* rctx, i8** values) reading a pointer per var.
+    createFct("__set_all_ptrs", i8PtrTy->getPointerTo(), "values");
+    for (size_t i = 0; i < vars.size(); ++i) {
+        llvm::Value* valPtrPtr = d_builder->CreateGEP(i8PtrTy, d_currFct->getArg(1), d_builder->getInt64(i), "valPtrPtr");
+        llvm::Value* valPtr = d_builder->CreateLoad(i8PtrTy, valPtrPtr, "valPtr");
+        llvm::Type* valuePtrTy = d_utils->getType(vars[i]->d_resultType)->getPointerTo();
+        createStoreVariable(*vars[i], d_builder->CreatePointerCast(valPtr, valuePtrTy, "valPtrTyped"));
+    }
+    finishFct();
 }
 
 void CodeGenVisitor::createExprFct(AstVariableDef& node) {
@@ -190,9 +475,30 @@ void CodeGenVisitor::createExprFct(AstVariableDef& node) {
     // Create function.
     llvm::Type* resultPtrType = d_utils->getReturnType(node.d_type->d_resultType);
     llvm::FunctionType* fctType = llvm::FunctionType::get(resultPtrType, {d_rctxType->getPointerTo()}, false);
-    d_currFct = llvm::Function::Create(
-        fctType, llvm::GlobalValue::LinkageTypes::ExternalLinkage, toLlvm(node.d_name->d_name), d_module->llvmModule());
+    createExprFct(node, fctType, toLlvm(node.d_name->d_name), llvm::GlobalValue::LinkageTypes::ExternalLinkage);
     d_currFct->getArg(0)->setName("rctx");
+    llvm::Function* exprFct = std::exchange(d_currFct, nullptr);
+    if (d_options.d_batchFcts) {
+        createBatchFct(*exprFct);
+    }
+    if (d_options.d_columnar) {
+        // Create function T* name.row(i8** columns, i64 row) used by the columnar kernel.
+        llvm::LLVMContext& ctx = d_module->llvmContext();
+        llvm::FunctionType* rowFctType = llvm::FunctionType::get(resultPtrType,
+            {llvm::Type::getInt8PtrTy(ctx)->getPointerTo(), llvm::Type::getInt64Ty(ctx)}, false);
+        d_inRowFct = true;
+        createExprFct(node, rowFctType, exprFct->getName() + ".row", llvm::GlobalValue::LinkageTypes::InternalLinkage);
+        d_inRowFct = false;
+        d_currFct->getArg(0)->setName("columns");
+        d_currFct->getArg(1)->setName("row");
+        d_currFct->addFnAttr(llvm::Attribute::AlwaysInline);
+        d_currFct = nullptr;
+    }
+}
+
+void CodeGenVisitor::createExprFct(AstVariableDef& node, llvm::FunctionType* fctType, const llvm::Twine& name,
+                                   llvm::GlobalValue::LinkageTypes linkage) {
+    d_currFct = llvm::Function::Create(fctType, linkage, name, d_module->llvmModule());
     // Initialize unwinding for handling lifetime.
     d_unwind = std::make_unique<Unwind>(d_env, *d_module, *d_utils, d_currFct);
     // Create "basic function structure".
@@ -200,24 +506,359 @@ void CodeGenVisitor::createExprFct(AstVariableDef& node) {
     llvm::BasicBlock* blockBegin = createBlock("begin");
     d_builder->SetInsertPoint(blockBegin);
     // Evaluate expression and store result.
+    if (!d_inRowFct && d_inPlace.count(node.d_expr) != 0) {
+        d_inPlaceCall = node.d_expr;
+        d_inPlaceSymbol = node.d_name->d_symbol;
+    }
     llvm::Value* result = visitExpression(*node.d_expr);
-    llvm::Value* varPtr = getVarPtr(node.d_name->d_symbol);
+    d_inPlaceCall = nullptr;
+    llvm::Value* varPtr = std::exchange(d_inPlaceResult, nullptr);
+    if (varPtr == nullptr) {
+        varPtr = getVarPtr(node.d_name->d_symbol);
+    }
     if (node.d_resultType->kind() == TypeKind::Complex) {
-        // TODO: Figure out if result is temporary and generate move assign instead.
-        createAssign(varPtr, result, node.d_resultType);
+        // Results written into the slot directly don't need to be copied.
+        if (result != varPtr) {
+            createAssign(varPtr, result, node.d_resultType, isOwnedTemporary(*node.d_expr));
+        }
     } else {
         // Perform a simple store.
         if (node.d_expr->d_resultType->callConv() == TypeInfo::CallConv::ByPointer) {
             // Load value to copy struct later on into varPtr.
             result = d_builder->CreateLoad(result);
         }
-        d_builder->CreateStore(result, varPtr);
+        llvm::StoreInst* store = d_builder->CreateStore(result, varPtr);
+        if (d_inRowFct) {
+            store->setMetadata(llvm::LLVMContext::MD_access_group, d_columnAccessGroup);
+        }
     }
     d_unwind->finalize(d_builder->GetInsertBlock(), varPtr);
     // Link allocas block to begin block.
     d_builder->SetInsertPoint(allocaBlock);
     d_builder->CreateBr(blockBegin);
     d_unwind.reset();
+}
+
+void CodeGenVisitor::createBatchFct(llvm::Function& exprFct) {
+    // Create function void name.batch(Rctx** rctxs, i64 count, T** results).
+    llvm::LLVMContext& ctx = d_module->llvmContext();
+    llvm::Type* voidTy = llvm::Type::getVoidTy(ctx);
+    llvm::Type* i64Ty = llvm::Type::getInt64Ty(ctx);
+    llvm::Type* rctxPtrTy = d_rctxType->getPointerTo();
+    llvm::Type* resultPtrTy = exprFct.getReturnType();
+    llvm::FunctionType* fctType = llvm::FunctionType::get(voidTy,
+        {rctxPtrTy->getPointerTo(), i64Ty, resultPtrTy->getPointerTo()}, false);
+    d_currFct = llvm::Function::Create(
+        fctType, llvm::GlobalValue::LinkageTypes::ExternalLinkage, exprFct.getName() + ".batch", d_module->llvmModule());
+    llvm::Value* rctxs = d_currFct->getArg(0);
+    llvm::Value* count = d_currFct->getArg(1);
+    llvm::Value* results = d_currFct->getArg(2);
+    rctxs->setName("rctxs");
+    count->setName("count");
+    results->setName("results");
+    // Neither array is accessed through another pointer while the function runs, so the context
+    // pointers needn't be reloaded after storing a result. Passing overlapping arrays (e.g. one
+    // buffer for both) is therefore undefined behavior. This says nothing about the contexts.
+    d_currFct->addParamAttr(0, llvm::Attribute::NoAlias);
+    d_currFct->addParamAttr(2, llvm::Attribute::NoAlias);
+    llvm::BasicBlock* entryBlock = createBlock("entry");
+    llvm::BasicBlock* loopBlock = createBlock("loop");
+    llvm::BasicBlock* storeBlock = createBlock("store_result");
+    llvm::BasicBlock* nextBlock = createBlock("next");
+    llvm::BasicBlock* exitBlock = createBlock("exit");
+    d_builder->SetInsertPoint(entryBlock);
+    llvm::Value* zero = llvm::ConstantInt::get(i64Ty, 0);
+    d_builder->CreateCondBr(d_builder->CreateICmpEQ(count, zero, "isEmpty"), exitBlock, loopBlock);
+    // Evaluate the expression for each context, the results are optional.
+    d_builder->SetInsertPoint(loopBlock);
+    llvm::PHINode* index = d_builder->CreatePHI(i64Ty, 2, "index");
+    index->addIncoming(zero, entryBlock);
+    llvm::Value* rctx = d_builder->CreateLoad(rctxPtrTy, d_builder->CreateGEP(rctxPtrTy, rctxs, index), "rctx");
+    llvm::Value* result = d_builder->CreateCall(&exprFct, {rctx}, "result");
+    d_builder->CreateCondBr(d_builder->CreateIsNull(results, "noResults"), nextBlock, storeBlock);
+    d_builder->SetInsertPoint(storeBlock);
+    d_builder->CreateStore(result, d_builder->CreateGEP(resultPtrTy, results, index));
+    d_builder->CreateBr(nextBlock);
+    d_builder->SetInsertPoint(nextBlock);
+    llvm::Value* nextIndex = d_builder->CreateAdd(index, llvm::ConstantInt::get(i64Ty, 1), "nextIndex");
+    index->addIncoming(nextIndex, nextBlock);
+    d_builder->CreateCondBr(d_builder->CreateICmpEQ(nextIndex, count, "isDone"), exitBlock, loopBlock);
+    d_builder->SetInsertPoint(exitBlock);
+    d_builder->CreateRetVoid();
+    d_currFct = nullptr;
+}
+
+void CodeGenVisitor::createColumnarKernel() {
+    // Create function void __eval_columns(i8** columns, i64 count).
+    llvm::LLVMContext& ctx = d_module->llvmContext();
+    llvm::Type* i64Ty = llvm::Type::getInt64Ty(ctx);
+    llvm::FunctionType* fctType = llvm::FunctionType::get(llvm::Type::getVoidTy(ctx),
+        {llvm::Type::getInt8PtrTy(ctx)->getPointerTo(), i64Ty}, false);
+    d_currFct = llvm::Function::Create(
+        fctType, llvm::GlobalValue::LinkageTypes::ExternalLinkage, "__eval_columns", d_module->llvmModule());
+    llvm::Value* columns = d_currFct->getArg(0);
+    llvm::Value* count = d_currFct->getArg(1);
+    columns->setName("columns");
+    count->setName("count");
+    // The column pointers aren't modified by the kernel, so they can be loaded once.
+    d_currFct->addParamAttr(0, llvm::Attribute::NoAlias);
+    llvm::BasicBlock* entryBlock = createBlock("entry");
+    llvm::BasicBlock* loopBlock = createBlock("loop");
+    llvm::BasicBlock* exitBlock = createBlock("exit");
+    d_builder->SetInsertPoint(entryBlock);
+    llvm::Value* zero = llvm::ConstantInt::get(i64Ty, 0);
+    d_builder->CreateCondBr(d_builder->CreateICmpEQ(count, zero, "isEmpty"), exitBlock, loopBlock);
+    // Evaluate all exprs row by row.
+    d_builder->SetInsertPoint(loopBlock);
+    llvm::PHINode* row = d_builder->CreatePHI(i64Ty, 2, "row");
+    row->addIncoming(zero, entryBlock);
+    for (AstVariableDef* varDef: d_env.getRoot()->d_varDefs) {
+        if (varDef->d_kind == VariableKind::Expr) {
+            llvm::Function* rowFct = d_module->llvmModule().getFunction(
+                (toLlvm(varDef->d_name->d_name) + ".row").str());
+            assert(rowFct != nullptr);
+            d_builder->CreateCall(rowFct, {columns, row});
+        }
+    }
+    llvm::Value* nextRow = d_builder->CreateAdd(row, llvm::ConstantInt::get(i64Ty, 1), "nextRow");
+    row->addIncoming(nextRow, loopBlock);
+    llvm::BranchInst* latch = d_builder->CreateCondBr(d_builder->CreateICmpEQ(nextRow, count, "isDone"), exitBlock, loopBlock);
+    llvm::MDNode* parallelAccesses = llvm::MDNode::get(ctx,
+        {llvm::MDString::get(ctx, "llvm.loop.parallel_accesses"), d_columnAccessGroup});
+    llvm::MDNode* loopId = llvm::MDNode::getDistinct(ctx, {nullptr, parallelAccesses});
+    loopId->replaceOperandWith(0, loopId);
+    latch->setMetadata(llvm::LLVMContext::MD_loop, loopId);
+    d_builder->SetInsertPoint(exitBlock);
+    d_builder->CreateRetVoid();
+    d_currFct = nullptr;
+}
+
+void CodeGenVisitor::createEvalFct(const char* name, const std::vector<const AstVariableDef*>& exprs) {
+    // Create function void name(Rctx* rctx).
+    llvm::FunctionType* fctType = llvm::FunctionType::get(
+        llvm::Type::getVoidTy(d_module->llvmContext()), {d_rctxType->getPointerTo()}, false);
+    d_currFct = llvm::Function::Create(
+        fctType, llvm::GlobalValue::LinkageTypes::ExternalLinkage, name, d_module->llvmModule());
+    llvm::Value* rctx = d_currFct->getArg(0);
+    rctx->setName("rctx");
+    d_builder->SetInsertPoint(createBlock("entry"));
+    // The results are stored in the context, so the returned pointers aren't needed.
+    std::vector<bool> isComputed(d_sharedDefs.size());
+    for (const AstVariableDef* expr : exprs) {
+        std::string fctName(expr->d_name->d_name);
+        if (d_shared) {
+            // Compute the shared calls before their first use.
+            std::vector<size_t> used = d_shared->getUsed(expr);
+            for (size_t shared : used) {
+                if (!isComputed[shared]) {
+                    d_builder->CreateCall(d_module->llvmModule().getFunction(
+                        toLlvm(d_sharedDefs[shared]->d_name->d_name)), {rctx});
+                    isComputed[shared] = true;
+                }
+            }
+            if (!used.empty()) {
+                fctName += ".fused";
+            }
+        }
+        llvm::Function* exprFct = d_module->llvmModule().getFunction(fctName);
+        assert(exprFct != nullptr);
+        d_builder->CreateCall(exprFct, {rctx});
+    }
+    d_builder->CreateRetVoid();
+    d_currFct = nullptr;
+}
+
+llvm::Value* CodeGenVisitor::getDirtyWordPtr(llvm::Value* rctx, size_t word) {
+    llvm::Value* rctxAsI8Ptr = d_builder->CreatePointerCast(rctx, d_builder->getInt8PtrTy(), "rctxAsBytePtr");
+    llvm::Value* wordPtr = d_builder->CreateGEP(d_builder->getInt8Ty(), rctxAsI8Ptr,
+        d_builder->getInt64(d_dirtyOffset + word * sizeof(uint64_t)), "dirtyPtr");
+    return d_builder->CreatePointerCast(wordPtr, d_builder->getInt64Ty()->getPointerTo(), "dirtyPtrTyped");
+}
+
+std::vector<uint64_t> CodeGenVisitor::getDirtyMasks(const std::vector<const AstVariableDef*>& exprs) const {
+    std::vector<uint64_t> masks((d_dirtyBits.size() + 63) / 64);
+    for (const AstVariableDef* expr : exprs) {
+        size_t bit = d_dirtyBits.at(expr);
+        masks[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    return masks;
+}
+
+std::vector<ContextSlotDesc> CodeGenVisitor::describeContextSlots() const {
+    std::vector<ContextSlotDesc> slots;
+    for (const ContextLayout::Slot& slot : d_layout->getSlots()) {
+        const Symbol* sym = slot.d_symbol;
+        // The slots of shared calls and scratch slots are internal.
+        if (sym->defNode == nullptr ||
+            std::find(d_sharedDefs.begin(), d_sharedDefs.end(), sym->defNode) != d_sharedDefs.end()) {
+            continue;
+        }
+        ContextSlotDesc::Kind kind = sym->defNode->d_kind == VariableKind::Expr
+            ? ContextSlotDesc::Kind::Expr : ContextSlotDesc::Kind::Var;
+        TypeInfoId type = sym->type;
+        slots.push_back(ContextSlotDesc{std::string(sym->name), type->name(), kind, type->kind(),
+                                        slot.d_offset, type->size(), type->alignment()});
+    }
+    return slots;
+}
+
+std::vector<ContextSlotDesc> CodeGenVisitor::describeInputRecord() const {
+    // The vars in declaration order, laid out like the members of a C struct.
+    std::vector<ContextSlotDesc> record;
+    size_t offset = 0;
+    for (const AstVariableDef* varDef : d_env.getRoot()->d_varDefs) {
+        if (varDef->d_kind != VariableKind::Var) {
+            continue;
+        }
+        TypeInfoId type = varDef->d_resultType;
+        offset = (offset + type->alignment() - 1) / type->alignment() * type->alignment();
+        record.push_back(ContextSlotDesc{std::string(varDef->d_name->d_name), type->name(),
+                                         ContextSlotDesc::Kind::Var, type->kind(), offset,
+                                         type->size(), type->alignment()});
+        offset += type->size();
+    }
+    return record;
+}
+
+void CodeGenVisitor::createScratchSymbols() {
+    ScratchCalls calls(d_env.fctLibrary(), d_inPlace);
+    d_env.getRoot()->accept(calls);
+    for (const auto& [node, assignFct] : calls.getCalls()) {
+        // Scratch slots don't have a definition, the name can't clash with identifiers.
+        std::string_view name = d_env.createStringLiteral("__scratch." + std::to_string(d_scratchSymbols.size()));
+        Symbol* sym = d_scratchSymbols.emplace_back(
+            std::make_unique<Symbol>(Symbol::Kind::Variable, name, node->d_resultType, nullptr)).get();
+        d_scratch.emplace(node, Scratch{sym, assignFct});
+    }
+}
+
+const CodeGenVisitor::Scratch* CodeGenVisitor::findScratch(const IAstExpression& node) const {
+    // Row functions don't have a context.
+    if (d_inRowFct) {
+        return nullptr;
+    }
+    auto iter = d_scratch.find(&node);
+    return iter != d_scratch.end() ? &iter->second : nullptr;
+}
+
+std::pair<const FctInfo*, llvm::Value*> CodeGenVisitor::createCallResult(IAstExpression& node, const FctInfo* fctInfo) {
+    if (&node == d_inPlaceCall) {
+        // Write into the expr's slot, reusing its resources via the assign variant.
+        d_inPlaceResult = getVarPtr(d_inPlaceSymbol);
+        const FctInfo* assignFct = d_env.fctLibrary().findAssignVariant(*fctInfo);
+        assert(assignFct != nullptr && "In-place calls need an assign variant");
+        return {assignFct, d_inPlaceResult};
+    }
+    if (const Scratch* scratch = findScratch(node)) {
+        return {scratch->d_assignFct, getVarPtr(scratch->d_symbol)};
+    }
+    llvm::Type* resType = d_utils->getType(node.d_resultType);
+    return {fctInfo, new llvm::AllocaInst(resType, 0, "res_" + fctInfo->d_name, &d_currFct->getEntryBlock())};
+}
+
+bool CodeGenVisitor::isOwnedTemporary(const IAstExpression& node) const {
+    // Scratch and shared slots keep their values for later evaluations.
+    if (!node.isTemporary() || findScratch(node) != nullptr || (d_useShared && d_shared->find(&node))) {
+        return false;
+    }
+    // An if() takes the value of one of its branches.
+    if (const auto* ifNode = dynamic_cast<const AstIf*>(&node)) {
+        return isOwnedTemporary(*ifNode->d_args->d_args[1]) && isOwnedTemporary(*ifNode->d_args->d_args[2]);
+    }
+    return true;
+}
+
+void CodeGenVisitor::addUnwind(IAstExpression& node, llvm::Value* value) {
+    // Scratch slots and results written into their expr's slot are destructed with the context.
+    if (findScratch(node) == nullptr && &node != d_inPlaceCall) {
+        d_unwind->add(node, value);
+    }
+}
+
+void CodeGenVisitor::createSharedSymbols() {
+    d_shared = std::make_unique<SharedSubexprs>(*d_env.getRoot());
+    const std::vector<SharedSubexprs::Shared>& shared = d_shared->getShared();
+    for (size_t i = 0; i < shared.size(); ++i) {
+        // Define a hidden expr computing the first occurrence. The name can't clash with
+        // identifiers of the program.
+        AstFctCall* call = shared[i].d_occurrences.front();
+        TypeInfoId type = call->d_resultType;
+        std::string_view name = d_env.createStringLiteral("__shared." + std::to_string(i));
+        Symbol* sym = d_sharedSymbols.emplace_back(
+            std::make_unique<Symbol>(Symbol::Kind::Variable, name, type, nullptr)).get();
+        AstIdentifier* nameIdent = d_env.createNode<AstIdentifier>(call->d_loc, type, name);
+        nameIdent->d_symbol = sym;
+        AstIdentifier* typeIdent = d_env.createNode<AstIdentifier>(call->d_loc, type, type->name());
+        sym->defNode = d_env.createNode<AstVariableDef>(call->d_loc, nameIdent, typeIdent, call, VariableKind::Expr);
+        d_sharedDefs.push_back(sym->defNode);
+    }
+}
+
+void CodeGenVisitor::createSharedFcts() {
+    llvm::Type* rctxPtrTy = d_rctxType->getPointerTo();
+    auto createFct = [&](AstVariableDef& node, const llvm::Twine& name) {
+        llvm::FunctionType* fctType = llvm::FunctionType::get(
+            d_utils->getReturnType(node.d_resultType), {rctxPtrTy}, false);
+        createExprFct(node, fctType, name, llvm::GlobalValue::LinkageTypes::InternalLinkage);
+        d_currFct->getArg(0)->setName("rctx");
+        d_currFct = nullptr;
+    };
+    for (AstVariableDef* sharedDef : d_sharedDefs) {
+        createFct(*sharedDef, toLlvm(sharedDef->d_name->d_name));
+    }
+    d_useShared = true;
+    for (AstVariableDef* varDef : d_env.getRoot()->d_varDefs) {
+        if (varDef->d_kind == VariableKind::Expr && !d_shared->getUsed(varDef).empty()) {
+            createFct(*varDef, toLlvm(varDef->d_name->d_name) + ".fused");
+        }
+    }
+    d_useShared = false;
+}
+
+void CodeGenVisitor::createInitDirtyMasks() {
+    if (!d_options.d_incremental) {
+        return;
+    }
+    // All exprs are dirty until their first evaluation.
+    d_builder->SetInsertPoint(d_currFct->getEntryBlock().getTerminator());
+    std::vector<uint64_t> masks = getDirtyMasks(d_graph->getEvaluationOrder());
+    for (size_t word = 0; word < masks.size(); ++word) {
+        d_builder->CreateStore(d_builder->getInt64(masks[word]), getDirtyWordPtr(d_currFct->getArg(0), word));
+    }
+}
+
+void CodeGenVisitor::createDirtyEvalFct() {
+    // Create function void __eval_dirty(Rctx* rctx).
+    llvm::FunctionType* fctType = llvm::FunctionType::get(
+        d_builder->getVoidTy(), {d_rctxType->getPointerTo()}, false);
+    d_currFct = llvm::Function::Create(
+        fctType, llvm::GlobalValue::LinkageTypes::ExternalLinkage, "__eval_dirty", d_module->llvmModule());
+    llvm::Value* rctx = d_currFct->getArg(0);
+    rctx->setName("rctx");
+    d_builder->SetInsertPoint(createBlock("entry"));
+    // The exprs don't modify the flags, so each word only needs to be loaded once.
+    std::vector<llvm::Value*> words;
+    for (size_t word = 0; word < (d_dirtyBits.size() + 63) / 64; ++word) {
+        words.push_back(d_builder->CreateLoad(d_builder->getInt64Ty(), getDirtyWordPtr(rctx, word), "dirty"));
+    }
+    for (const AstVariableDef* expr : d_graph->getEvaluationOrder()) {
+        size_t bit = d_dirtyBits.at(expr);
+        llvm::Value* flag = d_builder->CreateAnd(words[bit / 64], uint64_t(1) << (bit % 64));
+        llvm::BasicBlock* evalBlock = createBlock("eval");
+        llvm::BasicBlock* nextBlock = createBlock("next");
+        d_builder->CreateCondBr(d_builder->CreateIsNotNull(flag, "isDirty"), evalBlock, nextBlock);
+        d_builder->SetInsertPoint(evalBlock);
+        llvm::Function* exprFct = d_module->llvmModule().getFunction(toLlvm(expr->d_name->d_name));
+        assert(exprFct != nullptr);
+        d_builder->CreateCall(exprFct, {rctx});
+        d_builder->CreateBr(nextBlock);
+        d_builder->SetInsertPoint(nextBlock);
+    }
+    // Reset the flags only after all exprs were evaluated successfully.
+    for (size_t word = 0; word < words.size(); ++word) {
+        d_builder->CreateStore(d_builder->getInt64(0), getDirtyWordPtr(rctx, word));
+    }
+    d_builder->CreateRetVoid();
     d_currFct = nullptr;
 }
 
@@ -240,7 +881,7 @@ void CodeGenVisitor::visit(AstLiteralExpr& node) {
                 return constGlobal;
             }
             const FctInfo& dtor = d_env.fctLibrary().getFct("_dtor_" + strType->name(), {});
-            d_env.constants().emplace<std::string>(constantName, dtor, val);
+            d_env.constants().emplace<std::string>(constantName, strType, dtor, val);
             auto linkage = llvm::GlobalValue::LinkageTypes::ExternalLinkage;
             llvm::Value* var = new llvm::GlobalVariable(d_module->llvmModule(), d_utils->getType(strType),
                 /*isConstant*/true, linkage, nullptr, constantName);
@@ -253,31 +894,31 @@ void CodeGenVisitor::visit(AstBinaryExpr& node) {
     // Generate argument evaluation.
     llvm::Value* lhs = visitExpression(*node.d_lhs);
     llvm::Value* rhs = visitExpression(*node.d_rhs);
-    // Generate alloca to store the result.
-    llvm::Type* resType = d_utils->getType(node.d_resultType);
-    d_result = new llvm::AllocaInst(resType, 0, "res_" + node.d_fctInfo->d_name, &d_currFct->getEntryBlock());
-    llvm::FunctionCallee fct = d_utils->getOrCreateFct(node.d_fctInfo);
+    // Get the stack or scratch slot to store the result.
+    auto [fctInfo, result] = createCallResult(node, node.d_fctInfo);
+    d_result = result;
+    llvm::FunctionCallee fct = d_utils->getOrCreateFct(fctInfo);
     // Call the function.
     d_builder->CreateCall(fct.getFunctionType(), fct.getCallee(), {d_result, lhs, rhs});
     if (node.d_resultType->callConv() == TypeInfo::CallConv::ByValue) {
         d_result = d_builder->CreateLoad(d_result);
     }
-    d_unwind->add(node, d_result);
+    addUnwind(node, d_result);
 }
 
 void CodeGenVisitor::visit(AstUnaryExpr& node) {
     // Generate argument evaluation.
     llvm::Value* inner = visitExpression(*node.d_expr);
-    // Generate alloca to store the result.
-    llvm::Type* resType = d_utils->getType(node.d_resultType);
-    d_result = new llvm::AllocaInst(resType, 0, "res_" + node.d_fctInfo->d_name, &d_currFct->getEntryBlock());
-    llvm::FunctionCallee fct = d_utils->getOrCreateFct(node.d_fctInfo);
+    // Get the stack or scratch slot to store the result.
+    auto [fctInfo, result] = createCallResult(node, node.d_fctInfo);
+    d_result = result;
+    llvm::FunctionCallee fct = d_utils->getOrCreateFct(fctInfo);
     // Call the function.
     d_builder->CreateCall(fct.getFunctionType(), fct.getCallee(), {d_result, inner});
     if (node.d_resultType->callConv() == TypeInfo::CallConv::ByValue) {
         d_result = d_builder->CreateLoad(d_result);
     }
-    d_unwind->add(node, d_result);
+    addUnwind(node, d_result);
 }
 
 void CodeGenVisitor::visit(AstVarArg& node) {
@@ -314,18 +955,18 @@ void CodeGenVisitor::visit(AstFctCall& node) {
     for (IAstExpression* expr : node.d_args->d_args) {
         args.push_back(visitExpression(*expr));
     }
-    // Generate alloca to store the result (after argument visit for better code readability).
-    llvm::Type* resType = d_utils->getType(node.d_resultType);
-    llvm::Value* res = new llvm::AllocaInst(resType, 0, "res_" + node.d_fctInfo->d_name, &d_currFct->getEntryBlock());
+    // Get the stack or scratch slot to store the result (after argument visit for better code
+    // readability).
+    auto [fctInfo, res] = createCallResult(node, node.d_fctInfo);
     args[0] = res;
-    llvm::FunctionCallee fct = d_utils->getOrCreateFct(node.d_fctInfo);
+    llvm::FunctionCallee fct = d_utils->getOrCreateFct(fctInfo);
     // Call the function.
     d_builder->CreateCall(fct.getFunctionType(), fct.getCallee(), args);
     d_result = res;
     if (node.d_resultType->callConv() == TypeInfo::CallConv::ByValue) {
         d_result = d_builder->CreateLoad(d_result);
     }
-    d_unwind->add(node, d_result);
+    addUnwind(node, d_result);
 }
 
 void CodeGenVisitor::visit(AstLogicalBinExpr& node) {
@@ -481,7 +1122,11 @@ void CodeGenVisitor::visit(AstIdentifier& node) {
     assert(defNode->d_kind == VariableKind::Var || defNode->d_kind == VariableKind::Expr);
     d_result = getVarPtr(node.d_symbol);
     if (node.d_resultType->callConv() == TypeInfo::CallConv::ByValue) {
-        d_result = d_builder->CreateLoad(d_result);
+        llvm::LoadInst* load = d_builder->CreateLoad(d_result);
+        if (d_inRowFct) {
+            load->setMetadata(llvm::LLVMContext::MD_access_group, d_columnAccessGroup);
+        }
+        d_result = load;
     }
 }
 
@@ -2,34 +2,120 @@
 
 #include <jex_base.hpp>
 #include <jex_basicastvisitor.hpp>
+#include <jex_compileoptions.hpp>
 #include <jex_typeinfo.hpp>
 
 #include "llvm/IR/IRBuilder.h"
 
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace jex {
 
+class AstVariableDef;
 class CodeGenUtils;
 class CodeModule;
 class CompileEnv;
+class ContextLayout;
+struct ContextSlotDesc;
+class DependencyGraph;
+class IAstExpression;
+class SharedSubexprs;
 class FctInfo;
 class Unwind;
 struct Symbol;
 
 class CodeGenVisitor : private BasicAstVisitor, NoCopy {
     CompileEnv& d_env;
+    const CompileOptions& d_options;
     std::unique_ptr<CodeModule> d_module;
     std::unique_ptr<llvm::IRBuilder<>> d_builder;
     llvm::Function* d_currFct = nullptr;
     std::unique_ptr<CodeGenUtils> d_utils;
     std::unique_ptr<Unwind> d_unwind;
-    std::unordered_map<const Symbol*, size_t> d_offsets;
+    std::unique_ptr<ContextLayout> d_layout;
     llvm::StructType* d_rctxType = nullptr;
     llvm::Value* d_result = nullptr;
+    // Column index of each var and expr in columnar mode.
+    std::unordered_map<const Symbol*, size_t> d_columns;
+    // Set while generating a row function for the columnar kernel.
+    bool d_inRowFct = false;
+    // Access group of all column accesses. The rows are independent, so the kernel's loop can be
+    // marked as parallel for these accesses which allows vectorizing it.
+    llvm::MDNode* d_columnAccessGroup = nullptr;
+    std::unique_ptr<DependencyGraph> d_graph;
+    // Bit index of each expr in the dirty bitset and the bitset's offset in the context.
+    std::unordered_map<const AstVariableDef*, size_t> d_dirtyBits;
+    size_t d_dirtyOffset = 0;
+    std::unique_ptr<SharedSubexprs> d_shared;
+    // Hidden context slot and definition of each shared call.
+    std::vector<std::unique_ptr<Symbol>> d_sharedSymbols;
+    std::vector<AstVariableDef*> d_sharedDefs;
+    // Set while generating expr functions reading shared calls from their slots.
+    bool d_useShared = false;
+    // Hidden context slot and assign variant of each call result kept in a scratch slot.
+    struct Scratch {
+        const Symbol* d_symbol;
+        const FctInfo* d_assignFct;
+    };
+    std::unordered_map<const IAstExpression*, Scratch> d_scratch;
+    std::vector<std::unique_ptr<Symbol>> d_scratchSymbols;
+    // Calls writing the result of their expr into the expr's slot directly.
+    std::unordered_set<const IAstExpression*> d_inPlace;
+    // Set while generating an expr function whose result is written into its slot directly.
+    const IAstExpression* d_inPlaceCall = nullptr;
+    const Symbol* d_inPlaceSymbol = nullptr;
+    llvm::Value* d_inPlaceResult = nullptr;
 public:
-    CodeGenVisitor(CompileEnv& env);
+    /**
+     * Besides the expr functions and the context functions, the functions requested by the
+     * options are generated. The options have to outlive the visitor.
+     * - d_batchFcts: a batch variant `void name.batch(Rctx** rctxs, i64 count, T** results)` for
+     *   each expr. It evaluates the expr for count contexts and stores the result pointers into
+     *   results unless it is null. Both arrays are marked noalias, so they must not overlap.
+     * - d_columnar: a kernel `void __eval_columns(i8** columns, i64 count)`. Each var and expr is
+     *   bound to a column (an array of its values) in declaration order and the kernel evaluates
+     *   all exprs for count rows in declaration order. Only value types are supported.
+     * - d_evalAll: `void __eval_all(Rctx* rctx)` calling every expr once, each after the exprs it
+     *   references.
+     * - d_evalOutputs: `void __eval_outputs(Rctx* rctx)` calling the given exprs and the exprs
+     *   they depend on, each once and in dependency order.
+     * - d_incremental: the context holds a bitset with a dirty flag per expr. All exprs are dirty
+     *   initially and each var setter marks the exprs depending on the var dirty.
+     *   `void __eval_dirty(Rctx* rctx)` evaluates the dirty exprs in dependency order and resets
+     *   their flags. Exprs not depending on any set var are therefore only evaluated once, even
+     *   if they call non-deterministic functions or reference themselves.
+     * - d_shareSubexprs: calls of pure functions shared by several exprs (see SharedSubexprs) are
+     *   computed only once by __eval_all and __eval_outputs. Each shared call gets a hidden
+     *   context slot and an internal function `__shared.N(Rctx* rctx)` computing it. Exprs using
+     *   shared calls get an internal variant `name.fused(Rctx* rctx)` reading them from their
+     *   slots. The regular expr functions are unchanged.
+     * - d_resetFct: `void __reset_rctx(Rctx* rctx)` bringing an initialized context back into the
+     *   state after __init_rctx. Complex members are cleared in place with _clear_<Type>, so they
+     *   keep resources like the capacity of a string. Value members and the dirty bits are
+     *   initialized like in __init_rctx.
+     * - d_setAll: `void __set_all(Rctx* rctx, i8* input)` reading all vars from an input record
+     *   holding them in declaration order, laid out like the members of a C struct (see
+     *   CompileEnv::getInputRecord()), and `void __set_all_ptrs(Rctx* rctx, i8** values)` reading
+     *   them from an array of pointers in declaration order.
+     * - d_scratchSlots: each call producing a complex temporary whose function has an assign
+     *   variant (see FctLibrary::findAssignVariant()) gets a hidden context slot `__scratch.N`.
+     *   The slots are constructed by __init_rctx and destructed by __destruct_rctx. The calls
+     *   write their results into their slots via the assign variant, so the results don't need
+     *   to be destructed after each evaluation and their resources (e.g. string capacity) are
+     *   reused. Other calls and the row functions of the columnar kernel still use stack
+     *   temporaries.
+     * - d_inPlaceResults: the call computing the complex result of an expr writes it into the
+     *   expr's slot directly via the function's assign variant instead of into a temporary which
+     *   is copied into the slot and destructed. Exprs reading their own slot still use a
+     *   temporary.
+     * - d_layout: the options for the context layout, see ContextLayout.
+     */
+    CodeGenVisitor(CompileEnv& env, const CompileOptions& options);
     ~CodeGenVisitor();
 
     void createIR();
@@ -51,15 +137,39 @@ public:
 private:
     llvm::Value* visitExpression(IAstExpression& node);
     llvm::Value* getVarPtr(const Symbol* varSym);
-    void createAssign(llvm::Value* result, llvm::Value* source, TypeInfoId type);
+    // Copies source into result, or moves it if move is set.
+    void createAssign(llvm::Value* result, llvm::Value* source, TypeInfoId type, bool move = false);
     void createInit(const Symbol* sym);
     void createDestruct(const Symbol* sym);
+    void createReset(const Symbol* sym);
+    void createInitDirtyMasks();
     llvm::BasicBlock* createBlock(const char* name);
     llvm::Constant* createConstant(TypeInfoId typeId, const std::string& constantName);
     llvm::Constant* createConstant(llvm::Type* type, void*& valPtr, size_t& space, int level);
 
     void createStoreVariableFct(AstVariableDef& node);
     void createExprFct(AstVariableDef& node);
+    void createExprFct(AstVariableDef& node, llvm::FunctionType* fctType, const llvm::Twine& name,
+                       llvm::GlobalValue::LinkageTypes linkage);
+    void createBatchFct(llvm::Function& exprFct);
+    void createColumnarKernel();
+    void createEvalFct(const char* name, const std::vector<const AstVariableDef*>& exprs);
+    void createDirtyEvalFct();
+    std::vector<ContextSlotDesc> describeContextSlots() const;
+    std::vector<ContextSlotDesc> describeInputRecord() const;
+    void createStoreVariable(const AstVariableDef& node, llvm::Value* valPtr);
+    void createMarkDirty(llvm::Value* rctx, const std::vector<const AstVariableDef*>& exprs);
+    void createSetAllFcts();
+    void createSharedSymbols();
+    void createSharedFcts();
+    void createScratchSymbols();
+    const Scratch* findScratch(const IAstExpression& node) const;
+    std::pair<const FctInfo*, llvm::Value*> createCallResult(IAstExpression& node, const FctInfo* fctInfo);
+    // Returns whether the value of node is a temporary destructed after the evaluation.
+    bool isOwnedTemporary(const IAstExpression& node) const;
+    void addUnwind(IAstExpression& node, llvm::Value* value);
+    llvm::Value* getDirtyWordPtr(llvm::Value* rctx, size_t word);
+    std::vector<uint64_t> getDirtyMasks(const std::vector<const AstVariableDef*>& exprs) const;
 
     template<typename Iter>
     void createInitDestructFct(Iter symBegin, Iter symEnd, const char* prefix,
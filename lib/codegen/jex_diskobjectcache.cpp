@@ -0,0 +1,177 @@
+#include <jex_diskobjectcache.hpp>
+
+#include <jex_errorhandling.hpp>
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+#include <cstring>
+
+namespace jex {
+
+namespace {
+
+constexpr char s_keyPrefix[] = "jexobj-";
+constexpr uint32_t s_formatVersion = 1;
+constexpr char s_cacheableFlag[] = "jex.cacheable";
+
+struct EntryHeader {
+    char d_magic[8];
+    uint32_t d_formatVersion;
+    char d_llvmVersion[20];
+    uint64_t d_objectSize;
+    // xxHash64 of the object.
+    uint64_t d_checksum;
+};
+
+EntryHeader createHeader(llvm::StringRef object) {
+    EntryHeader header{};
+    std::memcpy(header.d_magic, "JEXOBJC", 8);
+    header.d_formatVersion = s_formatVersion;
+    std::strncpy(header.d_llvmVersion, LLVM_VERSION_STRING, sizeof(header.d_llvmVersion) - 1);
+    header.d_objectSize = object.size();
+    header.d_checksum = llvm::xxHash64(object);
+    return header;
+}
+
+} // anonymous namespace
+
+DiskObjectCache::DiskObjectCache(std::string directory, std::string targetTriple, std::string cpu,
+                                 std::string features)
+: d_directory(std::move(directory))
+, d_targetTriple(std::move(targetTriple))
+, d_cpu(std::move(cpu))
+, d_features(std::move(features)) {
+    if (std::error_code err = llvm::sys::fs::create_directories(d_directory)) {
+        throw InternalError("Error creating object cache directory '" + d_directory + "': " + err.message());
+    }
+}
+
+DiskObjectCache::~DiskObjectCache() = default;
+
+std::string DiskObjectCache::computeKey(const llvm::Module& module, OptLevel optLevel, size_t envFingerprint) const {
+    std::string data;
+    llvm::raw_string_ostream stream(data);
+    module.print(stream, nullptr);
+    stream << '\0' << d_targetTriple << '\0' << d_cpu << '\0' << d_features << '\0'
+           << static_cast<int>(optLevel)
+           << '\0' << envFingerprint;
+    return s_keyPrefix + llvm::utohexstr(llvm::xxHash64(stream.str()));
+}
+
+std::string DiskObjectCache::getPath(const std::string& key) const {
+    llvm::SmallString<128> path(d_directory);
+    llvm::sys::path::append(path, key + ".o");
+    return std::string(path.str());
+}
+
+bool DiskObjectCache::prefetch(const llvm::Module& module) {
+    std::unique_ptr<llvm::MemoryBuffer> object = load(module.getModuleIdentifier());
+    if (!object) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_prefetched[&module] = std::move(object);
+    return true;
+}
+
+void DiskObjectCache::markCacheable(llvm::Module& module) {
+    module.addModuleFlag(llvm::Module::Error, s_cacheableFlag, 1);
+}
+
+std::unique_ptr<llvm::MemoryBuffer> DiskObjectCache::load(const std::string& key) {
+    std::string path = getPath(key);
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> file = llvm::MemoryBuffer::getFile(path);
+    if (!file) {
+        return nullptr;
+    }
+    llvm::StringRef content = (*file)->getBuffer();
+    EntryHeader header;
+    bool valid = content.size() >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, content.data(), sizeof(header));
+        llvm::StringRef object = content.drop_front(sizeof(header));
+        EntryHeader expected = createHeader(object);
+        valid = std::memcmp(&header, &expected, sizeof(header)) == 0;
+    }
+    if (!valid) {
+        // Outdated or corrupted entry, it gets replaced by the next compilation.
+        ++d_invalidCount;
+        llvm::sys::fs::remove(path);
+        return nullptr;
+    }
+    return llvm::MemoryBuffer::getMemBufferCopy(content.drop_front(sizeof(header)), key);
+}
+
+void DiskObjectCache::notifyObjectCompiled(const llvm::Module* module, llvm::MemoryBufferRef obj) {
+    const std::string& key = module->getModuleIdentifier();
+    if (!llvm::StringRef(key).startswith(s_keyPrefix)) {
+        return; // Module without cache key.
+    }
+    if (module->getModuleFlag(s_cacheableFlag) == nullptr) {
+        return; // Not optimized, the object doesn't match the key.
+    }
+    std::string path = getPath(key);
+    // Write to a temporary file first, so that concurrent readers never see partial entries.
+    int fd = 0;
+    llvm::SmallString<128> tmpPath;
+    if (llvm::sys::fs::createUniqueFile(path + "-%%%%%%.tmp", fd, tmpPath)) {
+        return; // Caching is best-effort.
+    }
+    {
+        llvm::raw_fd_ostream out(fd, /*shouldClose*/true);
+        EntryHeader header = createHeader(obj.getBuffer());
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out << obj.getBuffer();
+        out.close();
+        if (out.has_error()) {
+            out.clear_error();
+            llvm::sys::fs::remove(tmpPath);
+            return;
+        }
+    }
+    if (llvm::sys::fs::rename(tmpPath, path)) {
+        llvm::sys::fs::remove(tmpPath);
+        return;
+    }
+    ++d_storeCount;
+}
+
+std::unique_ptr<llvm::MemoryBuffer> DiskObjectCache::takeObject(const llvm::Module& module) {
+    // Only prefetched objects are used. Reading the entry again could find it replaced or removed
+    // in the meantime, while the module already skipped its optimization.
+    std::lock_guard<std::mutex> lock(d_mutex);
+    auto iter = d_prefetched.find(&module);
+    if (iter == d_prefetched.end()) {
+        return nullptr;
+    }
+    std::unique_ptr<llvm::MemoryBuffer> object = std::move(iter->second);
+    d_prefetched.erase(iter);
+    if (object->getBufferIdentifier() != module.getModuleIdentifier()) {
+        return nullptr; // Left over from a module previously at the same address.
+    }
+    ++d_hitCount;
+    return object;
+}
+
+void DiskObjectCache::discard(const llvm::Module& module) {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_prefetched.erase(&module);
+}
+
+size_t DiskObjectCache::getPrefetchedCount() {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_prefetched.size();
+}
+
+std::unique_ptr<llvm::MemoryBuffer> DiskObjectCache::getObject(const llvm::Module* /*module*/) {
+    return nullptr;
+}
+
+} // namespace jex
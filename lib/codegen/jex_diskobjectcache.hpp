@@ -0,0 +1,90 @@
+#pragma once
+
+#include <jex_base.hpp>
+#include <jex_compileoptions.hpp>
+
+#include "llvm/ExecutionEngine/ObjectCache.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace jex {
+
+/**
+ * Persistent cache of compiled object files.
+ * Entries are keyed by a hash of the unoptimized module, the optimization level, the target and
+ * the environment. The key is stored as the module identifier, so that the JIT's compile layer
+ * can store the object of a module under it. Objects found by prefetch() are taken by the
+ * backend and added to the JIT instead of the module.
+ * Every entry carries a header with the cache format and LLVM version and a checksum of the
+ * object. Entries not matching it are removed and treated as missing.
+ * Only objects of modules marked by markCacheable() are stored, so that a module compiled without
+ * its optimizations never ends up under the key of the optimized one.
+ */
+class DiskObjectCache : public llvm::ObjectCache, NoCopy {
+    std::string d_directory;
+    std::string d_targetTriple;
+    std::string d_cpu;
+    std::string d_features;
+    std::atomic<size_t> d_hitCount{0};
+    std::atomic<size_t> d_storeCount{0};
+    std::atomic<size_t> d_invalidCount{0};
+    // Objects loaded by prefetch() until they are taken or discarded.
+    std::mutex d_mutex;
+    std::unordered_map<const llvm::Module*, std::unique_ptr<llvm::MemoryBuffer>> d_prefetched;
+
+public:
+    DiskObjectCache(std::string directory, std::string targetTriple, std::string cpu,
+                    std::string features = "");
+    ~DiskObjectCache() override;
+
+    /**
+     * Returns the cache key for the given unoptimized module.
+     */
+    std::string computeKey(const llvm::Module& module, OptLevel optLevel, size_t envFingerprint) const;
+
+    /**
+     * Loads the entry for the module's key and keeps it for getObject(). Returns true if a valid
+     * entry exists, i.e. the module doesn't need to be optimized and compiled.
+     */
+    bool prefetch(const llvm::Module& module);
+    /**
+     * Returns the object prefetched for the module and forgets it, so that the object can be
+     * added to the JIT instead of the module. Returns null if there is none.
+     */
+    std::unique_ptr<llvm::MemoryBuffer> takeObject(const llvm::Module& module);
+    // Forgets the object prefetched for the module, e.g. if it isn't handed to the JIT.
+    void discard(const llvm::Module& module);
+    // Allows storing the object of the module, i.e. it went through the optimization pipeline.
+    static void markCacheable(llvm::Module& module);
+
+    void notifyObjectCompiled(const llvm::Module* module, llvm::MemoryBufferRef obj) override;
+    // Prefetched objects are taken by the backend, so the compile layer never gets one.
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* module) override;
+
+    const std::string& getDirectory() const {
+        return d_directory;
+    }
+
+    size_t getHitCount() const {
+        return d_hitCount;
+    }
+    size_t getStoreCount() const {
+        return d_storeCount;
+    }
+    size_t getInvalidCount() const {
+        return d_invalidCount;
+    }
+    // Returns the number of prefetched objects neither taken nor discarded yet.
+    size_t getPrefetchedCount();
+
+    std::string getPath(const std::string& key) const;
+
+private:
+    std::unique_ptr<llvm::MemoryBuffer> load(const std::string& key);
+};
+
+} // namespace jex
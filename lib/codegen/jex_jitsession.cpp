@@ -0,0 +1,262 @@
+#include <jex_jitsession.hpp>
+
+#include <jex_codegen.hpp>
+#include <jex_diskobjectcache.hpp>
+#include <jex_fctinfo.hpp>
+#include <jex_llvmerror.hpp>
+#include <jex_targetmachine.hpp>
+
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LazyReexports.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include <atomic>
+#include <cassert>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace jex {
+
+struct LibMemory {
+    std::atomic<size_t> d_codeBytes{0};
+    std::atomic<size_t> d_dataBytes{0};
+};
+
+namespace {
+
+/**
+ * Memory manager counting the section bytes allocated for one object file.
+ * Once the object is loaded, the counts are attributed to the program library it belongs to and
+ * removed from it again when the object gets freed (on JITDylib::clear()).
+ */
+class AccountingMemoryManager : public llvm::SectionMemoryManager {
+    size_t d_codeBytes = 0;
+    size_t d_dataBytes = 0;
+    std::shared_ptr<LibMemory> d_libMemory;
+
+public:
+    ~AccountingMemoryManager() override {
+        if (d_libMemory) {
+            d_libMemory->d_codeBytes -= d_codeBytes;
+            d_libMemory->d_dataBytes -= d_dataBytes;
+        }
+    }
+
+    uint8_t* allocateCodeSection(uintptr_t size, unsigned alignment, unsigned sectionID,
+                                 llvm::StringRef sectionName) override {
+        d_codeBytes += size;
+        return SectionMemoryManager::allocateCodeSection(size, alignment, sectionID, sectionName);
+    }
+
+    uint8_t* allocateDataSection(uintptr_t size, unsigned alignment, unsigned sectionID,
+                                 llvm::StringRef sectionName, bool isReadOnly) override {
+        d_dataBytes += size;
+        return SectionMemoryManager::allocateDataSection(size, alignment, sectionID, sectionName,
+                                                         isReadOnly);
+    }
+
+    void attach(std::shared_ptr<LibMemory> libMemory) {
+        assert(!d_libMemory);
+        d_libMemory = std::move(libMemory);
+        d_libMemory->d_codeBytes += d_codeBytes;
+        d_libMemory->d_dataBytes += d_dataBytes;
+    }
+};
+
+// The memory manager of the object currently being loaded on this thread. RuntimeDyld allocates
+// all sections and notifies about the loaded object synchronously on the same thread.
+thread_local AccountingMemoryManager* t_loadingMemMgr = nullptr;
+
+// Called by a lazy stub if its function couldn't be compiled. There is no way to report an error
+// back to the caller of a JIT compiled function.
+void lazyCompileFailed() {
+    llvm::report_fatal_error("jex: lazy compilation of a function failed");
+}
+
+} // anonymous namespace
+
+JitSession::JitSession(const CompileOptions& options) {
+    d_targetMachineBuilder = std::make_unique<llvm::orc::JITTargetMachineBuilder>(
+        getTargetMachineBuilder(options.d_cpu));
+    llvm::orc::JITTargetMachineBuilder targetMachineBuilder = *d_targetMachineBuilder;
+    llvm::orc::LLJITBuilder builder;
+    if (!options.d_objectCacheDir.empty()) {
+        d_objectCache = std::make_unique<DiskObjectCache>(options.d_objectCacheDir,
+            targetMachineBuilder.getTargetTriple().str(), targetMachineBuilder.getCPU(),
+            targetMachineBuilder.getFeatures().getString());
+    }
+    // Programs get materialized on the threads looking them up. The default compiler shares one
+    // target machine for all compilations which isn't thread-safe, so create one per compilation.
+    builder.setCompileFunctionCreator([cache = d_objectCache.get()](llvm::orc::JITTargetMachineBuilder jtmb)
+            -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+        return std::make_unique<llvm::orc::ConcurrentIRCompiler>(std::move(jtmb), cache);
+    });
+    d_jit = checked(builder
+        .setJITTargetMachineBuilder(std::move(targetMachineBuilder))
+        .setObjectLinkingLayerCreator([this](llvm::orc::ExecutionSession& es, const llvm::Triple&)
+                -> llvm::Expected<std::unique_ptr<llvm::orc::ObjectLayer>> {
+            auto layer = std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(es, [] {
+                auto memMgr = std::make_unique<AccountingMemoryManager>();
+                t_loadingMemMgr = memMgr.get();
+                return memMgr;
+            });
+            layer->setNotifyLoaded([this](llvm::orc::MaterializationResponsibility& r,
+                                          const llvm::object::ObjectFile&,
+                                          const llvm::RuntimeDyld::LoadedObjectInfo&) {
+                std::shared_ptr<LibMemory> libMemory;
+                {
+                    std::lock_guard<std::mutex> lock(d_mutex);
+                    auto iter = d_libMemory.find(&r.getTargetJITDylib());
+                    if (iter != d_libMemory.end()) {
+                        libMemory = iter->second;
+                    }
+                }
+                if (libMemory && t_loadingMemMgr) {
+                    t_loadingMemMgr->attach(std::move(libMemory));
+                }
+                t_loadingMemMgr = nullptr;
+            });
+            return std::move(layer);
+        })
+        .create(), "Error creating LLJITBuilder: ");
+    // Lazy modules get optimized per function when they are materialized.
+    d_jit->getIRTransformLayer().setTransform([this](llvm::orc::ThreadSafeModule tsm,
+                                                     llvm::orc::MaterializationResponsibility&) {
+        tsm.withModuleDo([this](llvm::Module& module) {
+            if (std::optional<OptLevel> optLevel = CodeGen::getLazyOptLevel(module)) {
+                std::unique_ptr<llvm::TargetMachine> targetMachine = createTargetMachine();
+                CodeGen::optimizeModule(module, *optLevel, targetMachine.get());
+            }
+        });
+        return llvm::Expected<llvm::orc::ThreadSafeModule>(std::move(tsm));
+    });
+    const llvm::Triple& triple = d_jit->getTargetTriple();
+    d_lazyCallThroughMgr = checked(llvm::orc::createLocalLazyCallThroughManager(triple,
+        d_jit->getExecutionSession(), llvm::pointerToJITTargetAddress(&lazyCompileFailed)),
+        "Error creating lazy call-through manager: ");
+    d_stubsMgrBuilder = llvm::orc::createLocalIndirectStubsManagerBuilder(triple);
+    d_fctLib = &checked(d_jit->createJITDylib("__fcts"), "Error creating function library: ");
+    // The optimizer may lower memory intrinsics (e.g. zero-initializing a large context) into
+    // library calls, so these have to be resolvable from the process.
+    llvm::orc::SymbolStringPtr memcpyName = d_jit->mangleAndIntern("memcpy");
+    llvm::orc::SymbolStringPtr memmoveName = d_jit->mangleAndIntern("memmove");
+    llvm::orc::SymbolStringPtr memsetName = d_jit->mangleAndIntern("memset");
+    d_fctLib->addGenerator(checked(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+        d_jit->getDataLayout().getGlobalPrefix(),
+        [=](const llvm::orc::SymbolStringPtr& name) {
+            return name == memcpyName || name == memmoveName || name == memsetName;
+        }), "Error creating process symbol generator: "));
+}
+
+JitSession::~JitSession() = default;
+
+std::shared_ptr<JitSession> JitSession::getDefault(const CompileOptions& options) {
+    static std::mutex mutex;
+    static std::map<std::pair<std::string, std::string>, std::shared_ptr<JitSession>> sessions;
+    std::lock_guard<std::mutex> lock(mutex);
+    const std::string& cpu = options.d_cpu.empty() ? "host" : options.d_cpu;
+    std::shared_ptr<JitSession>& session = sessions[{options.d_objectCacheDir, cpu}];
+    if (!session) {
+        session = std::make_shared<JitSession>(options);
+    }
+    return session;
+}
+
+std::unique_ptr<llvm::TargetMachine> JitSession::createTargetMachine() const {
+    // JITTargetMachineBuilder::createTargetMachine() isn't const, so build from a copy.
+    llvm::orc::JITTargetMachineBuilder builder = *d_targetMachineBuilder;
+    return checked(builder.createTargetMachine(), "Error creating target machine: ");
+}
+
+std::unique_ptr<llvm::orc::IndirectStubsManager> JitSession::createStubsManager() const {
+    return d_stubsMgrBuilder();
+}
+
+llvm::orc::JITDylib& JitSession::createProgramLib() {
+    llvm::orc::JITDylib* lib = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        if (!d_freeLibs.empty()) {
+            lib = d_freeLibs.back();
+            d_freeLibs.pop_back();
+        } else {
+            lib = &checked(d_jit->createJITDylib("__program" + std::to_string(d_libCount++)),
+                           "Error creating program library: ");
+            d_libMemory.emplace(lib, std::make_shared<LibMemory>());
+        }
+    }
+    lib->setLinkOrder({{d_fctLib, llvm::orc::JITDylibLookupFlags::MatchAllSymbols}});
+    return *lib;
+}
+
+void JitSession::releaseProgramLib(llvm::orc::JITDylib& lib) noexcept {
+    // Free all code and symbols of the library. The library object itself can't be removed from
+    // the execution session, so it gets recycled for the next program instead.
+    // This is called from destructors, so errors are reported instead of thrown. A library that
+    // couldn't be cleared may still contain symbols and isn't recycled.
+    if (llvm::Error err = lib.clear()) {
+        llvm::logAllUnhandledErrors(std::move(err), llvm::errs(), "Error releasing program library: ");
+        return;
+    }
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_freeLibs.push_back(&lib);
+}
+
+std::vector<const FctInfo*> JitSession::defineFcts(const std::unordered_set<const FctInfo*>& fcts) {
+    std::vector<const FctInfo*> conflicts;
+    llvm::orc::ExecutionSession& es = d_jit->getExecutionSession();
+    llvm::orc::SymbolMap symbols;
+    // Symbols are only recorded as defined once the library accepted them, otherwise later
+    // compiles would skip symbols that don't exist.
+    std::unordered_map<std::string, void*> added;
+    std::lock_guard<std::mutex> lock(d_mutex);
+    for (const FctInfo* fct : fcts) {
+        auto iter = d_fctSymbols.find(fct->d_mangledName);
+        if (iter == d_fctSymbols.end()) {
+            auto [addedIter, inserted] = added.emplace(fct->d_mangledName, fct->d_fctPtr);
+            if (inserted) {
+                symbols.insert(std::make_pair(es.intern(fct->d_mangledName), llvm::JITEvaluatedSymbol::fromPointer(fct->d_fctPtr)));
+                continue;
+            }
+            iter = addedIter;
+        }
+        if (iter->second != fct->d_fctPtr) {
+            conflicts.push_back(fct);
+        }
+    }
+    if (!symbols.empty()) {
+        checked(d_fctLib->define(llvm::orc::absoluteSymbols(std::move(symbols))), "Error adding fct symbols: ");
+        d_fctSymbols.merge(added);
+    }
+    return conflicts;
+}
+
+LibMemory& JitSession::getLibMemory(const llvm::orc::JITDylib& lib) {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    auto iter = d_libMemory.find(&lib);
+    if (iter == d_libMemory.end()) {
+        throw InternalError("Unknown program library " + lib.getName());
+    }
+    return *iter->second;
+}
+
+size_t JitSession::getCodeBytes(const llvm::orc::JITDylib& lib) {
+    return getLibMemory(lib).d_codeBytes;
+}
+
+size_t JitSession::getDataBytes(const llvm::orc::JITDylib& lib) {
+    return getLibMemory(lib).d_dataBytes;
+}
+
+} // namespace jex
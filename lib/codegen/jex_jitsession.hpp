@@ -0,0 +1,127 @@
+#pragma once
+
+#include <jex_base.hpp>
+#include <jex_compileoptions.hpp>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace llvm {
+    class TargetMachine;
+}
+
+namespace llvm::orc {
+    class IndirectStubsManager;
+    class JITDylib;
+    class JITTargetMachineBuilder;
+    class LazyCallThroughManager;
+    class LLJIT;
+}
+
+namespace jex {
+
+class DiskObjectCache;
+class FctInfo;
+struct LibMemory;
+
+/**
+ * Long-lived JIT engine shared by many compilations.
+ * Setting up an LLJIT (execution session, target machine, ...) is expensive, so a session is
+ * created once and every compiled program only gets its own JITDylib inside of it.
+ * Registered functions are defined once in a shared JITDylib which all program libraries link
+ * against.
+ * All member functions are thread-safe.
+ */
+class JitSession : NoCopy {
+    std::unique_ptr<llvm::orc::JITTargetMachineBuilder> d_targetMachineBuilder;
+    // Declared before the JIT, as the JIT's compile layer uses it.
+    std::unique_ptr<DiskObjectCache> d_objectCache;
+    std::unique_ptr<llvm::orc::LLJIT> d_jit;
+    // Trampolines compiling lazy functions on their first call.
+    std::unique_ptr<llvm::orc::LazyCallThroughManager> d_lazyCallThroughMgr;
+    std::function<std::unique_ptr<llvm::orc::IndirectStubsManager>()> d_stubsMgrBuilder;
+    llvm::orc::JITDylib* d_fctLib;
+    std::mutex d_mutex;
+    // Symbols defined in d_fctLib with their addresses.
+    std::unordered_map<std::string, void*> d_fctSymbols;
+    // Cleared program libraries which can be reused.
+    std::vector<llvm::orc::JITDylib*> d_freeLibs;
+    size_t d_libCount = 0;
+    // Memory allocated for the code of each program library.
+    std::unordered_map<const llvm::orc::JITDylib*, std::shared_ptr<LibMemory>> d_libMemory;
+
+public:
+    /**
+     * Creates a session for the JIT related settings of the given options (the object cache
+     * directory and the CPU).
+     */
+    JitSession(const CompileOptions& options = {});
+    ~JitSession();
+
+    /**
+     * Returns the process-wide session used by default for the given options.
+     */
+    static std::shared_ptr<JitSession> getDefault(const CompileOptions& options = {});
+
+    llvm::orc::LLJIT& jit() {
+        return *d_jit;
+    }
+
+    /**
+     * Returns the persistent object cache or null if caching is disabled.
+     */
+    DiskObjectCache* getObjectCache() {
+        return d_objectCache.get();
+    }
+
+    /**
+     * Creates a target machine matching the one the session compiles with. Optimizing with it
+     * lets the passes know the target's vector width and costs.
+     */
+    std::unique_ptr<llvm::TargetMachine> createTargetMachine() const;
+
+    /**
+     * Infrastructure for lazily compiled programs: Their functions are reexported through stubs
+     * which compile the implementation on the first call. A program's stubs manager has to
+     * outlive its library's symbols.
+     * Modules created by CodeGen in lazy mode get optimized by the session when they are
+     * materialized.
+     */
+    llvm::orc::LazyCallThroughManager& getLazyCallThroughManager() {
+        return *d_lazyCallThroughMgr;
+    }
+    std::unique_ptr<llvm::orc::IndirectStubsManager> createStubsManager() const;
+
+    /**
+     * Returns an empty JITDylib for a program linking against the shared function library.
+     * The library has to be returned via releaseProgramLib() once the program is not used any more.
+     */
+    llvm::orc::JITDylib& createProgramLib();
+    // Doesn't throw, errors clearing the library are reported on stderr.
+    void releaseProgramLib(llvm::orc::JITDylib& lib) noexcept;
+
+    /**
+     * Defines the given functions in the shared function library.
+     * Functions whose name is already defined with a different address (e.g. by another
+     * environment) can't be shared and are returned. They have to be defined in the program
+     * library instead.
+     */
+    std::vector<const FctInfo*> defineFcts(const std::unordered_set<const FctInfo*>& fcts);
+
+    /**
+     * Returns the number of bytes currently allocated for code and data sections of the given
+     * program library. Code is only accounted once it got materialized.
+     */
+    size_t getCodeBytes(const llvm::orc::JITDylib& lib);
+    size_t getDataBytes(const llvm::orc::JITDylib& lib);
+
+private:
+    LibMemory& getLibMemory(const llvm::orc::JITDylib& lib);
+};
+
+} // namespace jex
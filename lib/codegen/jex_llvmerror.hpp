@@ -0,0 +1,36 @@
+#pragma once
+
+#include <jex_errorhandling.hpp>
+
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+
+namespace jex {
+
+[[noreturn]] inline void throwLlvmError(llvm::Error err, const char* errPrefix) {
+    std::string errMsg;
+    llvm::raw_string_ostream errStr(errMsg);
+    llvm::logAllUnhandledErrors(std::move(err), errStr, errPrefix);
+    throw InternalError(errMsg);
+}
+
+/**
+ * Converts an llvm::Error into an InternalError exception.
+ */
+inline void checked(llvm::Error err, const char* errPrefix) {
+    if (err) {
+        throwLlvmError(std::move(err), errPrefix);
+    }
+}
+
+template <typename T>
+T checked(llvm::Expected<T> expectedObj, const char* errPrefix) {
+    if (!expectedObj) {
+        throwLlvmError(expectedObj.takeError(), errPrefix);
+    }
+    return std::forward<T>(*expectedObj);
+}
+
+} // namespace jex
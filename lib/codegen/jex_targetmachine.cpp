@@ -0,0 +1,47 @@
+#include <jex_targetmachine.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_llvmerror.hpp>
+
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Target/TargetMachine.h"
+
+namespace jex {
+
+llvm::orc::JITTargetMachineBuilder getTargetMachineBuilder(const std::string& cpu) {
+    Backend::initialize();
+    if (cpu.empty() || cpu == "host") {
+        return checked(llvm::orc::JITTargetMachineBuilder::detectHost(), "Error detecting host: ");
+    }
+    llvm::Triple triple(llvm::sys::getProcessTriple());
+    std::string err;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple.str(), err);
+    if (target == nullptr) {
+        throw InternalError("Error looking up target: " + err);
+    }
+    // LLVM only warns about unknown CPUs and falls back to a generic one, which would silently
+    // defeat the purpose of selecting a CPU.
+    std::unique_ptr<llvm::MCSubtargetInfo> subtargetInfo(
+        target->createMCSubtargetInfo(triple.str(), "", ""));
+    if (!subtargetInfo->isCPUStringValid(cpu)) {
+        throw InternalError("Unknown CPU '" + cpu + "' for target " + triple.str());
+    }
+    llvm::orc::JITTargetMachineBuilder builder(std::move(triple));
+    builder.setCPU(cpu);
+    return builder;
+}
+
+std::unique_ptr<llvm::TargetMachine> createTargetMachine(const std::string& cpu,
+                                                         bool positionIndependent) {
+    llvm::orc::JITTargetMachineBuilder builder = getTargetMachineBuilder(cpu);
+    if (positionIndependent) {
+        builder.setRelocationModel(llvm::Reloc::PIC_);
+    }
+    return checked(builder.createTargetMachine(), "Error creating target machine: ");
+}
+
+} // namespace jex
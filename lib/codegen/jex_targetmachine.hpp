@@ -0,0 +1,31 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+namespace llvm {
+    class TargetMachine;
+}
+
+namespace llvm::orc {
+    class JITTargetMachineBuilder;
+}
+
+namespace jex {
+
+/**
+ * Returns the target machine builder for the given CPU (see CompileOptions::d_cpu):
+ * For "host" or an empty name the host CPU with all its detected features is used, otherwise the
+ * named CPU with its default feature set on the host's target triple.
+ * Throws an InternalError for CPU names unknown to the target.
+ */
+llvm::orc::JITTargetMachineBuilder getTargetMachineBuilder(const std::string& cpu);
+
+/**
+ * Creates a target machine for the given CPU. Objects compiled ahead of time have to be position
+ * independent to be linked into a shared library.
+ */
+std::unique_ptr<llvm::TargetMachine> createTargetMachine(const std::string& cpu,
+                                                         bool positionIndependent = false);
+
+} // namespace jex
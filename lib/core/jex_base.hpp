@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
 #include <type_traits>
 
 namespace jex {
@@ -39,4 +40,11 @@ inline TargetT cast_ensured(SourceT* ptr) {
     return static_cast<TargetT>(ptr);
 }
 
+/**
+ * Combines a hash value into the given seed.
+ */
+inline size_t hashCombine(size_t seed, size_t value) {
+    return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
 } // namespace jex
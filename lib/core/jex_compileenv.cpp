@@ -1,6 +1,7 @@
 #include <jex_compileenv.hpp>
 
 #include <jex_ast.hpp>
+#include <jex_compilereport.hpp>
 #include <jex_constantstore.hpp>
 #include <jex_environment.hpp>
 #include <jex_errorhandling.hpp>
@@ -16,6 +17,7 @@ CompileEnv::CompileEnv(const Environment& env, bool useIntrinsics)
 : d_fileName("test") // TODO: Provide real file name
 , d_useIntrinsics(useIntrinsics)
 , d_messages(std::make_unique<std::set<MsgInfo>>())
+, d_environment(env)
 , d_typeSystem(env.types())
 , d_fctLibrary(env.fctLib())
 , d_symbolTable(std::make_unique<SymbolTable>(*this))
@@ -54,4 +56,12 @@ std::unique_ptr<ConstantStore> CompileEnv::releaseConstants() {
     return std::move(d_constants);
 }
 
+void CompileEnv::enableReport() {
+    d_report = std::make_unique<CompileReport>();
+}
+
+std::unique_ptr<CompileReport> CompileEnv::releaseReport() {
+    return std::move(d_report);
+}
+
 } // namespace jex
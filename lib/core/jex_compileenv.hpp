@@ -1,8 +1,10 @@
 #pragma once
 
 #include <jex_base.hpp>
+#include <jex_contextlayout.hpp>
 
 #include <cassert>
+#include <cstddef>
 #include <deque>
 #include <memory>
 #include <unordered_set>
@@ -21,6 +23,7 @@ class FctLibrary;
 class Environment;
 class FctInfo;
 class ConstantStore;
+struct CompileReport;
 
 /**
  * Stores and provides access to any object needed during compilation.
@@ -34,15 +37,23 @@ class CompileEnv : NoCopy {
     bool d_hasErrors = false;
     std::deque<std::unique_ptr<IAstNode>> d_nodes;
     AstRoot* d_root = nullptr;
+    const Environment& d_environment;
     const TypeSystem& d_typeSystem;
     const FctLibrary& d_fctLibrary;
     std::unique_ptr<SymbolTable> d_symbolTable;
     std::deque<std::string> d_stringLiterals;
     std::unordered_set<const FctInfo*> d_usedFcts;
     std::unique_ptr<ConstantStore> d_constants;
+    // Only set if a compile report is collected.
+    std::unique_ptr<CompileReport> d_report;
 
     // Size of the runtime context.
     std::optional<size_t> d_contextSize;
+    size_t d_contextAlignment = alignof(std::max_align_t);
+    // The var and expr slots of the runtime context.
+    std::vector<ContextSlotDesc> d_contextSlots;
+    // The vars in declaration order with their offsets in the input record of __set_all.
+    std::vector<ContextSlotDesc> d_inputRecord;
 public:
     CompileEnv(const Environment& env, bool useIntrinsics = true);
     ~CompileEnv();
@@ -67,6 +78,10 @@ public:
         return d_useIntrinsics;
     }
 
+    const Environment& environment() const {
+        return d_environment;
+    }
+
     const std::set<MsgInfo>& messages() const {
         return *d_messages;
     }
@@ -77,6 +92,11 @@ public:
         return d_hasErrors;
     }
 
+    // Returns the number of AST nodes created so far.
+    size_t nodeCount() const {
+        return d_nodes.size();
+    }
+
     void setRoot(AstRoot* root) {
         d_root = root;
     }
@@ -97,6 +117,30 @@ public:
         return d_contextSize.value();
     }
 
+    void setContextAlignment(size_t alignment) {
+        d_contextAlignment = alignment;
+    }
+
+    size_t getContextAlignment() const {
+        return d_contextAlignment;
+    }
+
+    void setContextSlots(std::vector<ContextSlotDesc> slots) {
+        d_contextSlots = std::move(slots);
+    }
+
+    const std::vector<ContextSlotDesc>& getContextSlots() const {
+        return d_contextSlots;
+    }
+
+    void setInputRecord(std::vector<ContextSlotDesc> record) {
+        d_inputRecord = std::move(record);
+    }
+
+    const std::vector<ContextSlotDesc>& getInputRecord() const {
+        return d_inputRecord;
+    }
+
     const TypeSystem& typeSystem() const {
         return d_typeSystem;
     }
@@ -120,6 +164,16 @@ public:
     }
 
     std::unique_ptr<ConstantStore> releaseConstants();
+
+    /**
+     * Starts collecting a compile report. The report is null if it isn't enabled, so that the
+     * phases can pass it to a CompilePhase unconditionally.
+     */
+    void enableReport();
+    CompileReport* report() {
+        return d_report.get();
+    }
+    std::unique_ptr<CompileReport> releaseReport();
 };
 
 } // namespace jex
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace jex {
+
+enum class OptLevel {
+    O0 = 0, O1, O2, O3
+};
+
+/**
+ * Options controlling the layout of the runtime context, see ContextLayout.
+ */
+struct ContextLayoutOptions {
+    // Group value vars and exprs in front of complex ones.
+    bool d_splitHotCold = false;
+    // If not 0, pad the context size to a multiple of the cache line size and start the cold
+    // slots on a new cache line. Has to be a power of two.
+    size_t d_cacheLineSize = 0;
+    // Profiled number of accesses per var and expr name. Only used with d_splitHotCold; names
+    // without accesses are placed behind all others.
+    std::unordered_map<std::string, uint64_t> d_accessCounts;
+};
+
+/**
+ * Options controlling the compilation of a program.
+ */
+struct CompileOptions {
+    OptLevel d_optLevel = OptLevel::O2;
+    bool d_useIntrinsics = true;
+    bool d_enableConstantFolding = true;
+    // Directory of the persistent object cache. Caching is disabled if empty.
+    std::string d_objectCacheDir;
+    // CPU to generate code for: "host" for the host CPU and all its features or a CPU name known to
+    // LLVM (e.g. "x86-64-v3", "skylake") for reproducible code. If empty, JIT compilation targets
+    // the host and ahead-of-time compilation a generic CPU.
+    std::string d_cpu;
+    // Compile each expression on its first evaluation instead of compiling the whole program
+    // upfront. Only applies to JIT compilation; the object cache isn't used for lazy programs.
+    bool d_lazy = false;
+    // Generate a batch variant `void name.batch(Rctx** rctxs, int64_t count, T** results)` for
+    // each expr, evaluating it for many contexts in one call. results may be null. The rctxs and
+    // results arrays must not overlap, so one buffer can't be reused for both.
+    bool d_batchFcts = false;
+    // Generate a kernel `void __eval_columns(void** columns, int64_t count)` evaluating all exprs
+    // for count rows. columns holds one array per var and expr in declaration order; the exprs'
+    // arrays receive the results. Only supported for programs using value types only.
+    bool d_columnar = false;
+    // Generate `void __eval_all(Rctx*)` evaluating every expr once, each after the exprs it
+    // references.
+    bool d_evalAll = false;
+    // Generate `void __eval_outputs(Rctx*)` evaluating the given exprs and the exprs they depend
+    // on, each once and in dependency order.
+    std::vector<std::string> d_evalOutputs;
+    // Track in the context which exprs depend on vars set since their last evaluation and generate
+    // `void __eval_dirty(Rctx*)` re-evaluating only those exprs in dependency order. Exprs not
+    // depending on any var are evaluated by the first call only.
+    bool d_incremental = false;
+    // Compute calls of pure functions occurring in several exprs only once in __eval_all and
+    // __eval_outputs, keeping their results in hidden context slots.
+    bool d_shareSubexprs = false;
+    // Generate `void __reset_rctx(Rctx*)` bringing a context back into its initial state, so that
+    // it can be reused instead of destructing it and creating a new one (see ContextPool).
+    bool d_resetFct = false;
+    // Generate `void __set_all(Rctx*, const void* input)` setting all vars from an input record
+    // holding them in declaration order like a C struct (see CompileResult::getInputRecord()) and
+    // `void __set_all_ptrs(Rctx*, void* const* values)` setting them from a pointer per var.
+    bool d_setAll = false;
+    // Give each complex temporary produced by a function with an assign variant a scratch slot in
+    // the context which is constructed by __init_rctx and reused by every evaluation, so that e.g.
+    // string functions reuse the capacity of their previous result instead of allocating.
+    bool d_scratchSlots = false;
+    // Write the complex result of an expr's outermost call into the expr's context slot directly,
+    // instead of copying it from a temporary which is destructed afterwards.
+    bool d_inPlaceResults = false;
+    ContextLayoutOptions d_layout;
+    // Collect a CompileReport with the time spent and the heap growth per compile phase.
+    bool d_collectReport = false;
+};
+
+} // namespace jex
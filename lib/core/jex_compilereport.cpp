@@ -0,0 +1,98 @@
+#include <jex_compilereport.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <ostream>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace jex {
+
+// Returns the number of bytes currently allocated on the heap of the process, if the C library
+// can report it.
+static std::optional<size_t> getHeapBytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+#else
+    return std::nullopt;
+#endif
+}
+
+static void printKiB(std::ostream& str, const std::optional<int64_t>& bytes) {
+    if (bytes) {
+        str << std::setw(20) << *bytes / 1024.0;
+    } else {
+        str << std::setw(20) << "n/a";
+    }
+}
+
+const CompileReport::Phase* CompileReport::getPhase(const std::string& name) const {
+    for (const Phase& phase : d_phases) {
+        if (phase.d_name == name) {
+            return &phase;
+        }
+    }
+    return nullptr;
+}
+
+double CompileReport::totalSec() const {
+    double total = 0;
+    for (const Phase& phase : d_phases) {
+        total += phase.d_wallSec;
+    }
+    return total;
+}
+
+std::ostream& operator<<(std::ostream& str, const CompileReport& report) {
+    std::ios_base::fmtflags flags = str.flags();
+    str << std::left << std::setw(24) << "Phase" << std::right << std::setw(12) << "Wall (ms)"
+        << std::setw(20) << "Heap growth (KiB)" << '\n';
+    str << std::fixed << std::setprecision(3);
+    std::optional<int64_t> totalHeap = 0;
+    for (const CompileReport::Phase& phase : report.d_phases) {
+        str << std::left << std::setw(24) << phase.d_name << std::right
+            << std::setw(12) << phase.d_wallSec * 1e3;
+        printKiB(str, phase.d_heapGrowth);
+        str << '\n';
+        if (totalHeap && phase.d_heapGrowth) {
+            *totalHeap += *phase.d_heapGrowth;
+        } else {
+            totalHeap.reset();
+        }
+    }
+    str << std::left << std::setw(24) << "Total" << std::right
+        << std::setw(12) << report.totalSec() * 1e3;
+    printKiB(str, totalHeap);
+    str << '\n';
+    str << "AST nodes: " << report.d_astNodeCount << '\n';
+    str << "IR instructions: " << report.d_irInstructionsBefore << " before optimization, "
+        << report.d_irInstructionsAfter << " after optimization\n";
+    str << "Code size: " << report.d_codeBytes << " bytes\n";
+    str.flags(flags);
+    return str;
+}
+
+CompilePhase::CompilePhase(CompileReport* report, const char* name)
+: d_report(report)
+, d_name(name) {
+    if (d_report != nullptr) {
+        d_heapStart = getHeapBytes();
+        d_start = std::chrono::steady_clock::now();
+    }
+}
+
+CompilePhase::~CompilePhase() {
+    if (d_report != nullptr) {
+        std::chrono::duration<double> wall = std::chrono::steady_clock::now() - d_start;
+        std::optional<int64_t> heapGrowth;
+        if (std::optional<size_t> heapEnd = getHeapBytes(); heapEnd && d_heapStart) {
+            heapGrowth = static_cast<int64_t>(*heapEnd) - static_cast<int64_t>(*d_heapStart);
+        }
+        d_report->d_phases.push_back(CompileReport::Phase{d_name, wall.count(), heapGrowth});
+    }
+}
+
+} // namespace jex
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <jex_base.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace jex {
+
+/**
+ * Time spent and heap growth in each phase of a compilation together with size metrics of the
+ * intermediate artifacts. Only collected if requested via CompileOptions::d_collectReport.
+ */
+struct CompileReport {
+    struct Phase {
+        std::string d_name;
+        double d_wallSec = 0;
+        // Net growth of the process-wide heap during the phase. This isn't the number of bytes
+        // allocated by the phase: memory freed by the phase is subtracted and allocations of
+        // concurrent compilations or other threads are included. Empty if the C library can't
+        // report the heap usage.
+        std::optional<int64_t> d_heapGrowth;
+    };
+
+    std::vector<Phase> d_phases;
+    size_t d_astNodeCount = 0;
+    size_t d_irInstructionsBefore = 0; // Before optimization.
+    size_t d_irInstructionsAfter = 0;
+    // Code bytes materialized during the compilation.
+    size_t d_codeBytes = 0;
+
+    const Phase* getPhase(const std::string& name) const;
+    double totalSec() const;
+};
+
+std::ostream& operator<<(std::ostream& str, const CompileReport& report);
+
+/**
+ * Measures the phase from construction until destruction and appends it to the report.
+ * Does nothing if the report is null.
+ */
+class CompilePhase : NoCopy {
+    CompileReport* d_report;
+    const char* d_name;
+    std::chrono::steady_clock::time_point d_start;
+    std::optional<size_t> d_heapStart;
+
+public:
+    CompilePhase(CompileReport* report, const char* name);
+    ~CompilePhase();
+};
+
+} // namespace jex
@@ -81,6 +81,7 @@ void ConstantFolding::foldFunctionCall(IAstExpression& callExpr, const FctInfo&
         [[maybe_unused]] auto[iterator, inserted] =
             d_constants.emplace(constNode, Constant::allocate(callExpr.d_resultType->size()));
         assert(inserted);
+        iterator->second.getConstant().type = &callExpr.d_resultType.get();
         // Evaluate function.
         std::vector<void*> argPtrs;
         argPtrs.reserve(1 + args.size());
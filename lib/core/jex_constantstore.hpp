@@ -12,6 +12,9 @@ public:
     using Dtor = void(*)(void*);
     std::unique_ptr<uint8_t[]> valuePtr;
     Dtor dtor;
+    size_t size = 0;
+    // Type of the constant; May be null for internal helper constants (e.g. VarArg arrays).
+    const TypeInfo* type = nullptr;
 
     Constant(Constant&&) = default;
     Constant& operator=(Constant&&) = default;
@@ -32,7 +35,7 @@ public:
     }
 
     static Constant allocate(size_t size) {
-        return Constant{std::make_unique<uint8_t[]>(size), nullptr};
+        return Constant{std::make_unique<uint8_t[]>(size), nullptr, size};
     }
 
     template<typename T>
@@ -54,9 +57,10 @@ public:
     ConstantStore() = default;
 
     template <typename T, typename... Args>
-    const T* emplace(std::string name, const FctInfo& dtor, Args&&... args) {
+    const T* emplace(std::string name, TypeInfoId type, const FctInfo& dtor, Args&&... args) {
         auto[iter, inserted] = d_constants.emplace(std::move(name), Constant::allocate(sizeof(T)));
         assert(inserted && "constant name must be unique");
+        iter->second.type = &type.get();
         T* ptr = reinterpret_cast<T*>(iter->second.valuePtr.get());
         new (ptr) T(std::forward<Args>(args)...);
         // Set destructor after the element has been constructed to prevent calling the
@@ -80,6 +84,18 @@ public:
     const Constant& constantByName(const std::string& name) {
         return d_constants.at(name);
     }
+
+    /**
+     * Returns the number of bytes allocated for all constants. Memory owned by complex constants
+     * (e.g. the heap buffer of a long string) is not included.
+     */
+    size_t getByteSize() const {
+        size_t bytes = 0;
+        for (const auto& [name, constant] : d_constants) {
+            bytes += constant.size;
+        }
+        return bytes;
+    }
 };
 
 } // namesapce jex
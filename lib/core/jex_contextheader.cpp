@@ -0,0 +1,111 @@
+#include <jex_contextheader.hpp>
+
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+namespace jex {
+
+// Returns the C++ type of a built-in type or null for other types.
+static const char* getCppType(std::string_view typeName) {
+    if (typeName == "Integer") {
+        return "std::int64_t";
+    }
+    if (typeName == "Float") {
+        return "double";
+    }
+    if (typeName == "Bool") {
+        return "bool";
+    }
+    if (typeName == "String") {
+        return "std::string";
+    }
+    if (typeName == "StringView") {
+        return "std::string_view";
+    }
+    return nullptr;
+}
+
+// C++ keywords, alternative tokens, macros defined by the included headers and the names the
+// header declares itself.
+static const std::unordered_set<std::string_view> s_reservedNames = {
+    "alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor", "bool", "break",
+    "case", "catch", "char", "char8_t", "char16_t", "char32_t", "class", "compl", "concept",
+    "const", "consteval", "constexpr", "constinit", "const_cast", "continue", "co_await",
+    "co_return", "co_yield", "decltype", "default", "delete", "do", "double", "dynamic_cast",
+    "else", "enum", "explicit", "export", "extern", "false", "float", "for", "friend", "goto",
+    "if", "inline", "int", "long", "mutable", "namespace", "new", "noexcept", "not", "not_eq",
+    "nullptr", "operator", "or", "or_eq", "private", "protected", "public", "register",
+    "reinterpret_cast", "requires", "return", "short", "signed", "sizeof", "static",
+    "static_assert", "static_cast", "struct", "switch", "template", "this", "thread_local",
+    "throw", "true", "try", "typedef", "typeid", "typename", "union", "unsigned", "using",
+    "virtual", "void", "volatile", "wchar_t", "while", "xor", "xor_eq",
+    "NULL", "offsetof",
+    "contextSize", "offsets", "Input", "jex_context", "std", "rctx",
+};
+
+// Returns the name as a valid C++ identifier. Reserved names and, to keep the mapping unique,
+// names ending with an underscore get an underscore appended.
+static std::string escapeName(std::string_view name) {
+    std::string escaped(name);
+    if (s_reservedNames.count(name) != 0 || (!name.empty() && name.back() == '_')) {
+        escaped += '_';
+    }
+    return escaped;
+}
+
+void writeContextHeader(std::ostream& out, const std::vector<ContextSlotDesc>& slots, size_t contextSize,
+                        const std::vector<ContextSlotDesc>& inputRecord) {
+    out << "// Context layout generated by jexc. The layout depends on the program and the compile\n"
+           "// options, regenerate the header whenever one of them changes.\n"
+           "// Writing a var directly doesn't mark dependent exprs as dirty for __eval_dirty.\n"
+           "#pragma once\n"
+           "\n"
+           "#include <cstddef>\n"
+           "#include <cstdint>\n"
+           "#include <string>\n"
+           "#include <string_view>\n"
+           "\n"
+           "namespace jex_context {\n"
+           "\n"
+           "constexpr std::size_t contextSize = " << contextSize << ";\n"
+           "\n"
+           "namespace offsets {\n";
+    for (const ContextSlotDesc& slot : slots) {
+        out << "constexpr std::size_t " << escapeName(slot.d_name) << " = " << slot.d_offset << ";\n";
+    }
+    out << "} // namespace offsets\n";
+    for (const ContextSlotDesc& slot : slots) {
+        const char* kind = slot.d_kind == ContextSlotDesc::Kind::Var ? "var" : "expr";
+        std::string name = escapeName(slot.d_name);
+        out << "\n// " << kind << ' ' << slot.d_name << " : " << slot.d_typeName << '\n';
+        if (const char* cppType = getCppType(slot.d_typeName)) {
+            out << "inline " << cppType << "& " << name << "(char* rctx) {\n"
+                << "    return *reinterpret_cast<" << cppType << "*>(rctx + offsets::" << name << ");\n";
+        } else {
+            out << "inline void* " << name << "(char* rctx) {\n"
+                << "    return rctx + offsets::" << name << ";\n";
+        }
+        out << "}\n";
+    }
+    if (!inputRecord.empty()) {
+        out << "\n// Input record of __set_all.\n"
+               "struct Input {\n";
+        for (const ContextSlotDesc& field : inputRecord) {
+            if (const char* cppType = getCppType(field.d_typeName)) {
+                out << "    " << cppType << ' ' << escapeName(field.d_name) << ";\n";
+            } else {
+                out << "    alignas(" << field.d_alignment << ") unsigned char " << escapeName(field.d_name)
+                    << '[' << field.d_size << "];\n";
+            }
+        }
+        out << "};\n";
+        for (const ContextSlotDesc& field : inputRecord) {
+            out << "static_assert(offsetof(Input, " << escapeName(field.d_name) << ") == " << field.d_offset << ");\n";
+        }
+    }
+    out << "\n} // namespace jex_context\n";
+}
+
+} // namespace jex
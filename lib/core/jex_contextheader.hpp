@@ -0,0 +1,22 @@
+#pragma once
+
+#include <jex_contextlayout.hpp>
+
+#include <iosfwd>
+#include <vector>
+
+namespace jex {
+
+/**
+ * Writes a C++ header with the context size and the offset and an accessor function for each
+ * var and expr slot, so that hot loops can access the context without calling generated
+ * functions. Built-in types are accessed as their C++ types (int64_t, double, bool, std::string),
+ * other types as untyped pointers.
+ * If the input record isn't empty, it is declared as struct Input for __set_all.
+ * Names which are C++ keywords or collide with the names of the header (e.g. contextSize) get an
+ * underscore appended, as do names already ending with an underscore to keep them unique.
+ */
+void writeContextHeader(std::ostream& out, const std::vector<ContextSlotDesc>& slots, size_t contextSize,
+                        const std::vector<ContextSlotDesc>& inputRecord = {});
+
+} // namespace jex
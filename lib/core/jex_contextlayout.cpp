@@ -0,0 +1,98 @@
+#include <jex_contextlayout.hpp>
+
+#include <jex_errorhandling.hpp>
+#include <jex_symboltable.hpp>
+#include <jex_typeinfo.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <tuple>
+
+namespace jex {
+
+namespace {
+
+size_t alignTo(size_t offset, size_t alignment) {
+    return alignment == 0 ? offset : (offset + alignment - 1) / alignment * alignment;
+}
+
+enum class Group {
+    HotValue,
+    HotComplex,
+    Cold,
+};
+
+} // namespace
+
+ContextLayout::ContextLayout(std::vector<const Symbol*> symbols, ContextLayoutOptions options,
+                             size_t hotReserveSize)
+: d_options(std::move(options)) {
+    size_t lineSize = d_options.d_cacheLineSize;
+    if ((lineSize & (lineSize - 1)) != 0) {
+        throw InternalError("Cache line size " + std::to_string(lineSize) + " isn't a power of two");
+    }
+    const std::unordered_map<std::string, uint64_t>& counts = d_options.d_accessCounts;
+    bool useProfile = d_options.d_splitHotCold && !counts.empty();
+    auto getCount = [&counts](const Symbol* sym) -> uint64_t {
+        auto iter = counts.find(std::string(sym->name));
+        return iter != counts.end() ? iter->second : 0;
+    };
+    auto getGroup = [&](const Symbol* sym) {
+        if (!d_options.d_splitHotCold) {
+            return Group::HotValue;
+        }
+        if (useProfile && getCount(sym) == 0) {
+            return Group::Cold;
+        }
+        return sym->type->kind() == TypeKind::Value ? Group::HotValue : Group::HotComplex;
+    };
+    std::sort(symbols.begin(), symbols.end(), [&](const Symbol* a, const Symbol* b) {
+        // Higher access counts first, the counts are all zero without profile.
+        uint64_t countA = useProfile ? getCount(a) : 0;
+        uint64_t countB = useProfile ? getCount(b) : 0;
+        return std::make_tuple(getGroup(a), ~countA, ~a->type->alignment(), a->name) <
+               std::make_tuple(getGroup(b), ~countB, ~b->type->alignment(), b->name);
+    });
+    size_t offset = 0;
+    bool reserved = false;
+    auto reserveHot = [&]() {
+        if (hotReserveSize != 0) {
+            offset = alignTo(offset, alignof(uint64_t));
+            d_hotReserveOffset = offset;
+            offset += hotReserveSize;
+        }
+        reserved = true;
+    };
+    for (const Symbol* sym : symbols) {
+        Group group = getGroup(sym);
+        if (group != Group::HotValue && !reserved) {
+            reserveHot();
+        }
+        bool firstOfGroup = d_slots.empty() || getGroup(d_slots.back().d_symbol) != group;
+        // Without profile data the complex slots are hot as well but accessed less often than
+        // the values, so they get their own cache lines, too.
+        bool newLine = group == Group::Cold || (group == Group::HotComplex && !useProfile);
+        if (firstOfGroup && newLine && offset != 0) {
+            offset = alignTo(offset, d_options.d_cacheLineSize);
+        }
+        offset = alignTo(offset, sym->type->alignment());
+        d_slots.push_back(Slot{sym, offset, group != Group::Cold});
+        d_offsets.emplace(sym, offset);
+        offset += sym->type->size();
+    }
+    if (!reserved) {
+        reserveHot();
+    }
+    d_size = offset;
+}
+
+size_t ContextLayout::getContextSize() const {
+    return alignTo(d_size, d_options.d_cacheLineSize);
+}
+
+size_t ContextLayout::getContextAlignment() const {
+    return std::max(alignof(std::max_align_t), d_options.d_cacheLineSize);
+}
+
+} // namespace jex
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <jex_base.hpp>
+#include <jex_compileoptions.hpp>
+#include <jex_typeinfo.hpp>
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace jex {
+
+struct Symbol;
+
+/**
+ * Describes the slot of a var or expr in the runtime context, so that callers can access it
+ * directly instead of calling the generated setter or expr function.
+ */
+struct ContextSlotDesc {
+    enum class Kind {
+        Var,
+        Expr,
+    };
+
+    std::string d_name;
+    std::string d_typeName;
+    Kind d_kind;
+    TypeKind d_typeKind;
+    size_t d_offset;
+    size_t d_size;
+    size_t d_alignment;
+};
+
+/**
+ * Assigns the offsets of the vars and exprs in the runtime context.
+ * By default the slots are packed by descending alignment, then by name, which avoids any
+ * padding. If hot/cold splitting is enabled, the value slots are grouped in front of the complex
+ * ones, so that the frequently accessed scalars share as few cache lines as possible. With
+ * profile data, slots are ordered by descending access count within their group and slots which
+ * weren't accessed at all are moved behind all others.
+ * With a cache line size, the complex slots start on a new cache line unless profile data moved
+ * the rarely accessed ones into the cold part, which then starts on a new cache line. The context
+ * size is a multiple of the cache line size and contexts have to be aligned to the cache line
+ * size (see getContextAlignment), so that contexts packed in arrays don't share cache lines.
+ * A block reserved in the hot part (e.g. for the dirty bitset of incremental programs) is placed
+ * behind the hot value slots.
+ */
+class ContextLayout : NoCopy {
+public:
+    struct Slot {
+        const Symbol* d_symbol;
+        size_t d_offset;
+        bool d_hot;
+    };
+
+private:
+    ContextLayoutOptions d_options;
+    // Ordered by offset.
+    std::vector<Slot> d_slots;
+    std::unordered_map<const Symbol*, size_t> d_offsets;
+    size_t d_size = 0;
+    size_t d_hotReserveOffset = 0;
+
+public:
+    // Reserves hotReserveSize bytes aligned to 8 bytes in the hot part of the context.
+    ContextLayout(std::vector<const Symbol*> symbols, ContextLayoutOptions options,
+                  size_t hotReserveSize = 0);
+
+    const std::vector<Slot>& getSlots() const {
+        return d_slots;
+    }
+    size_t getOffset(const Symbol* symbol) const {
+        return d_offsets.at(symbol);
+    }
+    // Returns the offset of the block reserved in the hot part.
+    size_t getHotReserveOffset() const {
+        return d_hotReserveOffset;
+    }
+    // Returns the size of the context including the padding to cache lines.
+    size_t getContextSize() const;
+    // Returns the alignment required for the start of a context.
+    size_t getContextAlignment() const;
+};
+
+} // namespace jex
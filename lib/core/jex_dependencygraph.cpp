@@ -0,0 +1,137 @@
+#include <jex_dependencygraph.hpp>
+
+#include <jex_ast.hpp>
+#include <jex_basicastvisitor.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_symboltable.hpp>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace jex {
+
+namespace {
+
+class DependencyCollector : public BasicAstVisitor {
+    const AstVariableDef& d_expr;
+    std::vector<const AstVariableDef*>& d_dependencies;
+    std::vector<const AstVariableDef*>& d_inputs;
+
+public:
+    DependencyCollector(const AstVariableDef& expr, std::vector<const AstVariableDef*>& dependencies,
+                        std::vector<const AstVariableDef*>& inputs)
+    : d_expr(expr)
+    , d_dependencies(dependencies)
+    , d_inputs(inputs) {
+    }
+
+    void visit(AstIdentifier& node) override {
+        const AstVariableDef* def = node.d_symbol != nullptr ? node.d_symbol->defNode : nullptr;
+        if (def == nullptr || def == &d_expr) {
+            return;
+        }
+        if (def->d_kind == VariableKind::Expr) {
+            addOnce(d_dependencies, def);
+        } else if (def->d_kind == VariableKind::Var) {
+            addOnce(d_inputs, def);
+        }
+    }
+
+private:
+    static void addOnce(std::vector<const AstVariableDef*>& defs, const AstVariableDef* def) {
+        if (std::find(defs.begin(), defs.end(), def) == defs.end()) {
+            defs.push_back(def);
+        }
+    }
+};
+
+enum class VisitState {
+    Active,
+    Done
+};
+
+void addInOrder(const DependencyGraph& graph, const AstVariableDef* expr,
+                std::unordered_map<const AstVariableDef*, VisitState>& states,
+                std::vector<const AstVariableDef*>& order) {
+    auto [iter, inserted] = states.emplace(expr, VisitState::Active);
+    if (!inserted) {
+        if (iter->second == VisitState::Active) {
+            throw InternalError("Cyclic dependency of expr '" + std::string(expr->d_name->d_name) + "'");
+        }
+        return;
+    }
+    for (const AstVariableDef* dependency : graph.getDependencies(expr)) {
+        addInOrder(graph, dependency, states, order);
+    }
+    states[expr] = VisitState::Done;
+    order.push_back(expr);
+}
+
+} // namespace
+
+DependencyGraph::DependencyGraph(const AstRoot& root) {
+    for (AstVariableDef* varDef : root.d_varDefs) {
+        if (varDef->d_kind != VariableKind::Expr) {
+            continue;
+        }
+        d_exprs.push_back(varDef);
+        DependencyCollector collector(*varDef, d_dependencies[varDef], d_inputs[varDef]);
+        varDef->d_expr->accept(collector);
+    }
+}
+
+const std::vector<const AstVariableDef*>& DependencyGraph::getDependencies(const AstVariableDef* expr) const {
+    return d_dependencies.at(expr);
+}
+
+const std::vector<const AstVariableDef*>& DependencyGraph::getInputs(const AstVariableDef* expr) const {
+    return d_inputs.at(expr);
+}
+
+const AstVariableDef* DependencyGraph::findExpr(std::string_view name) const {
+    for (const AstVariableDef* expr : d_exprs) {
+        if (expr->d_name->d_name == name) {
+            return expr;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<const AstVariableDef*> DependencyGraph::getEvaluationOrder() const {
+    return getEvaluationOrder(d_exprs);
+}
+
+std::vector<const AstVariableDef*> DependencyGraph::getEvaluationOrder(
+        const std::vector<const AstVariableDef*>& outputs) const {
+    std::unordered_set<const AstVariableDef*> selected(outputs.begin(), outputs.end());
+    std::unordered_map<const AstVariableDef*, VisitState> states;
+    std::vector<const AstVariableDef*> order;
+    // Visit the outputs in declaration order to get the same order for any order of outputs.
+    for (const AstVariableDef* expr : d_exprs) {
+        if (selected.count(expr) != 0) {
+            addInOrder(*this, expr, states, order);
+        }
+    }
+    return order;
+}
+
+std::vector<const AstVariableDef*> DependencyGraph::getDependents(const AstVariableDef* def) const {
+    std::unordered_set<const AstVariableDef*> changed{def};
+    auto isChanged = [&changed](const AstVariableDef* other) {
+        return changed.count(other) != 0;
+    };
+    std::vector<const AstVariableDef*> dependents;
+    // All dependencies of an expr are visited before the expr itself.
+    for (const AstVariableDef* expr : getEvaluationOrder()) {
+        const std::vector<const AstVariableDef*>& dependencies = d_dependencies.at(expr);
+        const std::vector<const AstVariableDef*>& inputs = d_inputs.at(expr);
+        if (std::any_of(dependencies.begin(), dependencies.end(), isChanged) ||
+            std::any_of(inputs.begin(), inputs.end(), isChanged)) {
+            changed.insert(expr);
+            dependents.push_back(expr);
+        }
+    }
+    return dependents;
+}
+
+} // namespace jex
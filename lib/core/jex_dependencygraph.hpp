@@ -0,0 +1,57 @@
+#pragma once
+
+#include <jex_base.hpp>
+
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace jex {
+
+class AstRoot;
+class AstVariableDef;
+
+/**
+ * Dependencies between the exprs of a program. An expr depends on each expr it references, as it
+ * reads the result stored by the referenced expr's last evaluation.
+ * A self-reference reads the expr's previous result and is not a dependency.
+ */
+class DependencyGraph : NoCopy {
+    // All exprs in declaration order.
+    std::vector<const AstVariableDef*> d_exprs;
+    std::unordered_map<const AstVariableDef*, std::vector<const AstVariableDef*>> d_dependencies;
+    // The vars referenced by each expr.
+    std::unordered_map<const AstVariableDef*, std::vector<const AstVariableDef*>> d_inputs;
+
+public:
+    explicit DependencyGraph(const AstRoot& root);
+
+    const std::vector<const AstVariableDef*>& getExprs() const {
+        return d_exprs;
+    }
+    // Returns the exprs directly referenced by the given expr.
+    const std::vector<const AstVariableDef*>& getDependencies(const AstVariableDef* expr) const;
+    // Returns the vars directly referenced by the given expr.
+    const std::vector<const AstVariableDef*>& getInputs(const AstVariableDef* expr) const;
+    // Returns the expr with the given name or null if there isn't any.
+    const AstVariableDef* findExpr(std::string_view name) const;
+
+    /**
+     * Returns all exprs ordered such that every expr comes after its dependencies. Independent
+     * exprs keep their declaration order.
+     */
+    std::vector<const AstVariableDef*> getEvaluationOrder() const;
+    /**
+     * Returns the given exprs and their transitive dependencies, each of them once, in evaluation
+     * order.
+     */
+    std::vector<const AstVariableDef*> getEvaluationOrder(
+        const std::vector<const AstVariableDef*>& outputs) const;
+    /**
+     * Returns the exprs depending directly or transitively on the given var or expr in
+     * evaluation order, i.e. the exprs whose results may change if it changes.
+     */
+    std::vector<const AstVariableDef*> getDependents(const AstVariableDef* def) const;
+};
+
+} // namespace jex
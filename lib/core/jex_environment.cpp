@@ -1,13 +1,49 @@
 #include <jex_environment.hpp>
 
+#include <jex_errorhandling.hpp>
+#include <jex_fctinfo.hpp>
 #include <jex_registry.hpp>
 
+#include <functional>
+#include <string_view>
+
 namespace jex {
 
 void Environment::addModule(const Module& module) {
+    if (d_frozen) {
+        throw InternalError("Modules can't be added to a frozen environment");
+    }
     Registry registry(*this);
     module.registerTypes(registry);
     module.registerFcts(registry);
 }
 
+size_t Environment::fingerprint(bool includeFctAddresses) const {
+    // The registration containers are unordered, so the entries are combined order-independently.
+    std::hash<std::string_view> hashStr;
+    size_t typesHash = 0;
+    for (const auto& [name, type] : d_types) {
+        size_t hash = hashStr(name);
+        hash = hashCombine(hash, type->size());
+        hash = hashCombine(hash, type->alignment());
+        hash = hashCombine(hash, static_cast<size_t>(type->kind()));
+        hash = hashCombine(hash, static_cast<size_t>(type->callConv()));
+        hash = hashCombine(hash, type->isZeroInitialized());
+        typesHash += hash;
+    }
+    size_t fctsHash = 0;
+    for (const auto& [name, fcts] : d_fctLib) {
+        for (const FctInfo* fct : fcts) {
+            size_t hash = hashStr(fct->d_mangledName);
+            if (includeFctAddresses) {
+                hash = hashCombine(hash, reinterpret_cast<size_t>(fct->d_fctPtr));
+            }
+            hash = hashCombine(hash, static_cast<size_t>(fct->d_flags));
+            hash = hashCombine(hash, fct->d_intrinsicFct != nullptr);
+            fctsHash += hash;
+        }
+    }
+    return hashCombine(typesHash, fctsHash);
+}
+
 } // namespace jex
@@ -4,12 +4,15 @@
 #include <jex_fctlibrary.hpp>
 #include <jex_typesystem.hpp>
 
+#include <cassert>
+
 namespace jex {
 class Module;
 
 class Environment : NoCopy {
     TypeSystem d_types;
     FctLibrary d_fctLib;
+    bool d_frozen = false;
 
 public:
     Environment()
@@ -17,9 +20,24 @@ public:
     , d_fctLib() {
     }
 
+    /**
+     * Registers the module's types and functions. Throws an InternalError if the environment is
+     * frozen.
+     */
     void addModule(const Module& module);
 
+    /**
+     * Makes the environment read-only, so that it can be shared by concurrent compilations.
+     */
+    void freeze() {
+        d_frozen = true;
+    }
+    bool isFrozen() const {
+        return d_frozen;
+    }
+
     TypeSystem& types() {
+        assert(!d_frozen && "Frozen environments may not be modified");
         return d_types;
     }
     const TypeSystem& types() const {
@@ -27,11 +45,20 @@ public:
     }
 
     FctLibrary& fctLib() {
+        assert(!d_frozen && "Frozen environments may not be modified");
         return d_fctLib;
     }
     const FctLibrary& fctLib() const {
         return d_fctLib;
     }
+
+    /**
+     * Returns a hash over all registered types and functions. Environments with the same
+     * fingerprint produce the same programs for the same source.
+     * Function addresses differ between processes, so they can be excluded for fingerprints which
+     * are persisted.
+     */
+    size_t fingerprint(bool includeFctAddresses = true) const;
 };
 
 } // namespace jex
@@ -56,8 +56,34 @@ const FctInfo& FctLibrary::getDestructor(TypeInfoId type) const {
     return getFct("_dtor_" + type->name(), {});
 }
 
+const FctInfo& FctLibrary::getClear(TypeInfoId type) const {
+    return getFct("_clear_" + type->name(), {});
+}
+
 const FctInfo& FctLibrary::getAssign(TypeInfoId type) const {
     return getFct("_assign", {type});
 }
 
+const FctInfo& FctLibrary::getMoveAssign(TypeInfoId type) const {
+    return getFct("_moveAssign", {type});
+}
+
+const FctInfo* FctLibrary::findAssignVariant(const FctInfo& fct) const {
+    const auto iter = d_fctsByName.find("_assign_" + fct.d_name);
+    if (iter == d_fctsByName.end()) {
+        return nullptr;
+    }
+    for (const FctInfo* candidate : iter->second) {
+        if (candidate->equals(fct.d_params) && candidate->d_retType == fct.d_retType) {
+            return candidate;
+        }
+    }
+    return nullptr;
+}
+
+const FctInfo* FctLibrary::findFctByMangledName(std::string_view mangledName) const {
+    auto iter = d_fctByMangledName.find(mangledName);
+    return iter != d_fctByMangledName.end() ? iter->second : nullptr;
+}
+
 } // namespace jex
@@ -29,7 +29,18 @@ public:
     const FctInfo& getFct(const std::string& name, const std::vector<TypeInfoId>& paramTypes) const;
     const FctInfo& getConstructor(TypeInfoId type) const;
     const FctInfo& getDestructor(TypeInfoId type) const;
+    // Returns the function resetting an object of a complex type to its default value in place.
+    const FctInfo& getClear(TypeInfoId type) const;
     const FctInfo& getAssign(TypeInfoId type) const;
+    const FctInfo& getMoveAssign(TypeInfoId type) const;
+    /**
+     * Returns the assign variant of the function or null if there is none. The variant is
+     * registered as "_assign_<name>" with the same parameters and writes its result into an
+     * already constructed object, so that it can reuse the object's resources.
+     */
+    const FctInfo* findAssignVariant(const FctInfo& fct) const;
+    // Returns the function with the given mangled name or null if there is none.
+    const FctInfo* findFctByMangledName(std::string_view mangledName) const;
 
 
     FctsByName::const_iterator begin() const {
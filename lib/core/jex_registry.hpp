@@ -79,6 +79,12 @@ struct GenericLifetimeFctsComplex : public GenericLifetimeFcts<ArgT> {
         new (target) Type(*source);
     }
 
+    // Resets the object to its default value. Copy-assigning keeps e.g. a string's capacity.
+    static void clear(RetType obj) {
+        static const Type s_empty{};
+        *obj = s_empty;
+    }
+
     static void moveConstructor(RetType target, ParamType source) {
         if constexpr (std::is_move_constructible_v<Type>) {
             new (target) Type(std::move(*const_cast<Type*>(source)));
@@ -168,6 +174,7 @@ public:
         if constexpr (ArgT::kind == TypeKind::Complex) {
             using LT = GenericLifetimeFctsComplex<ArgT>;
             registerFct(FctDesc<ArgT>("_dtor_" + typeName, LT::destructor));
+            registerFct(FctDesc<ArgT>("_clear_" + typeName, LT::clear));
             registerFct(FctDesc<ArgT, ArgT>("_assign", LT::assign));
             registerFct(FctDesc<ArgT, ArgT>("_moveAssign", LT::moveAssign));
             registerFct(FctDesc<ArgT, ArgT>("_copyCtor", LT::copyConstructor));
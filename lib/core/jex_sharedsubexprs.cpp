@@ -0,0 +1,249 @@
+#include <jex_sharedsubexprs.hpp>
+
+#include <jex_ast.hpp>
+#include <jex_basicastvisitor.hpp>
+#include <jex_fctinfo.hpp>
+#include <jex_symboltable.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <string>
+
+namespace jex {
+
+namespace {
+
+/**
+ * Builds a key identifying an expression structurally. Two expressions with the same key compute
+ * the same result if they are evaluated on the same context.
+ */
+class KeyBuilder : public IAstVisitor {
+    std::string d_key;
+    bool d_pure = true;
+    std::vector<const AstVariableDef*> d_exprRefs;
+
+public:
+    // Returns false if the expression calls impure functions.
+    bool isPure() const {
+        return d_pure;
+    }
+    const std::string& getKey() const {
+        return d_key;
+    }
+    // The exprs read by the expression.
+    const std::vector<const AstVariableDef*>& getExprRefs() const {
+        return d_exprRefs;
+    }
+
+    void visit(AstLiteralExpr& node) override {
+        d_key += 'L';
+        appendRaw(node.d_value.index());
+        std::visit([this](auto val) {
+            if constexpr (std::is_same_v<decltype(val), std::string_view>) {
+                appendRaw(val.size());
+                d_key.append(val);
+            } else {
+                appendRaw(val);
+            }
+        }, node.d_value);
+    }
+    void visit(AstBinaryExpr& node) override {
+        appendFct('B', node.d_fctInfo);
+        node.d_lhs->accept(*this);
+        node.d_rhs->accept(*this);
+        d_key += ')';
+    }
+    void visit(AstLogicalBinExpr& node) override {
+        d_key += 'G';
+        appendRaw(node.d_op);
+        node.d_lhs->accept(*this);
+        node.d_rhs->accept(*this);
+        d_key += ')';
+    }
+    void visit(AstUnaryExpr& node) override {
+        appendFct('U', node.d_fctInfo);
+        node.d_expr->accept(*this);
+        d_key += ')';
+    }
+    void visit(AstFctCall& node) override {
+        appendFct('F', node.d_fctInfo);
+        node.d_args->accept(*this);
+        d_key += ')';
+    }
+    void visit(AstIf& node) override {
+        d_key += 'I';
+        node.d_args->accept(*this);
+        d_key += ')';
+    }
+    void visit(AstIdentifier& node) override {
+        d_key += 'N';
+        appendRaw(node.d_symbol);
+        const AstVariableDef* def = node.d_symbol->defNode;
+        if (def != nullptr && def->d_kind == VariableKind::Expr) {
+            d_exprRefs.push_back(def);
+        }
+    }
+    void visit(AstArgList& node) override {
+        for (IAstExpression* arg : node.d_args) {
+            arg->accept(*this);
+        }
+    }
+    void visit(AstConstantExpr& node) override {
+        d_key += 'C';
+        appendRaw(node.d_constantName.size());
+        d_key += node.d_constantName;
+    }
+    void visit(AstVarArg& node) override {
+        d_key += 'V';
+        for (IAstExpression* arg : node.d_args) {
+            arg->accept(*this);
+        }
+        d_key += ')';
+    }
+    void visit(AstVariableDef&) override {
+        assert(false && "Variable definitions aren't expressions");
+    }
+    void visit(AstRoot&) override {
+        assert(false && "The root isn't an expression");
+    }
+
+private:
+    template <typename T>
+    void appendRaw(T value) {
+        d_key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    void appendFct(char tag, const FctInfo* fctInfo) {
+        d_pure = d_pure && fctInfo != nullptr && fctInfo->isPure();
+        d_key += tag;
+        appendRaw(fctInfo);
+    }
+};
+
+/**
+ * Calls the callback for each function call evaluated unconditionally. The arguments of a call
+ * are only visited if the callback returns false.
+ */
+class UnconditionalCalls : public BasicAstVisitor {
+    std::function<bool(AstFctCall&)> d_onCall;
+
+public:
+    explicit UnconditionalCalls(std::function<bool(AstFctCall&)> onCall)
+    : d_onCall(std::move(onCall)) {
+    }
+
+    void visit(AstFctCall& node) override {
+        if (!d_onCall(node)) {
+            BasicAstVisitor::visit(node);
+        }
+    }
+    void visit(AstIf& node) override {
+        node.d_args->d_args[0]->accept(*this);
+    }
+    void visit(AstLogicalBinExpr& node) override {
+        node.d_lhs->accept(*this);
+    }
+};
+
+struct Candidate {
+    std::string d_key;
+    std::vector<const AstVariableDef*> d_exprRefs;
+};
+
+} // namespace
+
+SharedSubexprs::SharedSubexprs(const AstRoot& root) {
+    std::unordered_map<const AstFctCall*, std::optional<Candidate>> candidates;
+    auto getCandidate = [&candidates](AstFctCall& call) -> const std::optional<Candidate>& {
+        auto iter = candidates.find(&call);
+        if (iter == candidates.end()) {
+            KeyBuilder builder;
+            call.accept(builder);
+            std::optional<Candidate> candidate;
+            if (builder.isPure()) {
+                candidate = Candidate{builder.getKey(), builder.getExprRefs()};
+            }
+            iter = candidates.emplace(&call, std::move(candidate)).first;
+        }
+        return iter->second;
+    };
+    std::unordered_map<std::string, size_t> counts;
+    for (AstVariableDef* def : root.d_varDefs) {
+        if (def->d_kind != VariableKind::Expr) {
+            continue;
+        }
+        UnconditionalCalls counter([&](AstFctCall& call) {
+            if (const std::optional<Candidate>& candidate = getCandidate(call)) {
+                ++counts[candidate->d_key];
+            }
+            return false;
+        });
+        def->d_expr->accept(counter);
+    }
+    // Group the outermost calls occurring more than once.
+    std::vector<std::string> keys;
+    std::unordered_map<std::string, Shared> groups;
+    std::unordered_map<std::string, std::vector<const AstVariableDef*>> exprRefs;
+    for (AstVariableDef* def : root.d_varDefs) {
+        if (def->d_kind != VariableKind::Expr) {
+            continue;
+        }
+        UnconditionalCalls selector([&](AstFctCall& call) {
+            const std::optional<Candidate>& candidate = getCandidate(call);
+            if (!candidate || counts[candidate->d_key] < 2) {
+                return false;
+            }
+            auto [iter, inserted] = groups.try_emplace(candidate->d_key);
+            if (inserted) {
+                keys.push_back(candidate->d_key);
+                exprRefs.emplace(candidate->d_key, candidate->d_exprRefs);
+            }
+            Shared& shared = iter->second;
+            shared.d_occurrences.push_back(&call);
+            if (shared.d_users.empty() || shared.d_users.back() != def) {
+                shared.d_users.push_back(def);
+            }
+            return true;
+        });
+        def->d_expr->accept(selector);
+    }
+    for (const std::string& key : keys) {
+        Shared& shared = groups.at(key);
+        // Nested calls may only occur once outside of the outermost shared calls.
+        if (shared.d_occurrences.size() < 2) {
+            continue;
+        }
+        const std::vector<const AstVariableDef*>& refs = exprRefs.at(key);
+        bool readsUser = std::any_of(refs.begin(), refs.end(), [&shared](const AstVariableDef* ref) {
+            return std::find(shared.d_users.begin(), shared.d_users.end(), ref) != shared.d_users.end();
+        });
+        if (readsUser) {
+            continue;
+        }
+        for (AstFctCall* occurrence : shared.d_occurrences) {
+            d_indices.emplace(occurrence, d_shared.size());
+        }
+        d_shared.push_back(std::move(shared));
+    }
+}
+
+std::optional<size_t> SharedSubexprs::find(const IAstExpression* node) const {
+    auto iter = d_indices.find(node);
+    if (iter == d_indices.end()) {
+        return std::nullopt;
+    }
+    return iter->second;
+}
+
+std::vector<size_t> SharedSubexprs::getUsed(const AstVariableDef* expr) const {
+    std::vector<size_t> used;
+    for (size_t i = 0; i < d_shared.size(); ++i) {
+        const std::vector<const AstVariableDef*>& users = d_shared[i].d_users;
+        if (std::find(users.begin(), users.end(), expr) != users.end()) {
+            used.push_back(i);
+        }
+    }
+    return used;
+}
+
+} // namespace jex
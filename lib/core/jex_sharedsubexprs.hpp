@@ -0,0 +1,49 @@
+#pragma once
+
+#include <jex_base.hpp>
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace jex {
+
+class AstFctCall;
+class AstRoot;
+class AstVariableDef;
+class IAstExpression;
+
+/**
+ * Finds calls of pure functions occurring more than once across the exprs of a program with
+ * structurally equal arguments, so that they can be computed once when evaluating the exprs
+ * together.
+ * Only the outermost equal calls are shared, and only if they are evaluated unconditionally, i.e.
+ * not in a branch of if or on the right side of && and ||. Calls referencing an expr using them
+ * aren't shared, as the expr's result differs before and after its evaluation.
+ */
+class SharedSubexprs : NoCopy {
+public:
+    struct Shared {
+        std::vector<AstFctCall*> d_occurrences;
+        // The exprs containing occurrences in declaration order.
+        std::vector<const AstVariableDef*> d_users;
+    };
+
+private:
+    std::vector<Shared> d_shared;
+    // Index into d_shared for each occurrence.
+    std::unordered_map<const IAstExpression*, size_t> d_indices;
+
+public:
+    explicit SharedSubexprs(const AstRoot& root);
+
+    const std::vector<Shared>& getShared() const {
+        return d_shared;
+    }
+    // Returns the index of the shared call the given node is an occurrence of.
+    std::optional<size_t> find(const IAstExpression* node) const;
+    // Returns the indices of the shared calls occurring in the given expr.
+    std::vector<size_t> getUsed(const AstVariableDef* expr) const;
+};
+
+} // namespace jex
@@ -0,0 +1,83 @@
+#include <jex_aotprogram.hpp>
+
+#include <jex_environment.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_fctinfo.hpp>
+
+#include <cstring>
+#include <string>
+
+#include <dlfcn.h>
+
+namespace jex {
+
+static std::string getDlError() {
+    const char* err = dlerror();
+    return err != nullptr ? err : "unknown error";
+}
+
+AotProgram::AotProgram(void* handle, const AotProgramDesc* desc)
+: d_handle(handle)
+, d_desc(desc) {
+}
+
+std::unique_ptr<AotProgram> AotProgram::load(const std::string& path, const Environment& env) {
+    // The functions and constants are bound globally for the library, so the same library can't
+    // be loaded twice.
+    if (void* loaded = dlopen(path.c_str(), RTLD_NOW | RTLD_NOLOAD)) {
+        dlclose(loaded);
+        throw InternalError("Program '" + path + "' is already loaded");
+    }
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (handle == nullptr) {
+        throw InternalError("Error loading program '" + path + "': " + getDlError());
+    }
+    auto desc = static_cast<const AotProgramDesc*>(dlsym(handle, "__jex_program"));
+    if (desc == nullptr || desc->d_version != AotProgramDesc::s_version) {
+        dlclose(handle);
+        throw InternalError("'" + path + "' is not a compatible jex program");
+    }
+    for (uint64_t i = 0; i < desc->d_fctCount; ++i) {
+        const AotFctEntry& fct = desc->d_fcts[i];
+        const FctInfo* fctInfo = env.fctLib().findFctByMangledName(fct.d_mangledName);
+        if (fctInfo == nullptr) {
+            std::string err = std::string("Program uses unknown function '") + fct.d_mangledName + "'";
+            dlclose(handle);
+            throw InternalError(err);
+        }
+        *fct.d_slot = fctInfo->d_fctPtr;
+    }
+    for (uint64_t i = 0; i < desc->d_constantCount; ++i) {
+        const AotConstantEntry& constant = desc->d_constants[i];
+        switch (constant.d_kind) {
+            case AotConstantKind::Bytes:
+                std::memcpy(constant.d_storage, constant.d_data, constant.d_size);
+                break;
+            case AotConstantKind::String:
+                new (constant.d_storage) std::string(constant.d_data, constant.d_size);
+                break;
+        }
+    }
+    return std::unique_ptr<AotProgram>(new AotProgram(handle, desc));
+}
+
+AotProgram::~AotProgram() {
+    for (uint64_t i = 0; i < d_desc->d_constantCount; ++i) {
+        const AotConstantEntry& constant = d_desc->d_constants[i];
+        if (constant.d_kind == AotConstantKind::String) {
+            using String = std::string;
+            static_cast<String*>(constant.d_storage)->~String();
+        }
+    }
+    dlclose(d_handle);
+}
+
+uintptr_t AotProgram::getFctPtr(std::string_view fctName) const {
+    void* sym = dlsym(d_handle, std::string(fctName).c_str());
+    if (sym == nullptr) {
+        throw InternalError("Error looking up function pointer: " + getDlError());
+    }
+    return reinterpret_cast<uintptr_t>(sym);
+}
+
+} // namespace jex
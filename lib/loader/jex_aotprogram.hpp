@@ -0,0 +1,78 @@
+#pragma once
+
+#include <jex_base.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace jex {
+
+class Environment;
+
+/**
+ * Layout of the program descriptor "__jex_program" emitted by the AotEmitter.
+ * External functions are called through the pointer slots listed in the function table, so that
+ * the loader can bind them to the functions registered in an Environment.
+ * Constants are emitted as uninitialized storage which the loader fills from the constant table.
+ */
+struct AotFctEntry {
+    const char* d_mangledName;
+    void** d_slot;
+};
+
+enum class AotConstantKind : uint64_t {
+    Bytes,  // Value type, copied bytewise.
+    String, // Built-in String, constructed from the data.
+};
+
+struct AotConstantEntry {
+    AotConstantKind d_kind;
+    void* d_storage;
+    const char* d_data;
+    uint64_t d_size;
+};
+
+struct AotProgramDesc {
+    static constexpr uint64_t s_version = 2;
+
+    uint64_t d_version;
+    uint64_t d_contextSize;
+    uint64_t d_contextAlignment;
+    uint64_t d_fctCount;
+    const AotFctEntry* d_fcts;
+    uint64_t d_constantCount;
+    const AotConstantEntry* d_constants;
+};
+
+/**
+ * Program compiled ahead of time into a shared library (see jexc --emit-shared).
+ * Loading a program doesn't require LLVM. The environment has to provide all functions used by
+ * the program.
+ */
+class AotProgram : NoCopy {
+    void* d_handle;
+    const AotProgramDesc* d_desc;
+
+    AotProgram(void* handle, const AotProgramDesc* desc);
+
+public:
+    /**
+     * Loads the shared library and binds it to the functions of the given environment.
+     * Throws an InternalError if the library is invalid, already loaded or uses unknown functions.
+     */
+    static std::unique_ptr<AotProgram> load(const std::string& path, const Environment& env);
+    ~AotProgram();
+
+    uintptr_t getFctPtr(std::string_view fctName) const;
+
+    size_t getContextSize() const {
+        return d_desc->d_contextSize;
+    }
+    size_t getContextAlignment() const {
+        return d_desc->d_contextAlignment;
+    }
+};
+
+} // namespace jex
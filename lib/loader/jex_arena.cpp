@@ -0,0 +1,65 @@
+#include <jex_arena.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+namespace jex {
+
+static thread_local Arena* s_currentArena = nullptr;
+
+Arena::Arena(size_t blockSize)
+: d_blockSize(blockSize) {
+    assert(blockSize > 0);
+}
+
+void* Arena::allocateSlow(size_t size, size_t align) {
+    assert(align != 0 && (align & (align - 1)) == 0);
+    // Any block with size + align bytes fits the allocation independent of its alignment.
+    size_t required = size + align;
+    // Continue with the next block that is large enough, blocks are kept across resets.
+    size_t next = d_ptr == nullptr ? 0 : d_currBlock + 1;
+    while (next < d_blocks.size() && d_blocks[next].d_size < required) {
+        ++next;
+    }
+    if (next == d_blocks.size()) {
+        size_t blockSize = std::max(d_blockSize, required);
+        // Left uninitialized, make_unique would zero the whole block.
+        d_blocks.push_back(Block{std::unique_ptr<char[]>(new char[blockSize]), blockSize});
+    }
+    d_currBlock = next;
+    d_ptr = d_blocks[next].d_data.get();
+    d_end = d_ptr + d_blocks[next].d_size;
+    return allocate(size, align);
+}
+
+void Arena::reset() {
+    d_currBlock = 0;
+    if (d_blocks.empty()) {
+        return;
+    }
+    d_ptr = d_blocks[0].d_data.get();
+    d_end = d_ptr + d_blocks[0].d_size;
+}
+
+size_t Arena::getCapacity() const {
+    size_t capacity = 0;
+    for (const Block& block : d_blocks) {
+        capacity += block.d_size;
+    }
+    return capacity;
+}
+
+Arena* Arena::current() {
+    return s_currentArena;
+}
+
+ArenaScope::ArenaScope(Arena* arena)
+: d_prev(s_currentArena) {
+    s_currentArena = arena;
+}
+
+ArenaScope::~ArenaScope() {
+    s_currentArena = d_prev;
+}
+
+} // namespace jex
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <jex_base.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace jex {
+
+/**
+ * Bump allocator for temporaries of an evaluation. Allocating only advances a pointer within the
+ * current block. The memory is released wholesale by reset() which keeps the blocks for reuse.
+ * Destructors of objects placed into the arena aren't called. The arena isn't thread-safe, every
+ * thread uses its own one, e.g. the arena of its ExecutionContext.
+ */
+class Arena : NoCopy {
+    struct Block {
+        std::unique_ptr<char[]> d_data;
+        size_t d_size;
+    };
+
+    const size_t d_blockSize;
+    std::vector<Block> d_blocks;
+    size_t d_currBlock = 0;
+    char* d_ptr = nullptr;
+    char* d_end = nullptr;
+
+public:
+    explicit Arena(size_t blockSize = 64 * 1024);
+
+    // Returns size bytes aligned to align (a power of two) valid until the next reset().
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+        uintptr_t aligned = (reinterpret_cast<uintptr_t>(d_ptr) + align - 1) & ~(align - 1);
+        if (d_ptr != nullptr && aligned + size <= reinterpret_cast<uintptr_t>(d_end)) {
+            d_ptr = reinterpret_cast<char*>(aligned + size);
+            return reinterpret_cast<void*>(aligned);
+        }
+        return allocateSlow(size, align);
+    }
+
+    // Releases all allocations. Doesn't free any blocks.
+    void reset();
+
+    // Returns the size of all blocks allocated so far.
+    size_t getCapacity() const;
+    size_t getBlockCount() const {
+        return d_blocks.size();
+    }
+
+    /**
+     * Returns the arena bound to the calling thread by an ArenaScope or null. This is the handle
+     * for functions called from generated code which don't get the context as an argument.
+     */
+    static Arena* current();
+
+private:
+    void* allocateSlow(size_t size, size_t align);
+};
+
+/**
+ * Binds an arena to the calling thread as Arena::current() for the lifetime of the scope.
+ * Scopes can be nested, the previously bound arena is restored on destruction.
+ */
+class ArenaScope : NoCopy {
+    Arena* const d_prev;
+
+public:
+    explicit ArenaScope(Arena* arena);
+    ~ArenaScope();
+};
+
+} // namespace jex
@@ -0,0 +1,120 @@
+#include <jex_contextpool.hpp>
+
+#include <jex_errorhandling.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <string>
+
+namespace jex {
+
+static size_t getAlignment(size_t alignment) {
+    assert((alignment & (alignment - 1)) == 0);
+    return std::max(alignment, alignof(std::max_align_t));
+}
+
+static size_t getStride(size_t contextSize, size_t alignment) {
+    // Empty contexts still need distinct addresses.
+    return std::max(alignment, (contextSize + alignment - 1) / alignment * alignment);
+}
+
+ContextPool::ContextPool(LifetimeFct ctor, LifetimeFct dtor, LifetimeFct reset, size_t contextSize,
+                         size_t contextsPerSlab, size_t alignment)
+: d_ctor(ctor)
+, d_dtor(dtor)
+, d_reset(reset)
+, d_alignment(getAlignment(alignment))
+, d_stride(getStride(contextSize, d_alignment))
+, d_contextsPerSlab(std::max(contextsPerSlab, size_t(1))) {
+}
+
+ContextPool::ContextPool(LifetimeFct ctor, LifetimeFct dtor, LifetimeFct reset, size_t contextSize,
+                         void* buffer, size_t bufferSize, size_t alignment)
+: d_ctor(ctor)
+, d_dtor(dtor)
+, d_reset(reset)
+, d_alignment(getAlignment(alignment))
+, d_stride(getStride(contextSize, d_alignment))
+, d_contextsPerSlab(0)
+, d_fixedBuffer(true) {
+    // Skip the unaligned start of the buffer.
+    auto address = reinterpret_cast<uintptr_t>(buffer);
+    size_t padding = (d_alignment - address % d_alignment) % d_alignment;
+    if (buffer != nullptr && bufferSize >= padding) {
+        d_slabBegin = static_cast<char*>(buffer) + padding;
+        d_slabSize = (bufferSize - padding) / d_stride;
+    }
+}
+
+ContextPool::~ContextPool() {
+    // Destruct the contexts of all slabs, the last one might only be partially used.
+    for (size_t i = 0; i < d_slabs.size(); ++i) {
+        char* slab = d_slabs[i].get();
+        size_t used = i + 1 == d_slabs.size() ? d_slabUsed : d_contextsPerSlab;
+        for (size_t ctx = 0; ctx < used; ++ctx) {
+            d_dtor(slab + ctx * d_stride);
+        }
+    }
+    if (d_fixedBuffer) {
+        for (size_t ctx = 0; ctx < d_slabUsed; ++ctx) {
+            d_dtor(d_slabBegin + ctx * d_stride);
+        }
+    }
+}
+
+size_t ContextPool::getBufferSize(size_t contextSize, size_t count, size_t alignment) {
+    alignment = getAlignment(alignment);
+    // Reserve space for aligning the start of the buffer.
+    return count * getStride(contextSize, alignment) + alignment - 1;
+}
+
+char* ContextPool::acquire() {
+    char* rctx = nullptr;
+    if (!d_free.empty()) {
+        rctx = d_free.back();
+        d_free.pop_back();
+    } else {
+        rctx = constructNext();
+    }
+    ++d_liveCount;
+    return rctx;
+}
+
+void ContextPool::release(char* rctx) {
+    assert(d_liveCount > 0);
+    if (d_reset != nullptr) {
+        d_reset(rctx);
+    } else {
+        d_dtor(rctx);
+        d_ctor(rctx);
+    }
+    d_free.push_back(rctx);
+    --d_liveCount;
+}
+
+char* ContextPool::constructNext() {
+    if (d_slabUsed == d_slabSize) {
+        if (d_fixedBuffer) {
+            throw InternalError("Context pool exhausted: the buffer only fits " + std::to_string(d_slabSize) + " contexts");
+        }
+        // The stride is a multiple of the alignment as required by aligned_alloc. The memory is
+        // left uninitialized, __init_rctx initializes each context.
+        char* slab = static_cast<char*>(std::aligned_alloc(d_alignment, d_contextsPerSlab * d_stride));
+        if (slab == nullptr) {
+            throw std::bad_alloc();
+        }
+        d_slabs.emplace_back(slab);
+        d_slabBegin = d_slabs.back().get();
+        d_slabSize = d_contextsPerSlab;
+        d_slabUsed = 0;
+    }
+    char* rctx = d_slabBegin + d_slabUsed * d_stride;
+    d_ctor(rctx);
+    ++d_slabUsed;
+    ++d_constructedCount;
+    return rctx;
+}
+
+} // namespace jex
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <jex_base.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace jex {
+
+/**
+ * Allocates contexts of a program in slabs of many contexts and reuses released contexts.
+ * A released context is reset into the state after __init_rctx, so acquiring it again only costs
+ * popping it from the free list. __reset_rctx clears complex members in place, so they keep
+ * resources like the capacity of strings across reuses. The pool owns all contexts, they are destructed with the pool.
+ * Contexts are only constructed on their first acquisition. The pool isn't thread-safe.
+ */
+class ContextPool : NoCopy {
+public:
+    using LifetimeFct = ExecutionContext::LifetimeFct;
+
+private:
+    const LifetimeFct d_ctor;
+    const LifetimeFct d_dtor;
+    const LifetimeFct d_reset;
+    struct FreeDeleter {
+        void operator()(char* ptr) const {
+            std::free(ptr);
+        }
+    };
+
+    // Alignment of each context, at least that of std::max_align_t.
+    const size_t d_alignment;
+    // Distance between two contexts, keeping each of them aligned.
+    const size_t d_stride;
+    const size_t d_contextsPerSlab;
+    std::vector<std::unique_ptr<char, FreeDeleter>> d_slabs;
+    // The contexts of the caller-provided buffer or the last slab.
+    char* d_slabBegin = nullptr;
+    size_t d_slabSize = 0;
+    // Number of contexts constructed in the last slab.
+    size_t d_slabUsed = 0;
+    std::vector<char*> d_free;
+    size_t d_liveCount = 0;
+    size_t d_constructedCount = 0;
+    bool d_fixedBuffer = false;
+
+public:
+    /**
+     * Creates a pool allocating contextsPerSlab contexts at once. If reset is null, released
+     * contexts are destructed and constructed again. Each context is aligned to alignment, which
+     * has to be a power of two.
+     */
+    ContextPool(LifetimeFct ctor, LifetimeFct dtor, LifetimeFct reset, size_t contextSize,
+                size_t contextsPerSlab = 64, size_t alignment = alignof(std::max_align_t));
+    /**
+     * Creates a pool placing its contexts into the given caller-provided buffer which has to
+     * outlive the pool. The pool doesn't allocate any memory; acquire() throws an InternalError
+     * if all contexts fitting into the buffer are in use.
+     */
+    ContextPool(LifetimeFct ctor, LifetimeFct dtor, LifetimeFct reset, size_t contextSize,
+                void* buffer, size_t bufferSize, size_t alignment = alignof(std::max_align_t));
+    /**
+     * Creates a pool for a compiled program, i.e. a JIT-compiled CompileResult or an ahead-of-time
+     * compiled AotProgram. The program has to be compiled with CompileOptions::d_resetFct.
+     */
+    template <typename Program>
+    explicit ContextPool(const Program& program, size_t contextsPerSlab = 64)
+    : ContextPool(reinterpret_cast<LifetimeFct>(program.getFctPtr("__init_rctx")),
+                  reinterpret_cast<LifetimeFct>(program.getFctPtr("__destruct_rctx")),
+                  reinterpret_cast<LifetimeFct>(program.getFctPtr("__reset_rctx")),
+                  program.getContextSize(), contextsPerSlab, program.getContextAlignment()) {
+    }
+    ~ContextPool();
+
+    // Returns the size in bytes a caller-provided buffer needs for the given number of contexts.
+    static size_t getBufferSize(size_t contextSize, size_t count,
+                                size_t alignment = alignof(std::max_align_t));
+
+    // Returns an initialized context, reusing a released one if available.
+    char* acquire();
+    // Resets the given context acquired from this pool and keeps it for reuse.
+    void release(char* rctx);
+
+    // Returns the number of acquired and not yet released contexts.
+    size_t getLiveCount() const {
+        return d_liveCount;
+    }
+    // Returns the number of contexts constructed so far, i.e. the live and the released ones.
+    size_t getConstructedCount() const {
+        return d_constructedCount;
+    }
+
+private:
+    char* constructNext();
+};
+
+} // namespace jex
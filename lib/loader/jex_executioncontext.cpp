@@ -0,0 +1,51 @@
+#include <jex_executioncontext.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace jex {
+
+static size_t alignTo(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+ExecutionContext::ExecutionContext(LifetimeFct ctor, LifetimeFct dtor, size_t size, size_t dataOffset,
+                                   size_t arenaBlockSize)
+: d_dtor(dtor)
+, d_size(size)
+, d_dataOffset(dataOffset)
+, d_arena(arenaBlockSize != 0 ? std::make_unique<Arena>(arenaBlockSize) : nullptr) {
+    // Initialize all context variables.
+    ctor(getDataPtr());
+}
+
+ExecutionContext::~ExecutionContext() {
+    // Destruct all context variables.
+    d_dtor(getDataPtr());
+}
+
+void* ExecutionContext::operator new(size_t objectSize, size_t contextSize, size_t alignment) {
+    assert(alignment >= alignof(ExecutionContext) && (alignment & (alignment - 1)) == 0);
+    // aligned_alloc requires the size to be a multiple of the alignment.
+    size_t totalSize = alignTo(alignTo(objectSize, alignment) + contextSize, alignment);
+    void* ptr = std::aligned_alloc(alignment, totalSize);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void ExecutionContext::operator delete(void* ptr, size_t, size_t) noexcept {
+    std::free(ptr);
+}
+
+std::unique_ptr<ExecutionContext> ExecutionContext::create(LifetimeFct ctor, LifetimeFct dtor, size_t size,
+                                                           size_t arenaBlockSize, size_t alignment) {
+    alignment = std::max(alignment, alignof(std::max_align_t));
+    size_t dataOffset = alignTo(sizeof(ExecutionContext), alignment);
+    return std::unique_ptr<ExecutionContext>(
+        new(size, alignment) ExecutionContext(ctor, dtor, size, dataOffset, arenaBlockSize));
+}
+
+} // namespace jex
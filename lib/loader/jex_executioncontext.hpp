@@ -0,0 +1,79 @@
+#pragma once
+
+#include <jex_arena.hpp>
+#include <jex_base.hpp>
+
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+
+namespace jex {
+
+class ExecutionContext : NoCopy {
+public:
+    using LifetimeFct = void(*)(void*);
+
+private:
+    const LifetimeFct d_dtor;
+    const size_t d_size;
+    // Offset of the context data from this, a multiple of the context alignment.
+    const size_t d_dataOffset;
+    // Optional arena for temporaries of functions evaluated on this context.
+    std::unique_ptr<Arena> d_arena;
+
+    ExecutionContext(LifetimeFct ctor, LifetimeFct dtor, size_t size, size_t dataOffset,
+                     size_t arenaBlockSize);
+
+    // Allocates the object followed by the context data aligned to the given alignment.
+    void* operator new(size_t objectSize, size_t contextSize, size_t alignment);
+    // Only used if the constructor throws.
+    void operator delete(void* ptr, size_t contextSize, size_t alignment) noexcept;
+
+public:
+    ~ExecutionContext();
+
+    // The memory is allocated with std::aligned_alloc, see operator new.
+    void operator delete(void* ptr) noexcept { // NOLINT
+        std::free(ptr);
+    }
+
+    /**
+     * Creates a context. If arenaBlockSize isn't zero, the context owns an Arena allocating blocks
+     * of this size. The context data is aligned to alignment, which has to be a power of two.
+     */
+    static std::unique_ptr<ExecutionContext> create(LifetimeFct ctor, LifetimeFct dtor, size_t size,
+                                                    size_t arenaBlockSize = 0,
+                                                    size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * Creates a context for a compiled program, i.e. a JIT-compiled CompileResult or an
+     * ahead-of-time compiled AotProgram.
+     */
+    template <typename Program>
+    static std::unique_ptr<ExecutionContext> create(const Program& program, size_t arenaBlockSize = 0) {
+        return create(reinterpret_cast<LifetimeFct>(program.getFctPtr("__init_rctx")),
+                      reinterpret_cast<LifetimeFct>(program.getFctPtr("__destruct_rctx")),
+                      program.getContextSize(), arenaBlockSize, program.getContextAlignment());
+    }
+
+    char* getDataPtr() {
+        return reinterpret_cast<char*>(this) + d_dataOffset;
+    }
+
+    /**
+     * Returns the arena of the context or null if it was created without one. Functions reach it
+     * through Arena::current() while it is bound by an ArenaScope. The caller resets it between
+     * evaluations, so results stored in the context must not point into it.
+     */
+    Arena* getArena() {
+        return d_arena.get();
+    }
+    // Releases the temporaries of the last evaluation if the context has an arena.
+    void resetArena() {
+        if (d_arena != nullptr) {
+            d_arena->reset();
+        }
+    }
+};
+
+} // namespace jex
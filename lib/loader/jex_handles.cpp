@@ -0,0 +1,25 @@
+#include <jex_handles.hpp>
+
+namespace jex {
+
+uintptr_t FctTable::getFctPtr(std::string_view fctName) const {
+    auto iter = d_fcts.find(std::string(fctName));
+    if (iter == d_fcts.end()) {
+        throw InternalError("Function '" + std::string(fctName) + "' isn't defined by the program");
+    }
+    return iter->second;
+}
+
+void checkContextSlot(const ContextSlotDesc* slot, std::string_view name, ContextSlotDesc::Kind kind,
+                      std::string_view typeName) {
+    const char* kindName = kind == ContextSlotDesc::Kind::Var ? "var" : "expr";
+    if (slot == nullptr || slot->d_kind != kind) {
+        throw InternalError(std::string("Program doesn't have ") + kindName + " '" + std::string(name) + "'");
+    }
+    if (slot->d_typeName != typeName) {
+        throw InternalError(std::string("Type mismatch for ") + kindName + " '" + std::string(name) +
+                            "': expected " + std::string(typeName) + ", but it is " + slot->d_typeName);
+    }
+}
+
+} // namespace jex
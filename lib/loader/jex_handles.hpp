@@ -0,0 +1,127 @@
+#pragma once
+
+#include <jex_base.hpp>
+#include <jex_contextlayout.hpp>
+#include <jex_errorhandling.hpp>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace jex {
+
+/**
+ * Function pointers of a program resolved in bulk (see CompileResult::resolveAll()), so that
+ * binding handles on the request path doesn't look up any symbols.
+ */
+class FctTable {
+    std::unordered_map<std::string, uintptr_t> d_fcts;
+
+public:
+    FctTable() = default;
+    explicit FctTable(std::unordered_map<std::string, uintptr_t> fcts)
+    : d_fcts(std::move(fcts)) {
+    }
+
+    // Throws an InternalError if the table doesn't contain the function.
+    uintptr_t getFctPtr(std::string_view fctName) const;
+
+    size_t size() const {
+        return d_fcts.size();
+    }
+};
+
+// Throws an InternalError if the slot is null or doesn't have the given kind and type name.
+void checkContextSlot(const ContextSlotDesc* slot, std::string_view name, ContextSlotDesc::Kind kind,
+                      std::string_view typeName);
+
+/**
+ * Typed handle to the function of an expr, resolved and type-checked once when it is bound.
+ * ArgT describes the expected type like for registered functions, e.g. ArgInteger or ArgString.
+ * Calling the handle is a direct call of the generated function.
+ */
+template <typename ArgT>
+class ExprHandle {
+public:
+    using Type = typename ArgT::Type;
+    using FctType = Type* (*)(char* rctx);
+
+private:
+    FctType d_fct = nullptr;
+
+public:
+    ExprHandle() = default;
+    /**
+     * Binds the handle to the expr of a CompileResult. Throws an InternalError if the program
+     * doesn't have an expr of this name and type.
+     */
+    template <typename Program>
+    ExprHandle(const Program& program, std::string_view name)
+    : ExprHandle(program, program, name) {
+    }
+    // Binds the handle taking the function pointer from the given (bulk-resolved) FctTable.
+    template <typename Program, typename Fcts>
+    ExprHandle(const Program& program, const Fcts& fcts, std::string_view name) {
+        checkContextSlot(program.findContextSlot(name), name, ContextSlotDesc::Kind::Expr, ArgT::name);
+        d_fct = reinterpret_cast<FctType>(fcts.getFctPtr(name));
+    }
+
+    explicit operator bool() const {
+        return d_fct != nullptr;
+    }
+
+    // Evaluates the expr and returns its result stored in the context.
+    const Type& operator()(char* rctx) const {
+        return *d_fct(rctx);
+    }
+
+    FctType getFct() const {
+        return d_fct;
+    }
+};
+
+/**
+ * Typed handle to the setter of a var, resolved and type-checked once when it is bound.
+ * Setting a var through the handle marks the exprs depending on it dirty like the setter does.
+ */
+template <typename ArgT>
+class VarSetter {
+public:
+    using Type = typename ArgT::Type;
+    using FctType = void (*)(char* rctx, const Type* value);
+
+private:
+    FctType d_fct = nullptr;
+
+public:
+    VarSetter() = default;
+    /**
+     * Binds the setter to the var of a CompileResult. Throws an InternalError if the program
+     * doesn't have a var of this name and type.
+     */
+    template <typename Program>
+    VarSetter(const Program& program, std::string_view name)
+    : VarSetter(program, program, name) {
+    }
+    // Binds the setter taking the function pointer from the given (bulk-resolved) FctTable.
+    template <typename Program, typename Fcts>
+    VarSetter(const Program& program, const Fcts& fcts, std::string_view name) {
+        checkContextSlot(program.findContextSlot(name), name, ContextSlotDesc::Kind::Var, ArgT::name);
+        d_fct = reinterpret_cast<FctType>(fcts.getFctPtr(name));
+    }
+
+    explicit operator bool() const {
+        return d_fct != nullptr;
+    }
+
+    void operator()(char* rctx, const Type& value) const {
+        d_fct(rctx, &value);
+    }
+
+    FctType getFct() const {
+        return d_fct;
+    }
+};
+
+} // namespace jex
@@ -0,0 +1,138 @@
+#include <jex_compilecache.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_compileenv.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_fctinfo.hpp>
+#include <jex_lexer.hpp>
+
+#include <map>
+#include <optional>
+#include <string_view>
+
+namespace jex {
+
+template <typename T>
+static void appendRaw(std::string& key, T value) {
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void appendString(std::string& key, std::string_view str) {
+    // Length-prefixed, so that consecutive strings can't be ambiguous.
+    appendRaw(key, str.size());
+    key.append(str);
+}
+
+/**
+ * Creates the cache key for the given compilation. Returns an empty optional if the source can't
+ * be tokenized.
+ */
+static std::optional<std::string> createKey(const Environment& env, const std::string& source,
+                                            const CompileOptions& options) {
+    std::string key;
+    key.reserve(source.size() + 64);
+    appendRaw(key, env.fingerprint());
+    appendRaw(key, options.d_optLevel);
+    appendRaw(key, options.d_useIntrinsics);
+    appendRaw(key, options.d_enableConstantFolding);
+    appendString(key, options.d_cpu);
+    appendRaw(key, options.d_lazy);
+    appendRaw(key, options.d_batchFcts);
+    appendRaw(key, options.d_columnar);
+    appendRaw(key, options.d_evalAll);
+    appendRaw(key, options.d_incremental);
+    appendRaw(key, options.d_shareSubexprs);
+    appendRaw(key, options.d_resetFct);
+    appendRaw(key, options.d_setAll);
+    appendRaw(key, options.d_scratchSlots);
+    appendRaw(key, options.d_inPlaceResults);
+    // A result compiled without a report can't serve a caller asking for one.
+    appendRaw(key, options.d_collectReport);
+    appendRaw(key, options.d_evalOutputs.size());
+    for (const std::string& output : options.d_evalOutputs) {
+        appendString(key, output);
+    }
+    const ContextLayoutOptions& layout = options.d_layout;
+    appendRaw(key, layout.d_splitHotCold);
+    appendRaw(key, layout.d_cacheLineSize);
+    // Sorted, as the iteration order of the map isn't deterministic.
+    std::map<std::string_view, uint64_t> accessCounts(layout.d_accessCounts.begin(), layout.d_accessCounts.end());
+    appendRaw(key, accessCounts.size());
+    for (const auto& [name, count] : accessCounts) {
+        appendString(key, name);
+        appendRaw(key, count);
+    }
+    CompileEnv compileEnv(env, options.d_useIntrinsics);
+    Lexer lexer(compileEnv, source.c_str());
+    try {
+        for (Token token = lexer.getNext(); token.kind != Token::Kind::Eof; token = lexer.getNext()) {
+            appendRaw(key, token.kind);
+            appendString(key, token.text);
+        }
+    } catch (const CompileError&) {
+        return std::nullopt;
+    }
+    return key;
+}
+
+CompileCache::CompileCache() = default;
+
+CompileCache::~CompileCache() = default;
+
+std::shared_ptr<const CompileResult> CompileCache::compile(const Environment& env,
+                                                           const std::string& source,
+                                                           const CompileOptions& options) {
+    std::optional<std::string> key = createKey(env, source, options);
+    if (key) {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        auto iter = d_results.find(*key);
+        if (iter != d_results.end()) {
+            ++d_hitCount;
+            return iter->second;
+        }
+        ++d_missCount;
+    }
+    // Compile without holding the lock. If the same program is compiled concurrently, the first
+    // result stored wins.
+    auto result = std::make_shared<const CompileResult>(Compiler::compile(env, source, options));
+    if (!key || !*result) {
+        return result;
+    }
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_results.emplace(std::move(*key), std::move(result)).first->second;
+}
+
+void CompileCache::removeUnused() {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    for (auto iter = d_results.begin(); iter != d_results.end();) {
+        if (iter->second.use_count() == 1) {
+            iter = d_results.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void CompileCache::clear() {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_results.clear();
+}
+
+size_t CompileCache::size() const {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_results.size();
+}
+
+size_t CompileCache::getHitCount() const {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_hitCount;
+}
+
+size_t CompileCache::getMissCount() const {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_missCount;
+}
+
+} // namespace jex
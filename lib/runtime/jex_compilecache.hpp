@@ -0,0 +1,48 @@
+#pragma once
+
+#include <jex_base.hpp>
+#include <jex_compileoptions.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace jex {
+
+class CompileResult;
+class Environment;
+
+/**
+ * Content-addressed cache of compiled programs.
+ * Programs are identified by their token stream (so whitespace and comments don't matter), the
+ * compile options and the fingerprint of the environment. A cache hit returns the already
+ * compiled program, which is shared by all users. Failed compilations are not cached.
+ * All member functions are thread-safe.
+ */
+class CompileCache : NoCopy {
+    mutable std::mutex d_mutex;
+    std::unordered_map<std::string, std::shared_ptr<const CompileResult>> d_results;
+    size_t d_hitCount = 0;
+    size_t d_missCount = 0;
+
+public:
+    CompileCache();
+    ~CompileCache();
+
+    std::shared_ptr<const CompileResult> compile(const Environment& env,
+                                                 const std::string& source,
+                                                 const CompileOptions& options = {});
+
+    /**
+     * Removes all programs which are not referenced outside of the cache.
+     */
+    void removeUnused();
+    void clear();
+
+    size_t size() const;
+    size_t getHitCount() const;
+    size_t getMissCount() const;
+};
+
+} // namespace jex
@@ -1,46 +1,198 @@
 #include <jex_compiler.hpp>
 
+#include <jex_aotemitter.hpp>
 #include <jex_compileenv.hpp>
+#include <jex_compilereport.hpp>
 #include <jex_parser.hpp>
 #include <jex_typeinference.hpp>
 #include <jex_codegen.hpp>
 #include <jex_codemodule.hpp>
 #include <jex_constantfolding.hpp>
+#include <jex_contextheader.hpp>
+#include <jex_dependencygraph.hpp>
 #include <jex_backend.hpp>
 #include <jex_builtins.hpp>
 #include <jex_environment.hpp>
 #include <jex_errorhandling.hpp>
+#include <jex_jitsession.hpp>
+#include <jex_targetmachine.hpp>
+
+#include "llvm/IR/Module.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <vector>
+
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
 
 namespace jex {
 
-static void parseAndCheck(CompileEnv& compileEnv, const std::string& source, bool enableConstantFolding) {
-    Parser parser(compileEnv, source.c_str());
-    parser.parse();
-    TypeInference typeInference(compileEnv);
-    typeInference.run();
-    ConstantFolding constFolding(compileEnv, enableConstantFolding);
-    constFolding.run();
+/**
+ * Runs the command without a shell, so that arguments are never interpreted. Throws an
+ * InternalError if it can't be started or doesn't exit successfully.
+ */
+static void runCommand(const std::vector<std::string>& args) {
+    std::vector<char*> argv;
+    for (const std::string& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+    pid_t pid = 0;
+    int err = posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ);
+    if (err != 0) {
+        throw InternalError("Error starting '" + args[0] + "': " + std::strerror(err));
+    }
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            throw InternalError("Error waiting for '" + args[0] + "': " + std::strerror(errno));
+        }
+    }
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw InternalError("Error linking shared library: '" + args[0] + "' failed");
+    }
+}
+
+static void parseAndCheck(CompileEnv& compileEnv, const std::string& source, const CompileOptions& options) {
+    CompileReport* report = compileEnv.report();
+    {
+        CompilePhase phase(report, "parse");
+        Parser parser(compileEnv, source.c_str());
+        parser.parse();
+    }
+    if (report != nullptr) {
+        report->d_astNodeCount = compileEnv.nodeCount();
+    }
+    {
+        CompilePhase phase(report, "type inference");
+        TypeInference typeInference(compileEnv);
+        typeInference.run();
+    }
+    {
+        CompilePhase phase(report, "constant folding");
+        ConstantFolding constFolding(compileEnv, options.d_enableConstantFolding);
+        constFolding.run();
+    }
+    if (!options.d_evalOutputs.empty()) {
+        DependencyGraph graph(*compileEnv.getRoot());
+        for (const std::string& name : options.d_evalOutputs) {
+            if (graph.findExpr(name) == nullptr) {
+                compileEnv.throwError(Location(), "Unknown expr '" + name + "' selected as output");
+            }
+        }
+    }
+}
+
+// Returns the options without lazy compilation, which only applies to programs run by the JIT.
+static CompileOptions eagerOptions(const CompileOptions& options) {
+    CompileOptions eager = options;
+    eager.d_lazy = false;
+    return eager;
 }
 
 CompileResult Compiler::compile(const Environment& env, const std::string& source, OptLevel optLevel, bool useIntrinsics, bool enableConstantFolding) {
-    CompileEnv compileEnv(env, useIntrinsics);
+    return compile(env, source, CompileOptions{optLevel, useIntrinsics, enableConstantFolding});
+}
+
+CompileResult Compiler::compile(const Environment& env, const std::string& source, const CompileOptions& options) {
+    CompileEnv compileEnv(env, options.d_useIntrinsics);
+    if (options.d_collectReport) {
+        compileEnv.enableReport();
+    }
     try {
-        parseAndCheck(compileEnv, source, enableConstantFolding);
-        CodeGen codeGen(compileEnv, optLevel);
+        parseAndCheck(compileEnv, source, options);
+        std::shared_ptr<JitSession> session = JitSession::getDefault(options);
+        std::unique_ptr<llvm::TargetMachine> targetMachine = session->createTargetMachine();
+        CodeGen codeGen(compileEnv, options, targetMachine.get(), session->getObjectCache());
         codeGen.createIR();
-        Backend backend(compileEnv);
-        return backend.jit(codeGen.releaseModule());
+        if (!options.d_collectReport) {
+            Backend backend(compileEnv, std::move(session));
+            return backend.jit(codeGen.releaseModule());
+        }
+        // Compile everything now so that the report covers the machine code generation. Lazy
+        // programs are only compiled on demand, so they are reported without it.
+        Backend backend(compileEnv, std::move(session));
+        CompileResult result = backend.jit(codeGen.releaseModule());
+        if (!options.d_lazy) {
+            CompilePhase phase(result.d_report.get(), "materialization");
+            result.materialize(result.getDefinedFcts());
+        }
+        result.d_report->d_codeBytes = result.getMemoryUsage().d_codeBytes;
+        return result;
     } catch (const CompileError&) {
         assert(compileEnv.hasErrors());
         assert(!compileEnv.messages().empty());
-        return CompileResult(compileEnv.releaseMessages());
+        CompileResult result(compileEnv.releaseMessages());
+        result.d_report = compileEnv.releaseReport();
+        return result;
     }
 }
 
+void Compiler::emitObject(const std::string& fileName, const Environment& env, const std::string& source, const CompileOptions& options) {
+    CompileEnv compileEnv(env, options.d_useIntrinsics);
+    parseAndCheck(compileEnv, source, options);
+    // The object may be used on other machines, so don't rely on host CPU features by default.
+    std::unique_ptr<llvm::TargetMachine> targetMachine = createTargetMachine(
+        options.d_cpu.empty() ? "generic" : options.d_cpu, /*positionIndependent*/true);
+    CodeGen codeGen(compileEnv, eagerOptions(options), targetMachine.get());
+    codeGen.createIR();
+    std::unique_ptr<CodeModule> module = codeGen.releaseModule();
+    AotEmitter(compileEnv).emitObject(module->llvmModule(), fileName, *targetMachine);
+}
+
+void Compiler::emitSharedLibrary(const std::string& fileName, const Environment& env, const std::string& source, const CompileOptions& options) {
+    // $CC may contain a launcher or flags (e.g. "ccache cc"), it is split at whitespace.
+    std::vector<std::string> args;
+    const char* compiler = std::getenv("CC");
+    std::istringstream compilerArgs(compiler != nullptr ? compiler : "");
+    for (std::string arg; compilerArgs >> arg;) {
+        args.push_back(std::move(arg));
+    }
+    if (args.empty()) {
+        args.emplace_back("cc");
+    }
+    std::string objFileName = fileName + ".o";
+    args.insert(args.end(), {"-shared", "-o", fileName, objFileName});
+    try {
+        emitObject(objFileName, env, source, options);
+        runCommand(args);
+    } catch (...) {
+        std::remove(objFileName.c_str());
+        throw;
+    }
+    std::remove(objFileName.c_str());
+}
+
+void Compiler::emitHeader(std::ostream& out, const Environment& env, const std::string& source, const CompileOptions& options) {
+    CompileEnv compileEnv(env, options.d_useIntrinsics);
+    parseAndCheck(compileEnv, source, options);
+    // The layout is assigned by the code generation, the module isn't needed.
+    CompileOptions headerOptions = eagerOptions(options);
+    headerOptions.d_optLevel = OptLevel::O0;
+    CodeGen codeGen(compileEnv, headerOptions);
+    codeGen.createIR();
+    writeContextHeader(out, compileEnv.getContextSlots(), compileEnv.getContextSize(), compileEnv.getInputRecord());
+}
+
 void Compiler::printIR(std::ostream& out, const Environment& env, const std::string& source, OptLevel optLevel, bool useIntrinsics, bool enableConstantFolding) {
-    CompileEnv compileEnv(env, useIntrinsics);
-    parseAndCheck(compileEnv, source, enableConstantFolding);
-    CodeGen codeGen(compileEnv, optLevel);
+    printIR(out, env, source, CompileOptions{optLevel, useIntrinsics, enableConstantFolding});
+}
+
+void Compiler::printIR(std::ostream& out, const Environment& env, const std::string& source, const CompileOptions& options) {
+    CompileEnv compileEnv(env, options.d_useIntrinsics);
+    parseAndCheck(compileEnv, source, options);
+    std::unique_ptr<llvm::TargetMachine> targetMachine;
+    if (!options.d_cpu.empty()) {
+        targetMachine = createTargetMachine(options.d_cpu);
+    }
+    CodeGen codeGen(compileEnv, eagerOptions(options), targetMachine.get());
     codeGen.createIR();
     codeGen.printIR(out);
 }
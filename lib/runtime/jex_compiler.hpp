@@ -1,8 +1,10 @@
 # pragma once
 
 #include <jex_base.hpp>
-// TODO: Needed for OptLevel, consider moving somewhere else.
-#include <jex_codegen.hpp>
+#include <jex_compileoptions.hpp>
+
+#include <iosfwd>
+#include <string>
 
 namespace jex {
 
@@ -18,6 +20,36 @@ public:
                                  OptLevel optLevel = OptLevel::O2,
                                  bool useIntrinsics = true,
                                  bool enableConstantFolding = true);
+    static CompileResult compile(const Environment& env,
+                                 const std::string& source,
+                                 const CompileOptions& options);
+
+    /**
+     * Compiles the source ahead of time into a position independent object file.
+     * Throws a CompileError for invalid source code.
+     */
+    static void emitObject(const std::string& fileName,
+                           const Environment& env,
+                           const std::string& source,
+                           const CompileOptions& options = {});
+
+    /**
+     * Compiles the source ahead of time into a shared library which can be loaded with
+     * AotProgram. Linking uses the system's compiler driver ($CC or cc).
+     */
+    static void emitSharedLibrary(const std::string& fileName,
+                                  const Environment& env,
+                                  const std::string& source,
+                                  const CompileOptions& options = {});
+
+    /**
+     * Writes a C++ header describing the context layout, see writeContextHeader().
+     * Throws a CompileError for invalid source code.
+     */
+    static void emitHeader(std::ostream& out,
+                           const Environment& env,
+                           const std::string& source,
+                           const CompileOptions& options = {});
 
     static void printIR(std::ostream& out,
                         const Environment& env,
@@ -25,6 +57,13 @@ public:
                         OptLevel optLevel = OptLevel::O2,
                         bool useIntrinsics = true,
                         bool enableConstantFolding = true);
+    /**
+     * Prints the optimized IR. The IR is target independent unless a CPU is selected.
+     */
+    static void printIR(std::ostream& out,
+                        const Environment& env,
+                        const std::string& source,
+                        const CompileOptions& options);
 };
 
 } // namespace jex
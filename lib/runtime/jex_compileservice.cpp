@@ -0,0 +1,111 @@
+#include <jex_compileservice.hpp>
+
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_fctinfo.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+
+namespace jex {
+
+CompileService::CompileService(Environment& env, size_t threadCount, const CompileOptions& options)
+: d_env(env)
+, d_options(options) {
+    env.freeze();
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    d_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        d_workers.emplace_back([this] { work(); });
+    }
+}
+
+CompileService::~CompileService() {
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_stopping = true;
+    }
+    d_queueCond.notify_all();
+    for (std::thread& worker : d_workers) {
+        worker.join();
+    }
+}
+
+std::future<CompileResult> CompileService::submit(std::string source) {
+    std::future<CompileResult> future;
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        Job& job = d_queue.emplace_back();
+        job.d_source = std::move(source);
+        future = job.d_result.get_future();
+    }
+    d_queueCond.notify_one();
+    return future;
+}
+
+void CompileService::submit(std::string source, Callback callback) {
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        Job& job = d_queue.emplace_back();
+        job.d_source = std::move(source);
+        job.d_callback = std::move(callback);
+    }
+    d_queueCond.notify_one();
+}
+
+size_t CompileService::getPendingCount() {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_queue.size() + d_activeCount;
+}
+
+CompileResult CompileService::compile(const std::string& source) {
+    CompileResult result = Compiler::compile(d_env, source, d_options);
+    if (result) {
+        // Generate the machine code now instead of on the caller's first lookup.
+        result.getFctPtr("__init_rctx");
+    }
+    return result;
+}
+
+void CompileService::work() {
+    std::unique_lock<std::mutex> lock(d_mutex);
+    while (true) {
+        d_queueCond.wait(lock, [this] { return d_stopping || !d_queue.empty(); });
+        if (d_queue.empty()) {
+            return; // Stopping and all work is done.
+        }
+        Job job = std::move(d_queue.front());
+        d_queue.pop_front();
+        ++d_activeCount;
+        lock.unlock();
+        std::optional<CompileResult> result;
+        std::exception_ptr error;
+        try {
+            result.emplace(compile(job.d_source));
+        } catch (...) {
+            error = std::current_exception();
+        }
+        auto setResult = [&] {
+            if (error) {
+                job.d_result.set_exception(error);
+            } else {
+                job.d_result.set_value(std::move(*result));
+            }
+        };
+        if (job.d_callback) {
+            setResult();
+            job.d_callback(job.d_result.get_future());
+        }
+        lock.lock();
+        // The job has to be finished before the caller can observe the result.
+        --d_activeCount;
+        if (!job.d_callback) {
+            setResult();
+        }
+    }
+}
+
+} // namespace jex
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <jex_backend.hpp>
+#include <jex_base.hpp>
+#include <jex_compileoptions.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jex {
+
+class Environment;
+
+/**
+ * Compiles programs asynchronously on a pool of worker threads.
+ * The environment is frozen on construction, as it is shared read-only by all workers. Registered
+ * functions may be called concurrently during constant folding, so they have to be thread-safe.
+ * Programs are fully materialized on the worker, so looking up their functions is cheap.
+ * All member functions are thread-safe.
+ */
+class CompileService : NoCopy {
+public:
+    // Called on the worker thread with the ready future of the result. Must not throw.
+    using Callback = std::function<void(std::future<CompileResult> result)>;
+
+private:
+    struct Job {
+        std::string d_source;
+        std::promise<CompileResult> d_result;
+        Callback d_callback;
+    };
+
+    const Environment& d_env;
+    CompileOptions d_options;
+    std::mutex d_mutex;
+    std::condition_variable d_queueCond;
+    std::deque<Job> d_queue;
+    std::vector<std::thread> d_workers;
+    size_t d_activeCount = 0;
+    bool d_stopping = false;
+
+public:
+    /**
+     * Starts the given number of worker threads, one per hardware thread if zero.
+     */
+    CompileService(Environment& env, size_t threadCount = 0, const CompileOptions& options = {});
+    /**
+     * Finishes all submitted compilations before stopping the workers.
+     */
+    ~CompileService();
+
+    /**
+     * Queues the source for compilation. The result may contain compile errors, internal errors
+     * are reported as exceptions by the future.
+     */
+    std::future<CompileResult> submit(std::string source);
+    /**
+     * Queues the source for compilation and passes the result to the callback once it is
+     * compiled, so that the caller doesn't need a thread waiting for it. The compilation only
+     * counts as finished once the callback returned.
+     */
+    void submit(std::string source, Callback callback);
+
+    const Environment& getEnvironment() const {
+        return d_env;
+    }
+    const CompileOptions& getOptions() const {
+        return d_options;
+    }
+    size_t getThreadCount() const {
+        return d_workers.size();
+    }
+    // Returns the number of submitted compilations which didn't finish yet.
+    size_t getPendingCount();
+
+private:
+    void work();
+    CompileResult compile(const std::string& source);
+};
+
+} // namespace jex
@@ -0,0 +1,213 @@
+#include <jex_parallelevaluator.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <optional>
+
+#include <unistd.h>
+
+namespace jex {
+
+using Clock = std::chrono::steady_clock;
+
+// Used if the cache size can't be queried.
+static constexpr size_t s_defaultCacheBytes = 256 * 1024;
+// Smaller chunks would make the scheduling overhead noticeable.
+static constexpr size_t s_minChunkRows = 16;
+// Chunks per worker to leave some room for balancing uneven rows.
+static constexpr size_t s_chunksPerWorker = 4;
+
+ParallelEvaluator::ParallelEvaluator(ExecutionContext::LifetimeFct ctor,
+                                     ExecutionContext::LifetimeFct dtor, size_t contextSize,
+                                     size_t threadCount, size_t arenaBlockSize,
+                                     size_t contextAlignment)
+: d_contextSize(contextSize) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    d_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        Worker& worker = *d_workers.emplace_back(std::make_unique<Worker>());
+        worker.d_scratch = ExecutionContext::create(ctor, dtor, contextSize, arenaBlockSize, contextAlignment);
+    }
+    d_threads.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i) {
+        d_threads.emplace_back([this, i] { work(i); });
+    }
+}
+
+ParallelEvaluator::~ParallelEvaluator() {
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        d_stopping = true;
+    }
+    d_startCond.notify_all();
+    for (std::thread& thread : d_threads) {
+        thread.join();
+    }
+}
+
+size_t ParallelEvaluator::getChunkSize(size_t rowCount, size_t bytesPerRow) const {
+    if (d_chunkSize != 0) {
+        return d_chunkSize;
+    }
+    long cacheBytes = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    size_t cache = cacheBytes > 0 ? static_cast<size_t>(cacheBytes) : s_defaultCacheBytes;
+    // Only fill half of the cache, the other half is left for the code and shared data.
+    size_t rows = cache / 2 / std::max<size_t>(bytesPerRow, 1);
+    size_t parts = d_workers.size() * s_chunksPerWorker;
+    rows = std::min(rows, (rowCount + parts - 1) / parts);
+    return std::max(rows, s_minChunkRows);
+}
+
+ParallelEvalStats ParallelEvaluator::evaluate(const std::vector<ExprFct>& exprs,
+                                              char* const* rctxs, size_t count) {
+    RangeFct fct = [&exprs, rctxs](size_t begin, size_t end, ExecutionContext& scratch) {
+        for (ExprFct expr : exprs) {
+            for (size_t i = begin; i < end; ++i) {
+                expr(rctxs[i]);
+                scratch.resetArena();
+            }
+        }
+    };
+    return run(count, d_contextSize + sizeof(char*), fct);
+}
+
+ParallelEvalStats ParallelEvaluator::run(size_t rowCount, size_t bytesPerRow, const RangeFct& fct) {
+    std::lock_guard<std::mutex> runLock(d_runMutex);
+    Clock::time_point start = Clock::now();
+    size_t chunkSize = getChunkSize(rowCount, bytesPerRow);
+    size_t chunkCount = (rowCount + chunkSize - 1) / chunkSize;
+    size_t workerCount = d_workers.size();
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(d_mutex);
+        for (size_t i = 0; i < workerCount; ++i) {
+            Worker& worker = *d_workers[i];
+            std::lock_guard<std::mutex> workerLock(worker.d_mutex);
+            worker.d_begin = chunkCount * i / workerCount;
+            worker.d_end = chunkCount * (i + 1) / workerCount;
+            worker.d_stats = ParallelEvalStats::Worker();
+        }
+        d_fct = &fct;
+        d_rowCount = rowCount;
+        d_runChunkSize = chunkSize;
+        d_error = nullptr;
+        d_activeCount = workerCount - 1;
+        ++d_generation;
+        lock.unlock();
+        d_startCond.notify_all();
+        evaluateChunks(0);
+        lock.lock();
+        d_doneCond.wait(lock, [this] { return d_activeCount == 0; });
+        d_fct = nullptr;
+        error = d_error;
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    ParallelEvalStats stats;
+    stats.d_chunkSize = chunkSize;
+    for (const std::unique_ptr<Worker>& worker : d_workers) {
+        stats.d_workers.push_back(worker->d_stats);
+    }
+    stats.d_wallSec = std::chrono::duration<double>(Clock::now() - start).count();
+    return stats;
+}
+
+void ParallelEvaluator::work(size_t worker) {
+    std::unique_lock<std::mutex> lock(d_mutex);
+    size_t generation = 0;
+    while (true) {
+        d_startCond.wait(lock, [&] { return d_stopping || d_generation != generation; });
+        if (d_stopping) {
+            return;
+        }
+        generation = d_generation;
+        lock.unlock();
+        evaluateChunks(worker);
+        lock.lock();
+        if (--d_activeCount == 0) {
+            d_doneCond.notify_one();
+        }
+    }
+}
+
+void ParallelEvaluator::evaluateChunks(size_t worker) {
+    Worker& self = *d_workers[worker];
+    // Only bind the arena if there is one, so an arena bound by the caller isn't hidden.
+    std::optional<ArenaScope> arenaScope;
+    if (Arena* arena = self.d_scratch->getArena()) {
+        arenaScope.emplace(arena);
+    }
+    while (true) {
+        size_t chunk = 0;
+        if (!popChunk(worker, chunk)) {
+            if (stealChunks(worker)) {
+                continue;
+            }
+            return; // All chunks are taken.
+        }
+        size_t begin = chunk * d_runChunkSize;
+        size_t end = std::min(begin + d_runChunkSize, d_rowCount);
+        Clock::time_point start = Clock::now();
+        try {
+            (*d_fct)(begin, end, *self.d_scratch);
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> lock(d_mutex);
+                if (!d_error) {
+                    d_error = std::current_exception();
+                }
+            }
+            // Drop the remaining chunks of all workers.
+            for (const std::unique_ptr<Worker>& other : d_workers) {
+                std::lock_guard<std::mutex> lock(other->d_mutex);
+                other->d_begin = other->d_end;
+            }
+            return;
+        }
+        self.d_stats.d_busySec += std::chrono::duration<double>(Clock::now() - start).count();
+        self.d_stats.d_rows += end - begin;
+        ++self.d_stats.d_chunks;
+    }
+}
+
+bool ParallelEvaluator::popChunk(size_t worker, size_t& chunk) {
+    Worker& self = *d_workers[worker];
+    std::lock_guard<std::mutex> lock(self.d_mutex);
+    if (self.d_begin == self.d_end) {
+        return false;
+    }
+    chunk = self.d_begin++;
+    return true;
+}
+
+bool ParallelEvaluator::stealChunks(size_t worker) {
+    size_t workerCount = d_workers.size();
+    for (size_t offset = 1; offset < workerCount; ++offset) {
+        Worker& victim = *d_workers[(worker + offset) % workerCount];
+        size_t begin = 0;
+        size_t end = 0;
+        {
+            std::lock_guard<std::mutex> lock(victim.d_mutex);
+            size_t remaining = victim.d_end - victim.d_begin;
+            if (remaining == 0) {
+                continue;
+            }
+            // Take the back half, the victim continues at the front.
+            end = victim.d_end;
+            begin = end - (remaining + 1) / 2;
+            victim.d_end = begin;
+        }
+        Worker& self = *d_workers[worker];
+        std::lock_guard<std::mutex> lock(self.d_mutex);
+        self.d_begin = begin;
+        self.d_end = end;
+        self.d_stats.d_stolenChunks += end - begin;
+        return true;
+    }
+    return false;
+}
+
+} // namespace jex
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <jex_base.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace jex {
+
+/**
+ * Timings of a parallel evaluation.
+ */
+struct ParallelEvalStats {
+    struct Worker {
+        size_t d_rows = 0;
+        size_t d_chunks = 0;
+        // Chunks taken from the queues of other workers.
+        size_t d_stolenChunks = 0;
+        // Time spent evaluating chunks, i.e. excluding scheduling and waiting.
+        double d_busySec = 0;
+    };
+
+    // Indexed by worker, the calling thread is worker 0.
+    std::vector<Worker> d_workers;
+    size_t d_chunkSize = 0;
+    double d_wallSec = 0;
+};
+
+/**
+ * Evaluates a compiled program on a batch of rows using a pool of worker threads.
+ * The rows are split into chunks sized to fit into the cache. Each worker starts with a contiguous
+ * range of chunks and steals half of the remaining chunks of another worker once its own range is
+ * exhausted, so uneven rows don't leave workers idle.
+ * Every worker owns a scratch context of the program for evaluations which don't keep a context
+ * per row. The calling thread takes part in the evaluation as worker 0.
+ * With an arenaBlockSize, every scratch context owns an Arena which is bound to its worker while
+ * evaluating, so temporaries don't contend on the global allocator. It is reset after each row.
+ * Without an arena, an arena bound by the caller stays bound on the calling thread.
+ * Only one evaluation runs at a time, concurrent calls are serialized.
+ */
+class ParallelEvaluator : NoCopy {
+public:
+    using ExprFct = void* (*)(char*);
+    using RangeFct = std::function<void(size_t begin, size_t end, ExecutionContext& scratch)>;
+
+private:
+    struct alignas(64) Worker {
+        std::mutex d_mutex;
+        // Range of chunk indices still to be evaluated.
+        size_t d_begin = 0;
+        size_t d_end = 0;
+        std::unique_ptr<ExecutionContext> d_scratch;
+        ParallelEvalStats::Worker d_stats;
+    };
+
+    const size_t d_contextSize;
+    size_t d_chunkSize = 0;
+    std::vector<std::unique_ptr<Worker>> d_workers;
+    std::vector<std::thread> d_threads;
+    std::mutex d_runMutex;
+    // State of the current evaluation, guarded by d_mutex.
+    std::mutex d_mutex;
+    std::condition_variable d_startCond;
+    std::condition_variable d_doneCond;
+    size_t d_generation = 0;
+    size_t d_activeCount = 0;
+    bool d_stopping = false;
+    const RangeFct* d_fct = nullptr;
+    size_t d_rowCount = 0;
+    size_t d_runChunkSize = 0;
+    std::exception_ptr d_error;
+
+public:
+    /**
+     * Starts threadCount - 1 worker threads, one worker per hardware thread if zero. The scratch
+     * contexts are aligned to contextAlignment.
+     */
+    ParallelEvaluator(ExecutionContext::LifetimeFct ctor, ExecutionContext::LifetimeFct dtor,
+                      size_t contextSize, size_t threadCount = 0, size_t arenaBlockSize = 0,
+                      size_t contextAlignment = alignof(std::max_align_t));
+
+    /**
+     * Creates an evaluator for a compiled program, i.e. a JIT-compiled CompileResult or an
+     * ahead-of-time compiled AotProgram.
+     */
+    template <typename Program>
+    explicit ParallelEvaluator(const Program& program, size_t threadCount = 0, size_t arenaBlockSize = 0)
+    : ParallelEvaluator(
+          reinterpret_cast<ExecutionContext::LifetimeFct>(program.getFctPtr("__init_rctx")),
+          reinterpret_cast<ExecutionContext::LifetimeFct>(program.getFctPtr("__destruct_rctx")),
+          program.getContextSize(), threadCount, arenaBlockSize, program.getContextAlignment()) {
+    }
+
+    ~ParallelEvaluator();
+
+    /**
+     * Calls the expression functions for each of the count contexts. Within a chunk, each
+     * function is called for all of its rows before the next one, so the functions have to be
+     * ordered such that expressions are evaluated before the expressions referencing them.
+     */
+    ParallelEvalStats evaluate(const std::vector<ExprFct>& exprs, char* const* rctxs, size_t count);
+
+    /**
+     * Calls fct for consecutive ranges of rows covering [0, rowCount) together with the scratch
+     * context of the calling worker. bytesPerRow is the amount of memory touched per row and is
+     * used to size the chunks. fct has to call scratch.resetArena() after each row, so that the
+     * arena doesn't grow with the rows of a chunk.
+     * An exception thrown by fct stops the evaluation and is rethrown after all workers finished.
+     */
+    ParallelEvalStats run(size_t rowCount, size_t bytesPerRow, const RangeFct& fct);
+
+    /**
+     * Sets a fixed number of rows per chunk. If zero (the default), the chunk size is derived
+     * from the cache size.
+     */
+    void setChunkSize(size_t rows) {
+        d_chunkSize = rows;
+    }
+    size_t getChunkSize(size_t rowCount, size_t bytesPerRow) const;
+
+    size_t getThreadCount() const {
+        return d_workers.size();
+    }
+    ExecutionContext& getScratchContext(size_t worker) {
+        return *d_workers[worker]->d_scratch;
+    }
+
+private:
+    void work(size_t worker);
+    void evaluateChunks(size_t worker);
+    bool popChunk(size_t worker, size_t& chunk);
+    bool stealChunks(size_t worker);
+};
+
+} // namespace jex
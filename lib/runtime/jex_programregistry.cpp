@@ -0,0 +1,142 @@
+#include <jex_programregistry.hpp>
+
+#include <jex_backend.hpp>
+#include <jex_compiler.hpp>
+#include <jex_errorhandling.hpp>
+
+namespace jex {
+
+ProgramRegistry::ProgramRegistry(const Environment& env, size_t byteBudget, const CompileOptions& options)
+: d_env(env)
+, d_byteBudget(byteBudget)
+, d_options(options) {
+}
+
+ProgramRegistry::~ProgramRegistry() = default;
+
+void ProgramRegistry::add(const std::string& name, std::string source) {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    Entry& entry = d_entries[name];
+    unload(entry);
+    entry.d_source = std::move(source);
+    entry.d_version = ++d_nextVersion;
+    // A running compilation of the old source finishes without being stored.
+    entry.d_loading = {};
+}
+
+void ProgramRegistry::remove(const std::string& name) {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    auto iter = d_entries.find(name);
+    if (iter != d_entries.end()) {
+        unload(iter->second);
+        d_entries.erase(iter);
+    }
+}
+
+std::shared_ptr<const CompileResult> ProgramRegistry::get(const std::string& name) {
+    std::unique_lock<std::mutex> lock(d_mutex);
+    auto iter = d_entries.find(name);
+    if (iter == d_entries.end()) {
+        throw InternalError("Unknown program '" + name + "'");
+    }
+    Entry& entry = iter->second;
+    if (entry.d_program) {
+        d_lru.splice(d_lru.begin(), d_lru, entry.d_lruPos);
+        return entry.d_program;
+    }
+    if (entry.d_loading.valid()) {
+        std::shared_future<ProgramPtr> loading = entry.d_loading;
+        lock.unlock();
+        return loading.get();
+    }
+    std::promise<ProgramPtr> promise;
+    entry.d_loading = promise.get_future().share();
+    ++d_compileCount;
+    std::string source = entry.d_source;
+    size_t version = entry.d_version;
+    lock.unlock();
+    return compile(name, source, version, promise);
+}
+
+ProgramRegistry::ProgramPtr ProgramRegistry::compile(const std::string& name, const std::string& source,
+                                                     size_t version, std::promise<ProgramPtr>& promise) {
+    std::shared_ptr<CompileResult> program;
+    try {
+        program = std::make_shared<CompileResult>(Compiler::compile(d_env, source, d_options));
+        if (*program) {
+            // Materialize the code, so that its memory can be accounted.
+            program->getFctPtr("__init_rctx");
+        }
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(d_mutex);
+            auto iter = d_entries.find(name);
+            if (iter != d_entries.end() && iter->second.d_version == version) {
+                iter->second.d_loading = {};
+            }
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+    {
+        std::lock_guard<std::mutex> lock(d_mutex);
+        auto iter = d_entries.find(name);
+        // Only store the program if it wasn't removed or replaced in the meantime.
+        if (iter != d_entries.end() && iter->second.d_version == version) {
+            Entry& entry = iter->second;
+            entry.d_loading = {};
+            entry.d_program = program;
+            entry.d_bytes = program->getMemoryUsage().total();
+            d_usedBytes += entry.d_bytes;
+            d_lru.push_front(&entry);
+            entry.d_lruPos = d_lru.begin();
+            evict(&entry);
+        }
+    }
+    promise.set_value(program);
+    return program;
+}
+
+void ProgramRegistry::unload(Entry& entry) {
+    if (entry.d_program) {
+        d_lru.erase(entry.d_lruPos);
+        d_usedBytes -= entry.d_bytes;
+        entry.d_bytes = 0;
+        entry.d_program.reset();
+    }
+}
+
+void ProgramRegistry::evict(const Entry* keep) {
+    while (d_usedBytes > d_byteBudget && !d_lru.empty() && d_lru.back() != keep) {
+        unload(*d_lru.back());
+        ++d_evictionCount;
+    }
+}
+
+size_t ProgramRegistry::getByteBudget() const {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_byteBudget;
+}
+
+void ProgramRegistry::setByteBudget(size_t byteBudget) {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_byteBudget = byteBudget;
+    evict(nullptr);
+}
+
+size_t ProgramRegistry::getUsedBytes() const {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_usedBytes;
+}
+
+size_t ProgramRegistry::getCompileCount() const {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_compileCount;
+}
+
+size_t ProgramRegistry::getEvictionCount() const {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    return d_evictionCount;
+}
+
+} // namespace jex
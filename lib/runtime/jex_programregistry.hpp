@@ -0,0 +1,86 @@
+#pragma once
+
+#include <jex_base.hpp>
+#include <jex_compileoptions.hpp>
+
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace jex {
+
+class CompileResult;
+class Environment;
+
+/**
+ * Keeps a set of named programs compiled while staying within a memory budget.
+ * Programs are compiled on first access. If the memory held by all compiled programs exceeds the
+ * budget, the least recently used programs are evicted and transparently recompiled from their
+ * source when accessed again.
+ * Evicted programs stay alive as long as a caller still holds a reference to them, so the budget
+ * only limits the memory owned by the registry itself.
+ * All member functions are thread-safe. Programs are compiled without holding the registry lock,
+ * so a compilation doesn't block accesses to other programs. Concurrent get() calls for a program
+ * being compiled wait for that compilation.
+ */
+class ProgramRegistry : NoCopy {
+    using ProgramPtr = std::shared_ptr<const CompileResult>;
+
+    struct Entry {
+        std::string d_source;
+        // Changes whenever the source is replaced, so that outdated compilations are dropped.
+        size_t d_version = 0;
+        ProgramPtr d_program;
+        // Set while the program is compiled.
+        std::shared_future<ProgramPtr> d_loading;
+        size_t d_bytes = 0;
+        // Position in d_lru, only valid if d_program is set.
+        std::list<Entry*>::iterator d_lruPos;
+    };
+
+    const Environment& d_env;
+    size_t d_byteBudget;
+    CompileOptions d_options;
+    mutable std::mutex d_mutex;
+    std::unordered_map<std::string, Entry> d_entries;
+    // Compiled entries, most recently used first.
+    std::list<Entry*> d_lru;
+    size_t d_usedBytes = 0;
+    size_t d_nextVersion = 0;
+    size_t d_compileCount = 0;
+    size_t d_evictionCount = 0;
+
+public:
+    ProgramRegistry(const Environment& env, size_t byteBudget, const CompileOptions& options = {});
+    ~ProgramRegistry();
+
+    /**
+     * Adds or replaces the program with the given name. It is compiled on the first get().
+     */
+    void add(const std::string& name, std::string source);
+    void remove(const std::string& name);
+
+    /**
+     * Returns the compiled program, compiling it if it isn't available (any more).
+     * The returned result may contain compile errors. Throws if the name is unknown.
+     */
+    std::shared_ptr<const CompileResult> get(const std::string& name);
+
+    size_t getByteBudget() const;
+    void setByteBudget(size_t byteBudget);
+    size_t getUsedBytes() const;
+    size_t getCompileCount() const;
+    size_t getEvictionCount() const;
+
+private:
+    ProgramPtr compile(const std::string& name, const std::string& source, size_t version,
+                       std::promise<ProgramPtr>& promise);
+    void unload(Entry& entry);
+    // Evicts least recently used programs except for the given one until the budget is met.
+    void evict(const Entry* keep);
+};
+
+} // namespace jex
@@ -0,0 +1,89 @@
+#include <jex_tieredprogram.hpp>
+
+#include <jex_compiler.hpp>
+#include <jex_compileservice.hpp>
+#include <jex_environment.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_fctinfo.hpp>
+
+#include <exception>
+#include <future>
+
+namespace jex {
+
+static CompileResult compileBaseline(const std::string& source, const CompileService& optimizer) {
+    CompileOptions options = optimizer.getOptions();
+    options.d_optLevel = OptLevel::O0;
+    return Compiler::compile(optimizer.getEnvironment(), source, options);
+}
+
+TieredProgram::TieredProgram(std::string source, CompileService& optimizer, size_t hotThreshold)
+: d_source(std::move(source))
+, d_optimizer(optimizer)
+, d_hotThreshold(hotThreshold)
+, d_baseline(compileBaseline(d_source, optimizer)) {
+}
+
+TieredProgram::~TieredProgram() {
+    waitOptimized();
+}
+
+TieredFct& TieredProgram::getFct(std::string_view fctName) {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    std::unique_ptr<TieredFct>& fct = d_fcts[std::string(fctName)];
+    if (!fct) {
+        const CompileResult& current = isOptimized() ? *d_optimized : d_baseline;
+        try {
+            fct = std::make_unique<TieredFct>(*this, current.getFctPtr(fctName));
+        } catch (const InternalError&) {
+            d_fcts.erase(std::string(fctName));
+            throw;
+        }
+    }
+    return *fct;
+}
+
+uintptr_t TieredProgram::getFctPtr(std::string_view fctName) const {
+    return isOptimized() ? d_optimized->getFctPtr(fctName) : d_baseline.getFctPtr(fctName);
+}
+
+void TieredProgram::optimize() {
+    {
+        std::lock_guard<std::mutex> lock(d_optimizationMutex);
+        if (d_optimizationStarted || !d_baseline) {
+            return;
+        }
+        d_optimizationStarted = true;
+    }
+    d_optimizer.submit(d_source, [this](std::future<CompileResult> future) {
+        try {
+            CompileResult result = future.get();
+            // Contexts created for the baseline are only compatible with the same layout.
+            if (result && result.getContextSize() == d_baseline.getContextSize()) {
+                swapToOptimized(std::make_unique<CompileResult>(std::move(result)));
+            }
+        } catch (...) {
+            // Keep using the baseline.
+        }
+        // Notify while holding the lock, as the program may be destructed right after.
+        std::lock_guard<std::mutex> lock(d_optimizationMutex);
+        d_optimizationDone = true;
+        d_optimizationCond.notify_all();
+    });
+}
+
+void TieredProgram::waitOptimized() {
+    std::unique_lock<std::mutex> lock(d_optimizationMutex);
+    d_optimizationCond.wait(lock, [this] { return !d_optimizationStarted || d_optimizationDone; });
+}
+
+void TieredProgram::swapToOptimized(std::unique_ptr<CompileResult> optimized) {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_optimized = std::move(optimized);
+    for (auto& [name, fct] : d_fcts) {
+        fct->d_fctPtr.store(d_optimized->getFctPtr(name), std::memory_order_release);
+    }
+    d_isOptimized.store(true, std::memory_order_release);
+}
+
+} // namespace jex
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <jex_backend.hpp>
+#include <jex_base.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace jex {
+
+class CompileService;
+class TieredProgram;
+
+/**
+ * Handle to a function of a TieredProgram. It always points to the fastest version compiled so
+ * far and counts its calls to detect hot programs.
+ */
+class TieredFct : NoCopy {
+    friend class TieredProgram;
+
+    TieredProgram& d_program;
+    std::atomic<uintptr_t> d_fctPtr;
+    std::atomic<size_t> d_callCount{0};
+
+public:
+    TieredFct(TieredProgram& program, uintptr_t fctPtr)
+    : d_program(program)
+    , d_fctPtr(fctPtr) {
+    }
+
+    /**
+     * Returns the function pointer to be called. Every call is counted until the program becomes
+     * hot.
+     */
+    uintptr_t getFctPtr();
+
+    size_t getCallCount() const {
+        return d_callCount.load(std::memory_order_relaxed);
+    }
+};
+
+/**
+ * Program compiled without optimizations for a fast start and recompiled with the compile
+ * service's optimization level in the background once one of its functions got called
+ * hotThreshold times. The function pointers of all handles are then swapped to the optimized
+ * code, so that running evaluations aren't interrupted.
+ * The whole program is recompiled, as all functions share the context layout. Both versions use
+ * the same layout, so contexts created for the program stay valid.
+ * All member functions are thread-safe.
+ */
+class TieredProgram : NoCopy {
+    friend class TieredFct;
+
+    std::string d_source;
+    CompileService& d_optimizer;
+    const size_t d_hotThreshold;
+    CompileResult d_baseline;
+    // Written once by the optimization thread before the handles are swapped.
+    std::unique_ptr<CompileResult> d_optimized;
+    std::atomic<bool> d_isOptimized{false};
+    std::mutex d_mutex;
+    std::unordered_map<std::string, std::unique_ptr<TieredFct>> d_fcts;
+    // Guards the state of the optimization, which runs as a callback on the compile service.
+    std::mutex d_optimizationMutex;
+    std::condition_variable d_optimizationCond;
+    bool d_optimizationStarted = false;
+    bool d_optimizationDone = false;
+
+public:
+    /**
+     * Compiles the baseline synchronously. The environment and options of the compile service
+     * are used for both tiers.
+     */
+    TieredProgram(std::string source, CompileService& optimizer, size_t hotThreshold = 1000);
+    /**
+     * Waits for a running optimization to finish.
+     */
+    ~TieredProgram();
+
+    /**
+     * Returns false if the program has compile errors.
+     */
+    explicit operator bool() const {
+        return static_cast<bool>(d_baseline);
+    }
+
+    const CompileResult& getBaseline() const {
+        return d_baseline;
+    }
+
+    /**
+     * Returns the handle of the given function. Throws if the function doesn't exist.
+     */
+    TieredFct& getFct(std::string_view fctName);
+
+    /**
+     * Returns the fastest available version of the function without counting the call.
+     */
+    uintptr_t getFctPtr(std::string_view fctName) const;
+
+    size_t getContextSize() const {
+        return d_baseline.getContextSize();
+    }
+    size_t getContextAlignment() const {
+        return d_baseline.getContextAlignment();
+    }
+    const std::vector<ContextSlotDesc>& getContextSlots() const {
+        return d_baseline.getContextSlots();
+    }
+    const std::vector<ContextSlotDesc>& getInputRecord() const {
+        return d_baseline.getInputRecord();
+    }
+
+    /**
+     * Starts the optimization if it wasn't started yet.
+     */
+    void optimize();
+    bool isOptimized() const {
+        return d_isOptimized.load(std::memory_order_acquire);
+    }
+    /**
+     * Waits until the optimization finished if it was started.
+     */
+    void waitOptimized();
+
+private:
+    void swapToOptimized(std::unique_ptr<CompileResult> optimized);
+};
+
+inline uintptr_t TieredFct::getFctPtr() {
+    if (d_callCount.load(std::memory_order_relaxed) < d_program.d_hotThreshold &&
+        d_callCount.fetch_add(1, std::memory_order_relaxed) + 1 == d_program.d_hotThreshold) {
+        d_program.optimize();
+    }
+    return d_fctPtr.load(std::memory_order_acquire);
+}
+
+} // namespace jex
@@ -3,15 +3,27 @@
 #include <jex_builtins.hpp>
 #include <jex_errorhandling.hpp>
 #include <jex_executioncontext.hpp>
+#include <jex_jitsession.hpp>
+
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
 
 #include <gtest/gtest.h>
 
+#include <string>
+#include <string_view>
+#include <vector>
+
 namespace jex {
 
 static void max3(int64_t* res, int64_t a, int64_t b, int64_t c) {
     *res = std::max({a, b, c});
 }
 
+static void min3(int64_t* res, int64_t a, int64_t b, int64_t c) {
+    *res = std::min({a, b, c});
+}
+
 namespace {
 class TestModule : public Module {
     void registerTypes(Registry& registry) const override {}
@@ -19,6 +31,14 @@ class TestModule : public Module {
         registry.registerFct(FctDesc<ArgInteger, ArgInteger, ArgInteger, ArgInteger>("max3", max3));
     }
 };
+
+// Registers a different function under the same name as TestModule.
+class ClashingTestModule : public Module {
+    void registerTypes(Registry& registry) const override {}
+    void registerFcts(Registry& registry) const override {
+        registry.registerFct(FctDesc<ArgInteger, ArgInteger, ArgInteger, ArgInteger>("max3", min3));
+    }
+};
 }
 
 TEST(Backend, simpleVarDef) {
@@ -188,6 +208,21 @@ TEST(Backend, varDef) {
     ASSERT_EQ(18, *fctC(ctx->getDataPtr()));
 }
 
+TEST(Backend, largeContext) {
+    // Initializing a large context gets optimized into a call to memset.
+    Environment env;
+    env.addModule(BuiltInsModule());
+    std::string source;
+    for (int i = 0; i < 64; ++i) {
+        source += "var v" + std::to_string(i) + " : Integer;\n";
+    }
+    source += "expr a : Integer = v0 + v63;";
+    CompileResult compiled = compile(env, source.c_str(), OptLevel::O3);
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(compiled);
+    auto fctA = reinterpret_cast<int64_t* (*)(char*)>(compiled.getFctPtr("a"));
+    ASSERT_EQ(0, *fctA(ctx->getDataPtr()));
+}
+
 TEST(Backend, varDefComplexType) {
     Environment env;
     env.addModule(BuiltInsModule());
@@ -208,4 +243,253 @@ TEST(Backend, varDefComplexType) {
     ASSERT_EQ("7890", *fctB(ctx->getDataPtr()));
 }
 
+TEST(Backend, varDefStringView) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileResult compiled = compile(env,
+        "var s : StringView;"
+        "expr b : StringView = substr(s, 6, 5);"
+        "expr c : Bool = (b == \"World\") & (\"Hello\" < s);"
+        "expr d : String = join(\"-\", b, s);"
+        "expr e : String = String(b);", OptLevel::O1);
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(compiled);
+    auto storeS = reinterpret_cast<void(*)(char*, const std::string_view*)>(compiled.getFctPtr("s"));
+    auto fctB = reinterpret_cast<std::string_view* (*)(char*)>(compiled.getFctPtr("b"));
+    auto fctC = reinterpret_cast<bool* (*)(char*)>(compiled.getFctPtr("c"));
+    auto fctD = reinterpret_cast<std::string* (*)(char*)>(compiled.getFctPtr("d"));
+    auto fctE = reinterpret_cast<std::string* (*)(char*)>(compiled.getFctPtr("e"));
+    // The zero-initialized view is empty.
+    ASSERT_EQ("", *fctE(ctx->getDataPtr()));
+    char buffer[] = "Hello World";
+    std::string_view view(buffer);
+    storeS(ctx->getDataPtr(), &view);
+    // The result views into the buffer without copying it.
+    ASSERT_EQ(buffer + 6, fctB(ctx->getDataPtr())->data());
+    ASSERT_EQ("World", *fctB(ctx->getDataPtr()));
+    ASSERT_TRUE(*fctC(ctx->getDataPtr()));
+    ASSERT_EQ("World-Hello World", *fctD(ctx->getDataPtr()));
+    ASSERT_EQ("World", *fctE(ctx->getDataPtr()));
+    // Repeat.
+    view = "1234567890";
+    storeS(ctx->getDataPtr(), &view);
+    ASSERT_EQ("7890", *fctB(ctx->getDataPtr()));
+    ASSERT_FALSE(*fctC(ctx->getDataPtr()));
+    ASSERT_EQ("7890", *fctE(ctx->getDataPtr()));
+}
+
+TEST(Backend, sharedSession) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    auto session = std::make_shared<JitSession>();
+    auto compileWithSession = [&](const char* source) {
+        CompileEnv compileEnv(env);
+        Parser parser(compileEnv, source);
+        parser.parse();
+        TypeInference typeInference(compileEnv);
+        typeInference.run();
+        CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
+        codeGen.createIR();
+        Backend backend(compileEnv, session);
+        return backend.jit(codeGen.releaseModule());
+    };
+    auto evalA = [](const CompileResult& compiled) {
+        std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(compiled);
+        auto fctA = reinterpret_cast<int64_t* (*)(char*)>(compiled.getFctPtr("a"));
+        return *fctA(ctx->getDataPtr());
+    };
+    // Programs in the same session may define the same symbols.
+    CompileResult compiled1 = compileWithSession("expr a : Integer = 1 + 2;");
+    {
+        CompileResult compiled2 = compileWithSession("expr a : Integer = 3 * 4;");
+        ASSERT_EQ(3, evalA(compiled1));
+        ASSERT_EQ(12, evalA(compiled2));
+        ASSERT_GT(compiled2.getMemoryUsage().d_codeBytes, 0);
+    }
+    // Releasing a program doesn't affect other programs and its library gets reused.
+    ASSERT_EQ(3, evalA(compiled1));
+    CompileResult compiled3 = compileWithSession("expr a : Integer = 5 - 6;");
+    // The memory of the released program isn't accounted to the reused library any more.
+    ASSERT_EQ(0, compiled3.getMemoryUsage().d_codeBytes);
+    ASSERT_EQ(-1, evalA(compiled3));
+    ASSERT_EQ(3, evalA(compiled1));
+    // Moved-from results are invalid.
+    CompileResult moved(std::move(compiled3));
+    ASSERT_FALSE(compiled3); // NOLINT(bugprone-use-after-move)
+    ASSERT_EQ(-1, evalA(moved));
+}
+
+TEST(Backend, failedFctDefinition) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    env.addModule(TestModule());
+    const FctInfo* max3Fct = nullptr;
+    for (const auto& [name, fcts] : env.fctLib()) {
+        max3Fct = name == "max3" ? fcts.front() : max3Fct;
+    }
+    ASSERT_NE(nullptr, max3Fct);
+    JitSession session;
+    // Define the symbol behind the session's back, so that defining it again fails.
+    llvm::orc::JITDylib* fctLib = session.jit().getJITDylibByName("__fcts");
+    ASSERT_NE(nullptr, fctLib);
+    llvm::orc::SymbolMap symbols;
+    symbols.insert(std::make_pair(session.jit().getExecutionSession().intern(max3Fct->d_mangledName),
+                                  llvm::JITEvaluatedSymbol::fromPointer(max3Fct->d_fctPtr)));
+    ASSERT_FALSE(fctLib->define(llvm::orc::absoluteSymbols(std::move(symbols))));
+    ASSERT_THROW(session.defineFcts({max3Fct}), InternalError);
+    // The failed symbol isn't recorded as defined, so it isn't skipped silently.
+    ASSERT_THROW(session.defineFcts({max3Fct}), InternalError);
+}
+
+TEST(Backend, lazyCompilation) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    auto session = std::make_shared<JitSession>();
+    CompileEnv compileEnv(env);
+    Parser parser(compileEnv, "var s : String; var i : Integer;"
+                              "expr a : String = substr(s, 6, 5);"
+                              "expr b : Integer = i * 2 + 1;"
+                              "expr c : Integer = max(i, 3);");
+    parser.parse();
+    TypeInference typeInference(compileEnv);
+    typeInference.run();
+    CompileOptions options;
+    options.d_lazy = true;
+    CodeGen codeGen(compileEnv, options);
+    codeGen.createIR();
+    ASSERT_FALSE(codeGen.isOptimized());
+    ASSERT_EQ(OptLevel::O2, CodeGen::getLazyOptLevel(codeGen.getLlvmModule()));
+    Backend backend(compileEnv, session);
+    CompileResult compiled = backend.jit(codeGen.releaseModule());
+    // Nothing is compiled before the first call.
+    ASSERT_EQ(0, compiled.getMemoryUsage().d_codeBytes);
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(compiled);
+    auto storeS = reinterpret_cast<void(*)(char*, std::string*)>(compiled.getFctPtr("s"));
+    auto storeI = reinterpret_cast<void(*)(char*, int64_t*)>(compiled.getFctPtr("i"));
+    auto fctA = reinterpret_cast<std::string* (*)(char*)>(compiled.getFctPtr("a"));
+    auto fctB = reinterpret_cast<int64_t* (*)(char*)>(compiled.getFctPtr("b"));
+    std::string str("Hello World");
+    int64_t i = 5;
+    storeS(ctx->getDataPtr(), &str);
+    storeI(ctx->getDataPtr(), &i);
+    size_t codeBytes = compiled.getMemoryUsage().d_codeBytes;
+    ASSERT_GT(codeBytes, 0);
+    ASSERT_EQ("World", *fctA(ctx->getDataPtr()));
+    ASSERT_GT(compiled.getMemoryUsage().d_codeBytes, codeBytes);
+    codeBytes = compiled.getMemoryUsage().d_codeBytes;
+    // Further calls use the compiled function.
+    str = "1234567890";
+    storeS(ctx->getDataPtr(), &str);
+    ASSERT_EQ("7890", *fctA(ctx->getDataPtr()));
+    ASSERT_EQ(codeBytes, compiled.getMemoryUsage().d_codeBytes);
+    ASSERT_EQ(11, *fctB(ctx->getDataPtr()));
+    ASSERT_GT(compiled.getMemoryUsage().d_codeBytes, codeBytes);
+}
+
+TEST(Backend, batchFcts) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    for (bool lazy : {false, true}) {
+        CompileEnv compileEnv(env);
+        Parser parser(compileEnv, "var i : Integer; expr a : Integer = i * 2 + 1;"
+                                  "expr b : String = substr(\"Hello World\", i, 3);");
+        parser.parse();
+        TypeInference typeInference(compileEnv);
+        typeInference.run();
+        CompileOptions options;
+        options.d_batchFcts = true;
+        options.d_lazy = lazy;
+        CodeGen codeGen(compileEnv, options);
+        codeGen.createIR();
+        Backend backend(compileEnv);
+        CompileResult compiled = backend.jit(codeGen.releaseModule());
+        auto storeI = reinterpret_cast<void(*)(char*, int64_t*)>(compiled.getFctPtr("i"));
+        auto batchA = reinterpret_cast<void(*)(char**, int64_t, int64_t**)>(compiled.getFctPtr("a.batch"));
+        auto batchB = reinterpret_cast<void(*)(char**, int64_t, std::string**)>(compiled.getFctPtr("b.batch"));
+        std::vector<std::unique_ptr<ExecutionContext>> ctxs;
+        std::vector<char*> rctxs;
+        for (int64_t i = 0; i < 5; ++i) {
+            ctxs.push_back(ExecutionContext::create(compiled));
+            rctxs.push_back(ctxs.back()->getDataPtr());
+            storeI(rctxs.back(), &i);
+        }
+        std::vector<int64_t*> resultsA(rctxs.size());
+        batchA(rctxs.data(), rctxs.size(), resultsA.data());
+        std::vector<std::string*> resultsB(rctxs.size());
+        batchB(rctxs.data(), rctxs.size(), resultsB.data());
+        for (int64_t i = 0; i < 5; ++i) {
+            ASSERT_EQ(i * 2 + 1, *resultsA[i]);
+            ASSERT_EQ(std::string("Hello World").substr(i, 3), *resultsB[i]);
+        }
+        // The results are optional, an empty batch does nothing.
+        int64_t i = 10;
+        storeI(rctxs[0], &i);
+        batchA(rctxs.data(), 1, nullptr);
+        ASSERT_EQ(21, *resultsA[0]);
+        batchA(nullptr, 0, nullptr);
+    }
+}
+
+TEST(Backend, columnar) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    auto compileColumnar = [&](const char* source) {
+        CompileEnv compileEnv(env);
+        Parser parser(compileEnv, source);
+        parser.parse();
+        TypeInference typeInference(compileEnv);
+        typeInference.run();
+        CompileOptions options;
+        options.d_columnar = true;
+        CodeGen codeGen(compileEnv, options);
+        codeGen.createIR();
+        Backend backend(compileEnv);
+        return backend.jit(codeGen.releaseModule());
+    };
+    CompileResult compiled = compileColumnar(
+        "var x : Integer; var y : Float;"
+        "expr a : Float = if(x > 2, y * 2.0, y) + 1.0;"
+        "expr b : Integer = max(x, 3) * 2;"
+        "expr c : Bool = x > 1 && a < 10.0;");
+    constexpr size_t rows = 37; // Not a multiple of the vector width.
+    std::vector<int64_t> x(rows);
+    std::vector<double> y(rows);
+    std::vector<double> a(rows);
+    std::vector<int64_t> b(rows);
+    std::unique_ptr<bool[]> c(new bool[rows]);
+    for (size_t i = 0; i < rows; ++i) {
+        x[i] = static_cast<int64_t>(i);
+        y[i] = 0.5 * static_cast<double>(i);
+    }
+    void* columns[] = {x.data(), y.data(), a.data(), b.data(), c.get()};
+    auto evalColumns = reinterpret_cast<void(*)(void**, int64_t)>(compiled.getFctPtr("__eval_columns"));
+    evalColumns(columns, rows);
+    for (size_t i = 0; i < rows; ++i) {
+        ASSERT_EQ((x[i] > 2 ? y[i] * 2.0 : y[i]) + 1.0, a[i]);
+        ASSERT_EQ(std::max<int64_t>(x[i], 3) * 2, b[i]);
+        ASSERT_EQ(x[i] > 1 && a[i] < 10.0, c[i]);
+    }
+    evalColumns(nullptr, 0);
+    // Columns of complex types aren't supported.
+    ASSERT_THROW(compileColumnar("var s : String; expr a : Integer = 1;"), InternalError);
+}
+
+TEST(Backend, clashingFctNames) {
+    Environment env1;
+    env1.addModule(BuiltInsModule());
+    env1.addModule(TestModule());
+    Environment env2;
+    env2.addModule(BuiltInsModule());
+    env2.addModule(ClashingTestModule());
+    const char* source = "expr a : Integer = max3(1, 7, 4);";
+    CompileResult compiled1 = compile(env1, source, OptLevel::O0);
+    CompileResult compiled2 = compile(env2, source, OptLevel::O0);
+    // Both programs use their own environment's function.
+    std::unique_ptr<ExecutionContext> ctx1 = ExecutionContext::create(compiled1);
+    std::unique_ptr<ExecutionContext> ctx2 = ExecutionContext::create(compiled2);
+    auto fctA1 = reinterpret_cast<int64_t* (*)(char*)>(compiled1.getFctPtr("a"));
+    auto fctA2 = reinterpret_cast<int64_t* (*)(char*)>(compiled2.getFctPtr("a"));
+    ASSERT_EQ(7, *fctA1(ctx1->getDataPtr()));
+    ASSERT_EQ(1, *fctA2(ctx2->getDataPtr()));
+}
+
 } // namespace jex
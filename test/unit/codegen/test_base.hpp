@@ -28,7 +28,7 @@ static inline CompileResult compile(const Environment& env,
     typeInference.run();
     ConstantFolding constFolding(compileEnv, runConstFolding);
     constFolding.run();
-    CodeGen codeGen(compileEnv, op);
+    CodeGen codeGen(compileEnv, CompileOptions{op});
     codeGen.createIR();
     Backend backend(compileEnv);
     return backend.jit(codeGen.releaseModule());
@@ -64,7 +64,7 @@ TEST(Codegen, empty) {
     parser.parse();
     TypeInference typeInference(compileEnv);
     typeInference.run();
-    CodeGen codeGen(compileEnv, OptLevel::O0);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
     codeGen.createIR();
     // print module
     std::string result;
@@ -99,7 +99,7 @@ TEST(Codegen, simpleVarDef) {
     parser.parse();
     TypeInference typeInference(compileEnv);
     typeInference.run();
-    CodeGen codeGen(compileEnv, OptLevel::O0);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
     codeGen.createIR();
     // print module
     std::string result;
@@ -165,7 +165,7 @@ TEST(Codegen, operatorCall) {
     parser.parse();
     TypeInference typeInference(compileEnv);
     typeInference.run();
-    CodeGen codeGen(compileEnv, OptLevel::O0);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
     codeGen.createIR();
     // print module
     std::string result;
@@ -225,7 +225,7 @@ TEST(Codegen, operatorCallNoIntrinsic) {
     parser.parse();
     TypeInference typeInference(compileEnv);
     typeInference.run();
-    CodeGen codeGen(compileEnv, OptLevel::O0);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
     codeGen.createIR();
     // print module
     std::string result;
@@ -280,7 +280,7 @@ TEST(Codegen, operatorCallOptimized) {
     parser.parse();
     TypeInference typeInference(compileEnv);
     typeInference.run();
-    CodeGen codeGen(compileEnv, OptLevel::O3);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O3});
     codeGen.createIR();
     // print module
     std::string result;
@@ -330,7 +330,7 @@ TEST(Codegen, ifExpression) {
     parser.parse();
     TypeInference typeInference(compileEnv);
     typeInference.run();
-    CodeGen codeGen(compileEnv, OptLevel::O0);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
     codeGen.createIR();
     // print module
     std::string result;
@@ -403,7 +403,7 @@ TEST(Codegen, stringLiteral) {
     parser.parse();
     TypeInference typeInference(compileEnv);
     typeInference.run();
-    CodeGen codeGen(compileEnv, OptLevel::O0);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
     codeGen.createIR();
     // print module
     std::string result;
@@ -466,7 +466,7 @@ TEST(Codegen, stringExpression) {
     parser.parse();
     TypeInference typeInference(compileEnv);
     typeInference.run();
-    CodeGen codeGen(compileEnv, OptLevel::O0);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
     codeGen.createIR();
     // print module
     std::string result;
@@ -493,7 +493,7 @@ begin:                                            ; preds = %entry
   %rctxAsBytePtr = bitcast %Rctx* %rctx to i8*
   %varPtr = getelementptr i8, i8* %rctxAsBytePtr, i64 0
   %varPtrTyped = bitcast i8* %varPtr to %String*
-  call void @__assign_String(%String* %varPtrTyped, %String* %res_substr1)
+  call void @__moveAssign_String(%String* %varPtrTyped, %String* %res_substr1)
   br label %unwind
 
 unwind:                                           ; preds = %begin
@@ -506,7 +506,7 @@ declare void @_substr_String_Integer_Integer(%String*, %String*, i64, i64)
 
 declare void @__dtor_String(%String*)
 
-declare void @__assign_String(%String*, %String*)
+declare void @__moveAssign_String(%String*, %String*)
 
 define void @__init_rctx(%Rctx* %rctx) {
 entry:
@@ -540,7 +540,7 @@ TEST(Codegen, unwindingIfExpression) {
     parser.parse();
     TypeInference typeInference(compileEnv);
     typeInference.run();
-    CodeGen codeGen(compileEnv, OptLevel::O0);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
     codeGen.createIR();
     // print module
     std::string result;
@@ -647,7 +647,7 @@ TEST(Codegen, constFoldedValue) {
     typeInference.run();
     ConstantFolding constFolding(compileEnv, true);
     constFolding.run();
-    CodeGen codeGen(compileEnv, OptLevel::O0);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
     codeGen.createIR();
     // print module
     std::string result;
@@ -681,7 +681,7 @@ TEST(Codegen, constFoldedStruct) {
     typeInference.run();
     ConstantFolding constFolding(compileEnv, true);
     constFolding.run();
-    CodeGen codeGen(compileEnv, OptLevel::O0);
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O0});
     codeGen.createIR();
     // print module
     std::string result;
@@ -0,0 +1,192 @@
+#include <test_base.hpp>
+
+#include <jex_builtins.hpp>
+#include <jex_diskobjectcache.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_jitsession.hpp>
+
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+
+namespace jex {
+
+namespace {
+
+struct CachedCompile {
+    CompileResult d_result;
+    bool d_optimized;
+    std::string d_key;
+};
+
+CachedCompile compileCached(const Environment& env, const char* source, std::shared_ptr<JitSession> session,
+                            const std::function<void(const std::string& key)>& beforeJit = nullptr) {
+    CompileEnv compileEnv(env);
+    Parser parser(compileEnv, source);
+    parser.parse();
+    TypeInference typeInference(compileEnv);
+    typeInference.run();
+    std::unique_ptr<llvm::TargetMachine> targetMachine = session->createTargetMachine();
+    CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O2}, targetMachine.get(), session->getObjectCache());
+    codeGen.createIR();
+    bool optimized = codeGen.isOptimized();
+    std::string key = codeGen.getLlvmModule().getModuleIdentifier();
+    if (beforeJit) {
+        beforeJit(key);
+    }
+    Backend backend(compileEnv, std::move(session));
+    return CachedCompile{backend.jit(codeGen.releaseModule()), optimized, std::move(key)};
+}
+
+int64_t evalA(const CompileResult& compiled) {
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(compiled);
+    auto fctA = reinterpret_cast<int64_t* (*)(char*)>(compiled.getFctPtr("a"));
+    return *fctA(ctx->getDataPtr());
+}
+
+} // anonymous namespace
+
+TEST(DiskObjectCache, reuseAcrossSessions) {
+    llvm::SmallString<128> dir;
+    ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("jex-objcache", dir));
+    CompileOptions options;
+    options.d_objectCacheDir = std::string(dir.str());
+    Environment env;
+    env.addModule(BuiltInsModule());
+    const char* source = "expr a : Integer = 6 * 7 + 0;";
+    std::string path;
+    {
+        auto session = std::make_shared<JitSession>(options);
+        CachedCompile compiled = compileCached(env, source, session);
+        ASSERT_TRUE(compiled.d_optimized);
+        ASSERT_EQ(42, evalA(compiled.d_result));
+        DiskObjectCache& cache = *session->getObjectCache();
+        ASSERT_EQ(0, cache.getHitCount());
+        ASSERT_EQ(1, cache.getStoreCount());
+        path = cache.getPath(compiled.d_key);
+        ASSERT_TRUE(llvm::sys::fs::exists(path));
+    }
+    {
+        // A new session (e.g. after a restart) loads the object and skips the optimization.
+        auto session = std::make_shared<JitSession>(options);
+        CachedCompile compiled = compileCached(env, source, session);
+        ASSERT_FALSE(compiled.d_optimized);
+        ASSERT_EQ(42, evalA(compiled.d_result));
+        ASSERT_EQ(1, session->getObjectCache()->getHitCount());
+        ASSERT_EQ(0, session->getObjectCache()->getStoreCount());
+    }
+    {
+        // Corrupted entries are detected and replaced.
+        auto buffer = llvm::MemoryBuffer::getFile(path);
+        ASSERT_TRUE(buffer);
+        std::string content = (*buffer)->getBuffer().str();
+        content.back() ^= 0xff;
+        std::error_code err;
+        llvm::raw_fd_ostream out(path, err);
+        ASSERT_FALSE(err);
+        out << content;
+        out.close();
+        auto session = std::make_shared<JitSession>(options);
+        CachedCompile compiled = compileCached(env, source, session);
+        ASSERT_TRUE(compiled.d_optimized);
+        ASSERT_EQ(42, evalA(compiled.d_result));
+        ASSERT_EQ(1, session->getObjectCache()->getInvalidCount());
+        ASSERT_EQ(1, session->getObjectCache()->getStoreCount());
+    }
+    {
+        // Different programs get different entries.
+        auto session = std::make_shared<JitSession>(options);
+        CachedCompile compiled = compileCached(env, "expr a : Integer = 6 * 7 + 1;", session);
+        ASSERT_TRUE(compiled.d_optimized);
+        ASSERT_EQ(43, evalA(compiled.d_result));
+        ASSERT_NE(path, session->getObjectCache()->getPath(compiled.d_key));
+    }
+    llvm::sys::fs::remove_directories(dir);
+}
+
+TEST(DiskObjectCache, entryRemovedAfterPrefetch) {
+    llvm::SmallString<128> dir;
+    ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("jex-objcache", dir));
+    CompileOptions options;
+    options.d_objectCacheDir = std::string(dir.str());
+    Environment env;
+    env.addModule(BuiltInsModule());
+    const char* source = "expr a : Integer = 6 * 7 + 0;";
+    // Materializing the program stores its object.
+    ASSERT_EQ(42, evalA(compileCached(env, source, std::make_shared<JitSession>(options)).d_result));
+    // The entry disappears (e.g. removed by another process) after the optimization was skipped.
+    // The prefetched object is used and nothing is stored for the unoptimized module.
+    auto session = std::make_shared<JitSession>(options);
+    CachedCompile compiled = compileCached(env, source, session, [&](const std::string& key) {
+        ASSERT_FALSE(llvm::sys::fs::remove(session->getObjectCache()->getPath(key)));
+    });
+    ASSERT_FALSE(compiled.d_optimized);
+    ASSERT_EQ(42, evalA(compiled.d_result));
+    ASSERT_EQ(1, session->getObjectCache()->getHitCount());
+    ASSERT_EQ(0, session->getObjectCache()->getStoreCount());
+    llvm::sys::fs::remove_directories(dir);
+}
+
+TEST(DiskObjectCache, onlyStoresCacheableModules) {
+    llvm::SmallString<128> dir;
+    ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("jex-objcache", dir));
+    DiskObjectCache cache(std::string(dir.str()), "x86_64-unknown-linux-gnu", "generic");
+    llvm::LLVMContext ctx;
+    llvm::Module module("", ctx);
+    module.setModuleIdentifier(cache.computeKey(module, OptLevel::O2, 0));
+    llvm::MemoryBufferRef object("object", "object");
+    cache.notifyObjectCompiled(&module, object);
+    ASSERT_EQ(0, cache.getStoreCount());
+    ASSERT_FALSE(cache.prefetch(module));
+    DiskObjectCache::markCacheable(module);
+    cache.notifyObjectCompiled(&module, object);
+    ASSERT_EQ(1, cache.getStoreCount());
+    ASSERT_TRUE(cache.prefetch(module));
+    ASSERT_EQ("object", cache.takeObject(module)->getBuffer());
+    // Objects are only handed out once per prefetch.
+    ASSERT_EQ(nullptr, cache.takeObject(module));
+    ASSERT_EQ(0, cache.getPrefetchedCount());
+    llvm::sys::fs::remove_directories(dir);
+}
+
+TEST(DiskObjectCache, prefetchedObjectsReleased) {
+    llvm::SmallString<128> dir;
+    ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("jex-objcache", dir));
+    CompileOptions options;
+    options.d_objectCacheDir = std::string(dir.str());
+    Environment env;
+    env.addModule(BuiltInsModule());
+    const char* source = "expr a : Integer = 6 * 7 + 0;";
+    ASSERT_EQ(42, evalA(compileCached(env, source, std::make_shared<JitSession>(options)).d_result));
+    auto session = std::make_shared<JitSession>(options);
+    DiskObjectCache& cache = *session->getObjectCache();
+    // Programs which are never materialized don't keep their object in the cache.
+    compileCached(env, source, session);
+    ASSERT_EQ(1, cache.getHitCount());
+    ASSERT_EQ(0, cache.getPrefetchedCount());
+    // Neither do modules which never reach the JIT.
+    {
+        CompileEnv compileEnv(env);
+        Parser parser(compileEnv, source);
+        parser.parse();
+        TypeInference typeInference(compileEnv);
+        typeInference.run();
+        std::unique_ptr<llvm::TargetMachine> targetMachine = session->createTargetMachine();
+        CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O2}, targetMachine.get(), &cache);
+        codeGen.createIR();
+        ASSERT_FALSE(codeGen.isOptimized());
+        ASSERT_EQ(1, cache.getPrefetchedCount());
+    }
+    ASSERT_EQ(0, cache.getPrefetchedCount());
+    ASSERT_EQ(1, cache.getHitCount());
+    llvm::sys::fs::remove_directories(dir);
+}
+
+} // namespace jex
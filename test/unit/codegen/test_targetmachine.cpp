@@ -0,0 +1,61 @@
+#include <test_base.hpp>
+
+#include <jex_builtins.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_jitsession.hpp>
+#include <jex_targetmachine.hpp>
+
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Target/TargetMachine.h"
+
+#include <gtest/gtest.h>
+
+namespace jex {
+
+TEST(TargetMachine, hostCpu) {
+    llvm::orc::JITTargetMachineBuilder host = getTargetMachineBuilder("host");
+    ASSERT_EQ(llvm::sys::getHostCPUName().str(), host.getCPU());
+    ASSERT_EQ(host.getCPU(), getTargetMachineBuilder("").getCPU());
+}
+
+TEST(TargetMachine, namedCpu) {
+    llvm::orc::JITTargetMachineBuilder generic = getTargetMachineBuilder("generic");
+    ASSERT_EQ("generic", generic.getCPU());
+    // Named CPUs don't inherit the host's features.
+    ASSERT_EQ("", generic.getFeatures().getString());
+    ASSERT_THROW(getTargetMachineBuilder("no-such-cpu"), InternalError);
+}
+
+TEST(TargetMachine, compileForCpu) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    for (const char* cpu : {"host", "generic"}) {
+        CompileOptions options;
+        options.d_cpu = cpu;
+        auto session = std::make_shared<JitSession>(options);
+        std::unique_ptr<llvm::TargetMachine> targetMachine = session->createTargetMachine();
+        CompileEnv compileEnv(env);
+        Parser parser(compileEnv, "var x: Float; expr a: Float = x * 2.5 + 1.0;");
+        parser.parse();
+        TypeInference typeInference(compileEnv);
+        typeInference.run();
+        CodeGen codeGen(compileEnv, CompileOptions{OptLevel::O2}, targetMachine.get());
+        codeGen.createIR();
+        const llvm::Module& module = codeGen.getLlvmModule();
+        ASSERT_EQ(targetMachine->getTargetTriple().str(), module.getTargetTriple());
+        ASSERT_EQ(targetMachine->createDataLayout(), module.getDataLayout());
+        Backend backend(compileEnv, std::move(session));
+        CompileResult compiled = backend.jit(codeGen.releaseModule());
+        std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(compiled);
+        auto setX = reinterpret_cast<void (*)(char*, double*)>(compiled.getFctPtr("x"));
+        auto fctA = reinterpret_cast<double* (*)(char*)>(compiled.getFctPtr("a"));
+        double x = 2.0;
+        setX(ctx->getDataPtr(), &x);
+        ASSERT_DOUBLE_EQ(6.0, *fctA(ctx->getDataPtr()));
+    }
+}
+
+} // namespace jex
@@ -0,0 +1,179 @@
+#include <test_base.hpp>
+
+#include <jex_contextheader.hpp>
+#include <jex_contextlayout.hpp>
+#include <jex_environment.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_symboltable.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace jex {
+
+namespace {
+class ContextLayoutTest : public ::testing::Test {
+protected:
+    Environment d_env;
+    std::vector<Symbol> d_symbols;
+
+    void SetUp() override {
+        test::registerBuiltIns(d_env);
+        d_symbols.reserve(5);
+        addSymbol("s", "String");
+        addSymbol("b", "Bool");
+        addSymbol("x", "Integer");
+        addSymbol("a", "Integer");
+        addSymbol("t", "String");
+    }
+
+    void addSymbol(std::string_view name, std::string_view type) {
+        d_symbols.emplace_back(Symbol::Kind::Variable, name, d_env.types().getType(type), nullptr);
+    }
+
+    std::vector<const Symbol*> getSymbols() const {
+        std::vector<const Symbol*> symbols;
+        for (const Symbol& sym : d_symbols) {
+            symbols.push_back(&sym);
+        }
+        return symbols;
+    }
+
+    static std::string getOrder(const ContextLayout& layout) {
+        std::string order;
+        for (const ContextLayout::Slot& slot : layout.getSlots()) {
+            order += order.empty() ? "" : " ";
+            order += std::string(slot.d_symbol->name) + "@" + std::to_string(slot.d_offset);
+            order += slot.d_hot ? "" : "(cold)";
+        }
+        return order;
+    }
+};
+} // namespace
+
+TEST_F(ContextLayoutTest, packed) {
+    ContextLayout layout(getSymbols(), ContextLayoutOptions());
+    // Ordered by alignment, then name.
+    ASSERT_EQ("a@0 s@8 t@40 x@72 b@80", getOrder(layout));
+    ASSERT_EQ(8, layout.getOffset(&d_symbols[0]));
+    ASSERT_EQ(81, layout.getContextSize());
+    ASSERT_EQ(alignof(std::max_align_t), layout.getContextAlignment());
+}
+
+TEST_F(ContextLayoutTest, hotReserve) {
+    // Without splitting, the reserved block is placed behind all slots.
+    ContextLayout layout(getSymbols(), ContextLayoutOptions(), 4);
+    ASSERT_EQ("a@0 s@8 t@40 x@72 b@80", getOrder(layout));
+    ASSERT_EQ(88, layout.getHotReserveOffset());
+    ASSERT_EQ(92, layout.getContextSize());
+}
+
+TEST_F(ContextLayoutTest, hotCold) {
+    ContextLayoutOptions options;
+    options.d_splitHotCold = true;
+    ContextLayout layout(getSymbols(), options);
+    // Value slots in front of complex ones.
+    ASSERT_EQ("a@0 x@8 b@16 s@24 t@56", getOrder(layout));
+    ASSERT_EQ(88, layout.getContextSize());
+}
+
+TEST_F(ContextLayoutTest, cacheLines) {
+    ContextLayoutOptions options;
+    options.d_splitHotCold = true;
+    options.d_cacheLineSize = 64;
+    options.d_accessCounts = {{"x", 100}, {"t", 5}, {"b", 10}};
+    ContextLayout layout(getSymbols(), options);
+    // Slots without accesses are cold and start on a new cache line.
+    ASSERT_EQ("x@0 b@8 t@16 a@64(cold) s@72(cold)", getOrder(layout));
+    ASSERT_EQ(128, layout.getContextSize());
+    ASSERT_EQ(64, layout.getContextAlignment());
+}
+
+TEST_F(ContextLayoutTest, cacheLineNotPowerOfTwo) {
+    ContextLayoutOptions options;
+    options.d_cacheLineSize = 48;
+    ASSERT_THROW(ContextLayout(getSymbols(), options), InternalError);
+}
+
+TEST_F(ContextLayoutTest, cacheLinesReserve) {
+    ContextLayoutOptions options;
+    options.d_splitHotCold = true;
+    options.d_cacheLineSize = 64;
+    options.d_accessCounts = {{"x", 100}, {"t", 5}, {"b", 10}};
+    ContextLayout layout(getSymbols(), options, 8);
+    // The reserved block stays in the hot part behind the values.
+    ASSERT_EQ("x@0 b@8 t@24 a@64(cold) s@72(cold)", getOrder(layout));
+    ASSERT_EQ(16, layout.getHotReserveOffset());
+    ASSERT_EQ(128, layout.getContextSize());
+}
+
+TEST_F(ContextLayoutTest, cacheLinesWithoutProfile) {
+    ContextLayoutOptions options;
+    options.d_splitHotCold = true;
+    options.d_cacheLineSize = 64;
+    ContextLayout layout(getSymbols(), options, 8);
+    // The complex slots start on a new cache line.
+    ASSERT_EQ("a@0 x@8 b@16 s@64 t@96", getOrder(layout));
+    ASSERT_EQ(24, layout.getHotReserveOffset());
+    ASSERT_EQ(128, layout.getContextSize());
+}
+
+TEST(ContextHeader, write) {
+    std::vector<ContextSlotDesc> slots = {
+        {"x", "Integer", ContextSlotDesc::Kind::Var, TypeKind::Value, 0, 8, 8},
+        {"s", "String", ContextSlotDesc::Kind::Expr, TypeKind::Complex, 8, 32, 8},
+        {"o", "Opaque", ContextSlotDesc::Kind::Var, TypeKind::Value, 40, 4, 4},
+    };
+    std::vector<ContextSlotDesc> inputRecord = {
+        {"o", "Opaque", ContextSlotDesc::Kind::Var, TypeKind::Value, 0, 4, 4},
+        {"x", "Integer", ContextSlotDesc::Kind::Var, TypeKind::Value, 8, 8, 8},
+    };
+    std::stringstream out;
+    writeContextHeader(out, slots, 48, inputRecord);
+    std::string header = out.str();
+    ASSERT_NE(std::string::npos, header.find("constexpr std::size_t contextSize = 48;\n"));
+    ASSERT_NE(std::string::npos, header.find("constexpr std::size_t s = 8;\n"));
+    ASSERT_NE(std::string::npos, header.find(
+        "// var x : Integer\n"
+        "inline std::int64_t& x(char* rctx) {\n"
+        "    return *reinterpret_cast<std::int64_t*>(rctx + offsets::x);\n"
+        "}\n"));
+    ASSERT_NE(std::string::npos, header.find("// expr s : String\ninline std::string& s(char* rctx) {\n"));
+    // Types unknown to the header are accessed untyped.
+    ASSERT_NE(std::string::npos, header.find("inline void* o(char* rctx) {\n    return rctx + offsets::o;\n"));
+    ASSERT_NE(std::string::npos, header.find(
+        "struct Input {\n"
+        "    alignas(4) unsigned char o[4];\n"
+        "    std::int64_t x;\n"
+        "};\n"
+        "static_assert(offsetof(Input, o) == 0);\n"
+        "static_assert(offsetof(Input, x) == 8);\n"));
+}
+
+TEST(ContextHeader, escapeNames) {
+    std::vector<ContextSlotDesc> slots = {
+        {"int", "Integer", ContextSlotDesc::Kind::Var, TypeKind::Value, 0, 8, 8},
+        {"int_", "Integer", ContextSlotDesc::Kind::Var, TypeKind::Value, 8, 8, 8},
+        {"offsets", "Integer", ContextSlotDesc::Kind::Expr, TypeKind::Value, 16, 8, 8},
+    };
+    std::vector<ContextSlotDesc> inputRecord = {
+        {"Input", "Integer", ContextSlotDesc::Kind::Var, TypeKind::Value, 0, 8, 8},
+    };
+    std::stringstream out;
+    writeContextHeader(out, slots, 24, inputRecord);
+    std::string header = out.str();
+    ASSERT_NE(std::string::npos, header.find("constexpr std::size_t int_ = 0;\n"));
+    ASSERT_NE(std::string::npos, header.find("constexpr std::size_t int__ = 8;\n"));
+    ASSERT_NE(std::string::npos, header.find(
+        "// expr offsets : Integer\n"
+        "inline std::int64_t& offsets_(char* rctx) {\n"
+        "    return *reinterpret_cast<std::int64_t*>(rctx + offsets::offsets_);\n"));
+    ASSERT_NE(std::string::npos, header.find("    std::int64_t Input_;\n"));
+    ASSERT_NE(std::string::npos, header.find("static_assert(offsetof(Input, Input_) == 0);\n"));
+}
+
+} // namespace jex
@@ -0,0 +1,87 @@
+#include <test_base.hpp>
+
+#include <jex_ast.hpp>
+#include <jex_compileenv.hpp>
+#include <jex_dependencygraph.hpp>
+#include <jex_environment.hpp>
+#include <jex_parser.hpp>
+#include <jex_typeinference.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace jex {
+
+static std::string getNames(const std::vector<const AstVariableDef*>& exprs) {
+    std::string names;
+    for (const AstVariableDef* expr : exprs) {
+        names += names.empty() ? "" : " ";
+        names += expr->d_name->d_name;
+    }
+    return names;
+}
+
+TEST(DependencyGraph, evaluationOrder) {
+    Environment env;
+    test::registerBuiltIns(env);
+    CompileEnv compileEnv(env, false);
+    Parser parser(compileEnv,
+        "var x : Integer;\n"
+        "expr a : Integer = x + 1;\n"
+        "const c : Integer = 2;\n"
+        "expr b : Integer = a * c + a;\n"
+        "expr d : Integer = x;\n"
+        "expr e : Integer = b + d + e;\n");
+    parser.parse();
+    TypeInference typeInference(compileEnv);
+    typeInference.run();
+    DependencyGraph graph(*compileEnv.getRoot());
+    ASSERT_EQ("a b d e", getNames(graph.getExprs()));
+    const AstVariableDef* a = graph.findExpr("a");
+    const AstVariableDef* b = graph.findExpr("b");
+    const AstVariableDef* d = graph.findExpr("d");
+    const AstVariableDef* e = graph.findExpr("e");
+    ASSERT_NE(nullptr, e);
+    ASSERT_EQ(nullptr, graph.findExpr("x"));
+    ASSERT_EQ(nullptr, graph.findExpr("c"));
+    // Vars, constants and self-references aren't dependencies.
+    ASSERT_EQ("", getNames(graph.getDependencies(a)));
+    ASSERT_EQ("a", getNames(graph.getDependencies(b)));
+    ASSERT_EQ("b d", getNames(graph.getDependencies(e)));
+    ASSERT_EQ("a b d e", getNames(graph.getEvaluationOrder()));
+    // Subsets contain the transitive dependencies independent of the order of the outputs.
+    ASSERT_EQ("a b", getNames(graph.getEvaluationOrder({b})));
+    ASSERT_EQ("a b d", getNames(graph.getEvaluationOrder({d, b})));
+    ASSERT_EQ("a b d e", getNames(graph.getEvaluationOrder({e})));
+    ASSERT_EQ("", getNames(graph.getEvaluationOrder({})));
+}
+
+TEST(DependencyGraph, dependents) {
+    Environment env;
+    test::registerBuiltIns(env);
+    CompileEnv compileEnv(env, false);
+    Parser parser(compileEnv,
+        "var x : Integer;\n"
+        "var y : Integer;\n"
+        "var z : Integer;\n"
+        "expr a : Integer = x + 1;\n"
+        "expr b : Integer = a + y + x;\n"
+        "expr c : Integer = y;\n"
+        "expr d : Integer = b + c;\n");
+    parser.parse();
+    TypeInference typeInference(compileEnv);
+    typeInference.run();
+    DependencyGraph graph(*compileEnv.getRoot());
+    auto getDef = [&](size_t index) {
+        return compileEnv.getRoot()->d_varDefs[index];
+    };
+    ASSERT_EQ("y x", getNames(graph.getInputs(graph.findExpr("b"))));
+    ASSERT_EQ("a b d", getNames(graph.getDependents(getDef(0))));
+    ASSERT_EQ("b c d", getNames(graph.getDependents(getDef(1))));
+    ASSERT_EQ("", getNames(graph.getDependents(getDef(2))));
+    ASSERT_EQ("b d", getNames(graph.getDependents(graph.findExpr("a"))));
+}
+
+} // namespace jex
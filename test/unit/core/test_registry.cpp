@@ -191,4 +191,26 @@ TEST(Registry, registerComplexType) {
     EXPECT_TRUE((Counts{2, 1, 1, 1, 1} == counts));
 }
 
+namespace {
+class UInt32Module : public Module {
+    void registerTypes(Registry& registry) const override {
+        registry.registerType<ArgUInt32>();
+    }
+    void registerFcts(Registry& registry) const override {
+        registry.registerFct(FctDesc<ArgUInt32, ArgUInt32>("pass", pass));
+    }
+};
+}
+
+TEST(Registry, frozenEnvironment) {
+    Environment env;
+    env.addModule(UInt32Module());
+    ASSERT_FALSE(env.isFrozen());
+    env.freeze();
+    ASSERT_TRUE(env.isFrozen());
+    ASSERT_THROW(env.addModule(UInt32Module()), InternalError);
+    const Environment& constEnv = env;
+    ASSERT_EQ("UInt32", constEnv.types().getType("UInt32")->name());
+}
+
 } // namespace jex
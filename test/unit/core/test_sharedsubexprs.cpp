@@ -0,0 +1,80 @@
+#include <test_base.hpp>
+
+#include <jex_ast.hpp>
+#include <jex_compileenv.hpp>
+#include <jex_environment.hpp>
+#include <jex_parser.hpp>
+#include <jex_sharedsubexprs.hpp>
+#include <jex_typeinference.hpp>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace jex {
+
+static std::string getNames(const std::vector<const AstVariableDef*>& exprs) {
+    std::string names;
+    for (const AstVariableDef* expr : exprs) {
+        names += names.empty() ? "" : " ";
+        names += expr->d_name->d_name;
+    }
+    return names;
+}
+
+TEST(SharedSubexprs, basic) {
+    Environment env;
+    test::registerBuiltIns(env);
+    CompileEnv compileEnv(env, false);
+    Parser parser(compileEnv,
+        "var s : String;\n"
+        "var x : Integer;\n"
+        "expr a : String = substr(s, x + 1, 2);\n"
+        "expr b : String = substr(substr(s, x + 1, 2), 0, 1);\n"
+        "expr c : String = substr(s, x, 2);\n"
+        "expr d : Bool = if(getConst(true), getConst(false), getConst(false));\n"
+        "expr e : Bool = !getConst(true) && getConst(false) || getNonConst(true);\n"
+        "expr f : String = substr(s, x + 1, 2);\n");
+    parser.parse();
+    TypeInference typeInference(compileEnv);
+    typeInference.run();
+    SharedSubexprs shared(*compileEnv.getRoot());
+    // The calls in the branches of if and on the right side of && aren't shared, impure calls
+    // are never shared.
+    ASSERT_EQ(2, shared.getShared().size());
+    const SharedSubexprs::Shared& substrCall = shared.getShared()[0];
+    ASSERT_EQ(3, substrCall.d_occurrences.size());
+    ASSERT_EQ("a b f", getNames(substrCall.d_users));
+    const SharedSubexprs::Shared& getConstCall = shared.getShared()[1];
+    ASSERT_EQ(2, getConstCall.d_occurrences.size());
+    ASSERT_EQ("d e", getNames(getConstCall.d_users));
+    const std::vector<AstVariableDef*>& defs = compileEnv.getRoot()->d_varDefs;
+    ASSERT_EQ(0, shared.find(defs[2]->d_expr));
+    ASSERT_EQ(std::nullopt, shared.find(defs[4]->d_expr));
+    ASSERT_EQ(std::vector<size_t>{0}, shared.getUsed(defs[3]));
+    ASSERT_EQ(std::vector<size_t>{}, shared.getUsed(defs[4]));
+    ASSERT_EQ(std::vector<size_t>{1}, shared.getUsed(defs[6]));
+}
+
+TEST(SharedSubexprs, readsUser) {
+    Environment env;
+    test::registerBuiltIns(env);
+    CompileEnv compileEnv(env, false);
+    // The shared call would read a before and after its evaluation.
+    Parser parser(compileEnv,
+        "var s : String;\n"
+        "expr a : String = substr(a, 0, 1);\n"
+        "expr b : String = substr(a, 0, 1);\n"
+        "expr c : String = substr(s, 0, 1);\n"
+        "expr d : String = substr(c, 0, 1);\n"
+        "expr e : String = substr(c, 0, 1);\n");
+    parser.parse();
+    TypeInference typeInference(compileEnv);
+    typeInference.run();
+    SharedSubexprs shared(*compileEnv.getRoot());
+    ASSERT_EQ(1, shared.getShared().size());
+    ASSERT_EQ("d e", getNames(shared.getShared()[0].d_users));
+}
+
+} // namespace jex
@@ -0,0 +1,85 @@
+#include <jex_aotprogram.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <unistd.h>
+
+namespace jex {
+
+TEST(AotProgram, loadAndEvaluate) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    const char* source =
+        "var x : Integer;\n"
+        "var s : String;\n"
+        "expr a : Integer = x * 3 + 1;\n"
+        "expr b : String = substr(s, 1, 2);\n"
+        "expr c : String = substr(\"a long constant string\", 2, 4);\n"
+        "expr d : String = \"literal\";\n";
+    std::string libPath = testing::TempDir() + "jex_aotprogram_test.so";
+    Compiler::emitSharedLibrary(libPath, env, source, CompileOptions{OptLevel::O2});
+    {
+        std::unique_ptr<AotProgram> program = AotProgram::load(libPath, env);
+        ASSERT_THROW(AotProgram::load(libPath, env), InternalError);
+        std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(*program);
+        char* rctx = ctx->getDataPtr();
+        int64_t x = 4;
+        reinterpret_cast<void (*)(char*, int64_t*)>(program->getFctPtr("x"))(rctx, &x);
+        std::string s = "jex";
+        reinterpret_cast<void (*)(char*, std::string*)>(program->getFctPtr("s"))(rctx, &s);
+        ASSERT_EQ(13, *reinterpret_cast<int64_t* (*)(char*)>(program->getFctPtr("a"))(rctx));
+        using StrFct = std::string* (*)(char*);
+        ASSERT_EQ("ex", *reinterpret_cast<StrFct>(program->getFctPtr("b"))(rctx));
+        ASSERT_EQ("long", *reinterpret_cast<StrFct>(program->getFctPtr("c"))(rctx));
+        ASSERT_EQ("literal", *reinterpret_cast<StrFct>(program->getFctPtr("d"))(rctx));
+        ASSERT_THROW(program->getFctPtr("unknown"), InternalError);
+    }
+    // Functions missing in the environment are reported.
+    Environment emptyEnv;
+    ASSERT_THROW(AotProgram::load(libPath, emptyEnv), InternalError);
+    std::remove(libPath.c_str());
+}
+
+TEST(AotProgram, linkWithoutShell) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    const char* source = "expr a : Integer = 6 * 7;\n";
+    // Quotes and shell syntax in the file name are passed to the linker unmodified.
+    std::string marker = "jex_aotprogram_injected";
+    std::string libPath = testing::TempDir() + "jex_aot'; touch " + marker + "; '.so";
+    Compiler::emitSharedLibrary(libPath, env, source, CompileOptions{OptLevel::O0});
+    ASSERT_EQ(0, access(libPath.c_str(), F_OK));
+    ASSERT_NE(0, access(marker.c_str(), F_OK));
+    ASSERT_NE(0, access((libPath + ".o").c_str(), F_OK));
+    {
+        std::unique_ptr<AotProgram> program = AotProgram::load(libPath, env);
+        std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(*program);
+        ASSERT_EQ(42, *reinterpret_cast<int64_t* (*)(char*)>(program->getFctPtr("a"))(ctx->getDataPtr()));
+    }
+    std::remove(libPath.c_str());
+    // A failing linker is reported and the object file is removed.
+    const char* cc = std::getenv("CC");
+    std::string prevCc = cc != nullptr ? cc : "";
+    setenv("CC", "false", 1);
+    ASSERT_THROW(Compiler::emitSharedLibrary(libPath, env, source, CompileOptions{OptLevel::O0}), InternalError);
+    setenv("CC", "jex-nonexistent-linker", 1);
+    ASSERT_THROW(Compiler::emitSharedLibrary(libPath, env, source, CompileOptions{OptLevel::O0}), InternalError);
+    if (cc != nullptr) {
+        setenv("CC", prevCc.c_str(), 1);
+    } else {
+        unsetenv("CC");
+    }
+    ASSERT_NE(0, access((libPath + ".o").c_str(), F_OK));
+    ASSERT_NE(0, access(libPath.c_str(), F_OK));
+}
+
+} // namespace jex
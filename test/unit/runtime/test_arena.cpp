@@ -0,0 +1,176 @@
+#include <jex_arena.hpp>
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_parallelevaluator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jex {
+
+namespace {
+// Reverses the string into a temporary buffer taken from the arena of the calling thread.
+void isPalindrome(bool* res, const std::string* in) {
+    Arena* arena = Arena::current();
+    assert(arena != nullptr);
+    char* reversed = static_cast<char*>(arena->allocate(in->size(), 1));
+    std::reverse_copy(in->begin(), in->end(), reversed);
+    *res = std::memcmp(reversed, in->data(), in->size()) == 0;
+}
+
+class ArenaModule : public Module {
+    void registerTypes(Registry&) const override {}
+    void registerFcts(Registry& registry) const override {
+        registry.registerFct(FctDesc<ArgBool, ArgString>("isPalindrome", isPalindrome, NO_INTRINSIC, FctFlags::Pure));
+    }
+};
+
+const char* source =
+    "var s : String;\n"
+    "expr p : Bool = isPalindrome(s);\n";
+} // namespace
+
+TEST(Arena, allocate) {
+    Arena arena(64);
+    ASSERT_EQ(0, arena.getCapacity());
+    void* first = arena.allocate(8);
+    void* second = arena.allocate(1, 1);
+    void* third = arena.allocate(8, 8);
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(first) % alignof(std::max_align_t));
+    ASSERT_EQ(static_cast<char*>(first) + 8, second);
+    ASSERT_EQ(static_cast<char*>(first) + 16, third);
+    ASSERT_EQ(1, arena.getBlockCount());
+    // Allocations not fitting into the block get a block of their own.
+    void* large = arena.allocate(1000, 64);
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(large) % 64);
+    ASSERT_EQ(2, arena.getBlockCount());
+    // Resetting reuses the blocks.
+    size_t capacity = arena.getCapacity();
+    arena.reset();
+    ASSERT_EQ(first, arena.allocate(8));
+    ASSERT_EQ(large, arena.allocate(1000, 64));
+    ASSERT_EQ(capacity, arena.getCapacity());
+}
+
+TEST(Arena, scope) {
+    Arena outer;
+    Arena inner;
+    ASSERT_EQ(nullptr, Arena::current());
+    {
+        ArenaScope outerScope(&outer);
+        ASSERT_EQ(&outer, Arena::current());
+        {
+            ArenaScope innerScope(&inner);
+            ASSERT_EQ(&inner, Arena::current());
+        }
+        ASSERT_EQ(&outer, Arena::current());
+    }
+    ASSERT_EQ(nullptr, Arena::current());
+}
+
+TEST(Arena, executionContext) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    env.addModule(ArenaModule());
+    CompileResult res = Compiler::compile(env, source);
+    ASSERT_TRUE(res);
+    auto setS = reinterpret_cast<void (*)(char*, std::string*)>(res.getFctPtr("s"));
+    auto fctP = reinterpret_cast<bool* (*)(char*)>(res.getFctPtr("p"));
+    ASSERT_EQ(nullptr, ExecutionContext::create(res)->getArena());
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res, 1024);
+    Arena* arena = ctx->getArena();
+    ASSERT_NE(nullptr, arena);
+    ArenaScope scope(arena);
+    for (int i = 0; i < 100; ++i) {
+        std::string s = i % 2 == 0 ? "a man a plan a canal panama" : "amanaplanacanalpanama";
+        setS(ctx->getDataPtr(), &s);
+        ASSERT_EQ(i % 2 != 0, *fctP(ctx->getDataPtr()));
+        arena->reset();
+    }
+    ASSERT_EQ(1, arena->getBlockCount());
+}
+
+TEST(Arena, parallelEvaluator) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    env.addModule(ArenaModule());
+    CompileResult res = Compiler::compile(env, source);
+    ASSERT_TRUE(res);
+    auto setS = reinterpret_cast<void (*)(char*, std::string*)>(res.getFctPtr("s"));
+    auto fctP = reinterpret_cast<bool* (*)(char*)>(res.getFctPtr("p"));
+    constexpr size_t count = 5000;
+    std::vector<std::string> input;
+    for (size_t i = 0; i < count; ++i) {
+        std::string half = std::to_string(i);
+        input.push_back(half + (i % 3 == 0 ? std::string(half.rbegin(), half.rend()) : "x"));
+    }
+    std::vector<char> output(count);
+    ParallelEvaluator evaluator(res, 3, 4096);
+    evaluator.run(count, 64, [&](size_t begin, size_t end, ExecutionContext& scratch) {
+        ASSERT_EQ(scratch.getArena(), Arena::current());
+        for (size_t i = begin; i < end; ++i) {
+            setS(scratch.getDataPtr(), &input[i]);
+            output[i] = *fctP(scratch.getDataPtr());
+            scratch.resetArena();
+        }
+    });
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(i % 3 == 0, output[i] != 0) << input[i];
+    }
+    // The arenas are reset per row, so they don't grow with the row count.
+    for (size_t worker = 0; worker < evaluator.getThreadCount(); ++worker) {
+        ASSERT_GE(1, evaluator.getScratchContext(worker).getArena()->getBlockCount());
+    }
+    ASSERT_EQ(nullptr, Arena::current());
+}
+
+TEST(Arena, evaluateResetsPerRow) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    env.addModule(ArenaModule());
+    CompileResult res = Compiler::compile(env, source);
+    ASSERT_TRUE(res);
+    auto setS = reinterpret_cast<void (*)(char*, std::string*)>(res.getFctPtr("s"));
+    auto fctP = reinterpret_cast<bool* (*)(char*)>(res.getFctPtr("p"));
+    constexpr size_t count = 1000;
+    std::vector<std::unique_ptr<ExecutionContext>> ctxs;
+    std::vector<char*> rctxs;
+    for (size_t i = 0; i < count; ++i) {
+        std::string s = "row " + std::to_string(i);
+        ctxs.push_back(ExecutionContext::create(res));
+        rctxs.push_back(ctxs.back()->getDataPtr());
+        setS(rctxs.back(), &s);
+    }
+    // A single chunk needs far more than one block unless the arena is reset after each row.
+    ParallelEvaluator evaluator(res, 1, 256);
+    evaluator.setChunkSize(count);
+    evaluator.evaluate({reinterpret_cast<ParallelEvaluator::ExprFct>(fctP)}, rctxs.data(), count);
+    ASSERT_EQ(1, evaluator.getScratchContext(0).getArena()->getBlockCount());
+}
+
+TEST(Arena, parallelEvaluatorKeepsCallerArena) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    env.addModule(ArenaModule());
+    CompileResult res = Compiler::compile(env, source);
+    ASSERT_TRUE(res);
+    // Without an arena block size, worker 0 (the calling thread) keeps the arena bound by the caller.
+    ParallelEvaluator evaluator(res, 1);
+    Arena arena;
+    ArenaScope scope(&arena);
+    evaluator.run(10, 64, [&](size_t, size_t, ExecutionContext& scratch) {
+        ASSERT_EQ(nullptr, scratch.getArena());
+        ASSERT_EQ(&arena, Arena::current());
+    });
+    ASSERT_EQ(&arena, Arena::current());
+}
+
+} // namespace jex
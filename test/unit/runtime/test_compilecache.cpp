@@ -0,0 +1,92 @@
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compilecache.hpp>
+#include <jex_environment.hpp>
+
+#include <gtest/gtest.h>
+
+namespace jex {
+
+TEST(CompileCache, normalizedSource) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileCache cache;
+    auto res1 = cache.compile(env, "var x: Integer; expr a: Integer = x + 1;");
+    ASSERT_TRUE(*res1);
+    ASSERT_EQ(0, cache.getHitCount());
+    ASSERT_EQ(1, cache.getMissCount());
+    // Whitespace and comments don't affect the cache key.
+    auto res2 = cache.compile(env, "var x : Integer;\n"
+                                   "// The result.\n"
+                                   "expr a: Integer = x /* plus one */ + 1;\n");
+    ASSERT_EQ(res1, res2);
+    ASSERT_EQ(1, cache.getHitCount());
+    // Different tokens, options or environments are different programs.
+    auto res3 = cache.compile(env, "var x: Integer; expr a: Integer = x + 2;");
+    ASSERT_NE(res1, res3);
+    auto res4 = cache.compile(env, "var x: Integer; expr a: Integer = x + 1;", CompileOptions{OptLevel::O0});
+    ASSERT_NE(res1, res4);
+    Environment env2;
+    env2.addModule(BuiltInsModule());
+    ASSERT_EQ(env.fingerprint(), env2.fingerprint());
+    ASSERT_EQ(res1, cache.compile(env2, "var x: Integer; expr a: Integer = x + 1;"));
+    Environment emptyEnv;
+    ASSERT_NE(env.fingerprint(), emptyEnv.fingerprint());
+    ASSERT_EQ(3, cache.size());
+    ASSERT_EQ(2, cache.getHitCount());
+    ASSERT_EQ(3, cache.getMissCount());
+}
+
+TEST(CompileCache, report) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileCache cache;
+    const char* source = "expr a : Integer = 1 + 2;";
+    std::shared_ptr<const CompileResult> withoutReport = cache.compile(env, source);
+    ASSERT_EQ(nullptr, withoutReport->getReport());
+    CompileOptions options;
+    options.d_collectReport = true;
+    std::shared_ptr<const CompileResult> withReport = cache.compile(env, source, options);
+    ASSERT_NE(withoutReport, withReport);
+    ASSERT_NE(nullptr, withReport->getReport());
+    ASSERT_EQ(withReport, cache.compile(env, source, options));
+}
+
+TEST(CompileCache, stringLiterals) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileCache cache;
+    auto res1 = cache.compile(env, "expr a: Bool = \"a\" == \"b\";");
+    auto res2 = cache.compile(env, "expr a: Bool = \"a\\\" == \\\"b\";");
+    ASSERT_NE(res1, res2);
+    ASSERT_EQ(res1, cache.compile(env, "expr a: Bool = \"a\"==\"b\";"));
+}
+
+TEST(CompileCache, errorsNotCached) {
+    Environment env;
+    CompileCache cache;
+    auto res1 = cache.compile(env, "expr a = 1 +;");
+    ASSERT_FALSE(*res1);
+    ASSERT_FALSE(res1->getMessages().empty());
+    auto res2 = cache.compile(env, "expr a = \"unterminated;");
+    ASSERT_FALSE(*res2);
+    ASSERT_EQ(0, cache.size());
+}
+
+TEST(CompileCache, removeUnused) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileCache cache;
+    auto used = cache.compile(env, "expr a: Integer = 1;");
+    cache.compile(env, "expr a: Integer = 2;");
+    ASSERT_EQ(2, cache.size());
+    cache.removeUnused();
+    ASSERT_EQ(1, cache.size());
+    ASSERT_EQ(used, cache.compile(env, "expr a: Integer = 1;"));
+    cache.clear();
+    ASSERT_EQ(0, cache.size());
+    // Cleared programs stay valid for their users.
+    ASSERT_NE(0, used->getFctPtr("a"));
+}
+
+} // namespace jex
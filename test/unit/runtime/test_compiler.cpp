@@ -1,6 +1,9 @@
 #include <jex_backend.hpp>
 #include <jex_builtins.hpp>
 #include <jex_compiler.hpp>
+#include <jex_compilereport.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_executioncontext.hpp>
 
 #include <gtest/gtest.h>
 
@@ -8,6 +11,28 @@
 
 namespace jex {
 
+namespace {
+int expensiveCalls = 0;
+
+void expensive(int64_t* res, int64_t in) {
+    ++expensiveCalls;
+    *res = in * 3;
+}
+
+// A string function without an assign variant.
+void twice(std::string* res, const std::string* in) {
+    new (res) std::string(*in + *in);
+}
+
+class ExpensiveModule : public Module {
+    void registerTypes(Registry&) const override {}
+    void registerFcts(Registry& registry) const override {
+        registry.registerFct(FctDesc<ArgInteger, ArgInteger>("expensive", expensive, NO_INTRINSIC, FctFlags::Pure));
+        registry.registerFct(FctDesc<ArgString, ArgString>("twice", twice, NO_INTRINSIC, FctFlags::Pure));
+    }
+};
+} // namespace
+
 TEST(Compiler, emptyProgram) {
     Environment env;
     CompileResult res = Compiler::compile(env, "", OptLevel::O0);
@@ -23,4 +48,422 @@ TEST(Compiler, compileError) {
     ASSERT_EQ("1.1-1.1: Error: Unexpected integer literal '1', expecting 'var', 'const', 'expr' or end of file", errMsg.str());
 }
 
+TEST(Compiler, targetCpu) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    for (const char* cpu : {"", "host", "generic"}) {
+        options.d_cpu = cpu;
+        CompileResult res = Compiler::compile(env, "expr a: Integer = 2 * 21;", options);
+        ASSERT_TRUE(res);
+        std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+        auto fctA = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("a"));
+        ASSERT_EQ(42, *fctA(ctx->getDataPtr()));
+    }
+    options.d_cpu = "no-such-cpu";
+    ASSERT_THROW(Compiler::compile(env, "expr a: Integer = 1;", options), InternalError);
+    std::stringstream ir;
+    options.d_cpu = "generic";
+    Compiler::printIR(ir, env, "expr a: Integer = 1;", options);
+    ASSERT_NE(std::string::npos, ir.str().find("target datalayout"));
+}
+
+TEST(Compiler, lazy) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_optLevel = OptLevel::O3;
+    options.d_lazy = true;
+    CompileResult res = Compiler::compile(env, "var x: Integer; expr a: Integer = x * 2; expr b: Float = 1.5 * 2.0;", options);
+    ASSERT_TRUE(res);
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    auto setX = reinterpret_cast<void(*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto fctA = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("a"));
+    auto fctB = reinterpret_cast<double* (*)(char*)>(res.getFctPtr("b"));
+    int64_t x = 21;
+    setX(ctx->getDataPtr(), &x);
+    ASSERT_EQ(42, *fctA(ctx->getDataPtr()));
+    ASSERT_EQ(3.0, *fctB(ctx->getDataPtr()));
+}
+
+TEST(Compiler, evalFcts) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_evalAll = true;
+    options.d_evalOutputs = {"b"};
+    const char* source =
+        "var x: Integer;\n"
+        "expr a: Integer = x * 2;\n"
+        "expr b: Integer = a + 1;\n"
+        "expr s: String = join(\",\", String(a), String(b));\n";
+    CompileResult res = Compiler::compile(env, source, options);
+    ASSERT_TRUE(res);
+    auto setX = reinterpret_cast<void(*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto evalAll = reinterpret_cast<void(*)(char*)>(res.getFctPtr("__eval_all"));
+    auto evalOutputs = reinterpret_cast<void(*)(char*)>(res.getFctPtr("__eval_outputs"));
+    auto fctB = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("b"));
+    auto fctS = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("s"));
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    int64_t x = 5;
+    setX(ctx->getDataPtr(), &x);
+    // b reads the result of a stored in the context, so a has to be evaluated first.
+    evalOutputs(ctx->getDataPtr());
+    ASSERT_EQ(11, *fctB(ctx->getDataPtr()));
+    x = 7;
+    setX(ctx->getDataPtr(), &x);
+    evalAll(ctx->getDataPtr());
+    ASSERT_EQ(15, *fctB(ctx->getDataPtr()));
+    ASSERT_EQ("14,15", *fctS(ctx->getDataPtr()));
+    // Outputs have to be exprs.
+    options.d_evalOutputs = {"x"};
+    CompileResult invalid = Compiler::compile(env, source, options);
+    ASSERT_FALSE(invalid);
+    ASSERT_EQ("Unknown expr 'x' selected as output", invalid.getMessages().begin()->msg);
+}
+
+TEST(Compiler, shareSubexprs) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    env.addModule(ExpensiveModule());
+    CompileOptions options;
+    options.d_evalAll = true;
+    options.d_evalOutputs = {"c"};
+    options.d_shareSubexprs = true;
+    const char* source =
+        "var x: Integer;\n"
+        "var s: String;\n"
+        "expr a: Integer = expensive(x + 1);\n"
+        "expr b: Integer = expensive(x + 1) * 2 + a;\n"
+        "expr c: Integer = if(x > 0, expensive(x + 1), 0) + expensive(x);\n"
+        "expr d: String = join(\"-\", substr(s, x, 2), substr(s, x, 2));\n";
+    CompileResult res = Compiler::compile(env, source, options);
+    ASSERT_TRUE(res);
+    auto setX = reinterpret_cast<void(*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto setS = reinterpret_cast<void(*)(char*, std::string*)>(res.getFctPtr("s"));
+    auto evalAll = reinterpret_cast<void(*)(char*)>(res.getFctPtr("__eval_all"));
+    auto evalOutputs = reinterpret_cast<void(*)(char*)>(res.getFctPtr("__eval_outputs"));
+    auto fctB = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("b"));
+    auto fctC = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("c"));
+    auto fctD = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("d"));
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    char* rctx = ctx->getDataPtr();
+    int64_t x = 1;
+    std::string s = "abcdef";
+    setX(rctx, &x);
+    setS(rctx, &s);
+    expensiveCalls = 0;
+    // expensive(x + 1) is computed once for a and b, the conditional call in c isn't shared.
+    evalAll(rctx);
+    ASSERT_EQ(3, expensiveCalls);
+    x = 2;
+    setX(rctx, &x);
+    evalOutputs(rctx);
+    ASSERT_EQ(5, expensiveCalls);
+    ASSERT_EQ(9 + 6, *fctC(rctx));
+    // The regular expr functions don't use the shared results.
+    expensiveCalls = 0;
+    ASSERT_EQ(18 + 6, *fctB(rctx));
+    ASSERT_EQ(1, expensiveCalls);
+    evalAll(rctx);
+    ASSERT_EQ("cd-cd", *fctD(rctx));
+}
+
+TEST(Compiler, contextSlots) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_layout.d_splitHotCold = true;
+    const char* source =
+        "var s: String;\n"
+        "var x: Integer;\n"
+        "const c: Integer = 3;\n"
+        "expr a: Integer = x * c;\n"
+        "expr t: String = join(\"-\", s, String(a));\n";
+    CompileResult res = Compiler::compile(env, source, options);
+    ASSERT_TRUE(res);
+    // Constants aren't stored in the context.
+    const std::vector<ContextSlotDesc>& slots = res.getContextSlots();
+    ASSERT_EQ(4, slots.size());
+    ASSERT_EQ(nullptr, res.findContextSlot("c"));
+    const ContextSlotDesc* x = res.findContextSlot("x");
+    ASSERT_NE(nullptr, x);
+    ASSERT_EQ(ContextSlotDesc::Kind::Var, x->d_kind);
+    ASSERT_EQ("Integer", x->d_typeName);
+    ASSERT_EQ(TypeKind::Value, x->d_typeKind);
+    ASSERT_EQ(8, x->d_size);
+    const ContextSlotDesc* t = res.findContextSlot("t");
+    ASSERT_EQ(ContextSlotDesc::Kind::Expr, t->d_kind);
+    ASSERT_EQ(TypeKind::Complex, t->d_typeKind);
+    for (const ContextSlotDesc& slot : slots) {
+        ASSERT_EQ(0, slot.d_offset % slot.d_alignment);
+        ASSERT_LE(slot.d_offset + slot.d_size, res.getContextSize());
+    }
+    // Access the context directly instead of calling setters.
+    auto fctA = reinterpret_cast<void (*)(char*)>(res.getFctPtr("a"));
+    auto fctT = reinterpret_cast<void (*)(char*)>(res.getFctPtr("t"));
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    char* rctx = ctx->getDataPtr();
+    *reinterpret_cast<int64_t*>(rctx + x->d_offset) = 5;
+    *reinterpret_cast<std::string*>(rctx + res.findContextSlot("s")->d_offset) = "s";
+    fctA(rctx);
+    fctT(rctx);
+    ASSERT_EQ(15, *reinterpret_cast<int64_t*>(rctx + res.findContextSlot("a")->d_offset));
+    ASSERT_EQ("s-15", *reinterpret_cast<std::string*>(rctx + t->d_offset));
+}
+
+TEST(Compiler, setAll) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_setAll = true;
+    options.d_incremental = true;
+    const char* source =
+        "var b: Bool;\n"
+        "var x: Integer;\n"
+        "var s: String;\n"
+        "expr t: String = if(b, join(\"-\", s, String(x)), s);\n"
+        "var y: Float;\n";
+    CompileResult res = Compiler::compile(env, source, options);
+    ASSERT_TRUE(res);
+    struct Input {
+        bool b;
+        int64_t x;
+        std::string s;
+        double y;
+    };
+    const std::vector<ContextSlotDesc>& record = res.getInputRecord();
+    ASSERT_EQ(4, record.size());
+    ASSERT_EQ("x", record[1].d_name);
+    ASSERT_EQ(offsetof(Input, x), record[1].d_offset);
+    ASSERT_EQ(offsetof(Input, s), record[2].d_offset);
+    ASSERT_EQ(offsetof(Input, y), record[3].d_offset);
+    auto setAll = reinterpret_cast<void (*)(char*, const Input*)>(res.getFctPtr("__set_all"));
+    auto setAllPtrs = reinterpret_cast<void (*)(char*, void* const*)>(res.getFctPtr("__set_all_ptrs"));
+    auto evalDirty = reinterpret_cast<void (*)(char*)>(res.getFctPtr("__eval_dirty"));
+    const ContextSlotDesc* t = res.findContextSlot("t");
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    char* rctx = ctx->getDataPtr();
+    Input input{true, 42, "a string exceeding the small string buffer", 1.5};
+    setAll(rctx, &input);
+    evalDirty(rctx);
+    ASSERT_EQ(input.s + "-42", *reinterpret_cast<std::string*>(rctx + t->d_offset));
+    ASSERT_EQ(1.5, *reinterpret_cast<double*>(rctx + res.findContextSlot("y")->d_offset));
+    // The setters mark the exprs dirty, so t is evaluated again.
+    bool b = false;
+    int64_t x = 7;
+    std::string s = "s";
+    double y = 2.5;
+    void* values[] = {&b, &x, &s, &y};
+    setAllPtrs(rctx, values);
+    evalDirty(rctx);
+    ASSERT_EQ("s", *reinterpret_cast<std::string*>(rctx + t->d_offset));
+    ASSERT_EQ(7, *reinterpret_cast<int64_t*>(rctx + res.findContextSlot("x")->d_offset));
+}
+
+TEST(Compiler, scratchSlots) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    const char* source =
+        "var b: Bool;\n"
+        "var x: Integer;\n"
+        "var s: String;\n"
+        "expr t: String = if(b, join(\"-\", substr(s, 0, 3), String(x)), String(x * 2));\n"
+        "expr n: Bool = substr(s, 1, 2) == \"ab\";\n";
+    CompileResult plain = Compiler::compile(env, source);
+    ASSERT_TRUE(plain);
+    CompileOptions options;
+    options.d_scratchSlots = true;
+    CompileResult res = Compiler::compile(env, source, options);
+    ASSERT_TRUE(res);
+    // The scratch slots are part of the context but internal.
+    ASSERT_GT(res.getContextSize(), plain.getContextSize());
+    ASSERT_EQ(plain.getContextSlots().size(), res.getContextSlots().size());
+    auto setB = reinterpret_cast<void (*)(char*, bool*)>(res.getFctPtr("b"));
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto setS = reinterpret_cast<void (*)(char*, std::string*)>(res.getFctPtr("s"));
+    auto fctT = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("t"));
+    auto fctN = reinterpret_cast<bool* (*)(char*)>(res.getFctPtr("n"));
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    char* rctx = ctx->getDataPtr();
+    // Results kept in scratch slots don't leak into later evaluations.
+    for (int64_t i = 0; i < 4; ++i) {
+        bool b = i % 2 == 0;
+        std::string s = i < 2 ? "xabc a string exceeding the small string buffer" : "yz";
+        setB(rctx, &b);
+        setX(rctx, &i);
+        setS(rctx, &s);
+        std::string expected = b ? s.substr(0, 3) + "-" + std::to_string(i) : std::to_string(i * 2);
+        ASSERT_EQ(expected, *fctT(rctx));
+        ASSERT_EQ(i < 2, *fctN(rctx));
+    }
+}
+
+TEST(Compiler, inPlaceResults) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    env.addModule(ExpensiveModule());
+    // u reads its own slot, so it can't be computed in place. twice doesn't have an assign
+    // variant, so its result is computed into a temporary and moved into the slot.
+    const char* source =
+        "var x: Integer;\n"
+        "var s: String;\n"
+        "expr t: String = join(\"-\", substr(s, 0, 3), String(x));\n"
+        "expr n: String = String(x * 2);\n"
+        "expr c: String = if(x > 1, s, t);\n"
+        "expr u: String = join(\"\", substr(u, 0, 4), String(x));\n"
+        "expr w: String = twice(s);\n"
+        "expr f: String = String(Float(x) * 1.5e300);\n"
+        "expr d: String = if(x > 1, substr(s, 0, 2), String(x));\n";
+    for (bool scratchSlots : {false, true}) {
+        CompileOptions options;
+        options.d_inPlaceResults = true;
+        options.d_scratchSlots = scratchSlots;
+        CompileResult res = Compiler::compile(env, source, options);
+        ASSERT_TRUE(res);
+        auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+        auto setS = reinterpret_cast<void (*)(char*, std::string*)>(res.getFctPtr("s"));
+        auto fctT = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("t"));
+        auto fctN = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("n"));
+        auto fctC = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("c"));
+        auto fctU = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("u"));
+        auto fctW = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("w"));
+        auto fctF = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("f"));
+        auto fctD = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("d"));
+        std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+        char* rctx = ctx->getDataPtr();
+        std::string u;
+        for (int64_t i = 0; i < 4; ++i) {
+            std::string s = i < 2 ? "abcd a string exceeding the small string buffer" : "yz";
+            setX(rctx, &i);
+            setS(rctx, &s);
+            std::string* t = fctT(rctx);
+            // The exprs return their slots.
+            ASSERT_EQ(t, reinterpret_cast<std::string*>(rctx + res.findContextSlot("t")->d_offset));
+            ASSERT_EQ(s.substr(0, 3) + "-" + std::to_string(i), *t);
+            ASSERT_EQ(std::to_string(i * 2), *fctN(rctx));
+            ASSERT_EQ(i > 1 ? s : *t, *fctC(rctx));
+            u = u.substr(0, 4) + std::to_string(i);
+            ASSERT_EQ(u, *fctU(rctx));
+            ASSERT_EQ(s + s, *fctW(rctx));
+            // Large floats don't fit into the small string buffer.
+            ASSERT_EQ(std::to_string(static_cast<double>(i) * 1.5e300), *fctF(rctx));
+            // The temporary of either branch is moved into the slot.
+            ASSERT_EQ(i > 1 ? s.substr(0, 2) : std::to_string(i), *fctD(rctx));
+        }
+    }
+}
+
+TEST(Compiler, incremental) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_incremental = true;
+    // n counts its evaluations, it only depends on y.
+    const char* source =
+        "var x: Integer;\n"
+        "var y: Integer;\n"
+        "expr a: Integer = x * 2;\n"
+        "expr b: Integer = a + y;\n"
+        "expr n: Integer = n + 1 + y * 0;\n";
+    CompileResult res = Compiler::compile(env, source, options);
+    ASSERT_TRUE(res);
+    auto setX = reinterpret_cast<void(*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto setY = reinterpret_cast<void(*)(char*, int64_t*)>(res.getFctPtr("y"));
+    auto evalDirty = reinterpret_cast<void(*)(char*)>(res.getFctPtr("__eval_dirty"));
+    auto fctB = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("b"));
+    auto fctN = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("n"));
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    char* rctx = ctx->getDataPtr();
+    int64_t x = 1;
+    int64_t y = 10;
+    setX(rctx, &x);
+    setY(rctx, &y);
+    evalDirty(rctx); // Evaluates everything.
+    evalDirty(rctx); // Nothing changed.
+    x = 5;
+    setX(rctx, &x);
+    evalDirty(rctx); // Evaluates a and b.
+    y = 3;
+    setY(rctx, &y);
+    evalDirty(rctx); // Evaluates b and n.
+    // b reads the result of a, so a must have been evaluated after x changed.
+    ASSERT_EQ(13, *fctB(rctx));
+    // Two evaluations by __eval_dirty, one by the direct call.
+    ASSERT_EQ(3, *fctN(rctx));
+}
+
+TEST(Compiler, incrementalManyExprs) {
+    // More exprs than fit into a single word of the dirty bitset.
+    std::string source = "var x: Integer;\nvar y: Integer;\n";
+    for (int i = 0; i < 100; ++i) {
+        source += "expr e" + std::to_string(i) + ": Integer = " + (i % 2 ? "x" : "y") + " + " + std::to_string(i) + ";\n";
+    }
+    source += "expr sum: Integer = e0 + e97 + e98 + e99;\n";
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_incremental = true;
+    CompileResult res = Compiler::compile(env, source, options);
+    ASSERT_TRUE(res);
+    auto setX = reinterpret_cast<void(*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto setY = reinterpret_cast<void(*)(char*, int64_t*)>(res.getFctPtr("y"));
+    auto evalDirty = reinterpret_cast<void(*)(char*)>(res.getFctPtr("__eval_dirty"));
+    auto fctSum = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("sum"));
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    char* rctx = ctx->getDataPtr();
+    evalDirty(rctx);
+    ASSERT_EQ(0 + 97 + 98 + 99, *fctSum(rctx));
+    int64_t x = 1000;
+    setX(rctx, &x);
+    evalDirty(rctx);
+    ASSERT_EQ(2000 + 0 + 97 + 98 + 99, *fctSum(rctx));
+    int64_t y = 10;
+    setY(rctx, &y);
+    evalDirty(rctx);
+    ASSERT_EQ(2000 + 20 + 0 + 97 + 98 + 99, *fctSum(rctx));
+}
+
+TEST(Compiler, compileReport) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    const char* source = "var x: Integer; expr a: Integer = x * 2 + 1;";
+    ASSERT_EQ(nullptr, Compiler::compile(env, source).getReport());
+    CompileOptions options;
+    options.d_collectReport = true;
+    CompileResult res = Compiler::compile(env, source, options);
+    ASSERT_TRUE(res);
+    const CompileReport* report = res.getReport();
+    ASSERT_NE(nullptr, report);
+    for (const char* phase : {"parse", "type inference", "constant folding", "code generation",
+                              "optimization", "materialization"}) {
+        ASSERT_NE(nullptr, report->getPhase(phase)) << phase;
+    }
+    ASSERT_GT(report->totalSec(), 0);
+    ASSERT_GT(report->d_astNodeCount, 0);
+    ASSERT_GT(report->d_irInstructionsBefore, report->d_irInstructionsAfter);
+    ASSERT_GT(report->d_codeBytes, 0);
+    std::stringstream str;
+    str << *report;
+    ASSERT_NE(std::string::npos, str.str().find("materialization"));
+    // Unmeasured heap growth isn't reported as 0.
+    CompileReport unmeasured;
+    unmeasured.d_phases.push_back(CompileReport::Phase{"parse", 0.001, std::nullopt});
+    unmeasured.d_phases.push_back(CompileReport::Phase{"optimization", 0.002, 4096});
+    std::stringstream unmeasuredStr;
+    unmeasuredStr << unmeasured;
+    ASSERT_NE(std::string::npos, unmeasuredStr.str().find("4.000\n"));
+    ASSERT_NE(std::string::npos, unmeasuredStr.str().find("n/a\nAST"));
+    // Lazy programs aren't materialized.
+    options.d_lazy = true;
+    CompileResult lazyRes = Compiler::compile(env, source, options);
+    ASSERT_EQ(nullptr, lazyRes.getReport()->getPhase("materialization"));
+    ASSERT_EQ(0, lazyRes.getReport()->d_codeBytes);
+    // A report is also provided for failed compilations.
+    CompileResult errorRes = Compiler::compile(env, "expr a: Integer = x;", options);
+    ASSERT_FALSE(errorRes);
+    ASSERT_NE(nullptr, errorRes.getReport()->getPhase("parse"));
+    ASSERT_EQ(nullptr, errorRes.getReport()->getPhase("code generation"));
+}
+
 } // namespace jex
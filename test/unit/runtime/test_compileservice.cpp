@@ -0,0 +1,123 @@
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compileservice.hpp>
+#include <jex_environment.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_executioncontext.hpp>
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jex {
+
+static std::string createSource(int i) {
+    std::string num = std::to_string(i);
+    return "var x : Integer;\n"
+           "const c : String = \"c" + num + "\";\n"
+           "expr a : Integer = x * " + num + " + 1;\n"
+           "expr s : String = join(c, String(a), substr(\"abc\", 0, " + num + " % 3));\n";
+}
+
+static void checkProgram(const CompileResult& program, int i) {
+    ASSERT_TRUE(program);
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(program);
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(program.getFctPtr("x"));
+    auto fctA = reinterpret_cast<int64_t* (*)(char*)>(program.getFctPtr("a"));
+    auto fctS = reinterpret_cast<std::string* (*)(char*)>(program.getFctPtr("s"));
+    int64_t x = 2;
+    setX(ctx->getDataPtr(), &x);
+    ASSERT_EQ(2 * i + 1, *fctA(ctx->getDataPtr()));
+    std::string num = std::to_string(i);
+    // Joined with c as the separator.
+    ASSERT_EQ(std::to_string(2 * i + 1) + "c" + num + std::string("abc", i % 3),
+              *fctS(ctx->getDataPtr()));
+}
+
+TEST(CompileService, compileErrors) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileService service(env, 2);
+    ASSERT_TRUE(env.isFrozen());
+    ASSERT_EQ(2, service.getThreadCount());
+    std::future<CompileResult> invalid = service.submit("expr a : Integer = ;");
+    std::future<CompileResult> valid = service.submit(createSource(1));
+    ASSERT_FALSE(invalid.get());
+    checkProgram(valid.get(), 1);
+    ASSERT_EQ(0, service.getPendingCount());
+}
+
+TEST(CompileService, concurrentSubmitters) {
+    // Stress test for concurrent compilations sharing one environment and JIT session. Build
+    // with -DTSAN=ON to check for data races.
+    constexpr int submitterCount = 4;
+    constexpr int programsPerSubmitter = 25;
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileService service(env, 4, CompileOptions{OptLevel::O1});
+    std::vector<std::future<CompileResult>> results[submitterCount];
+    std::vector<std::thread> submitters;
+    for (int t = 0; t < submitterCount; ++t) {
+        submitters.emplace_back([&, t] {
+            for (int i = 0; i < programsPerSubmitter; ++i) {
+                results[t].push_back(service.submit(createSource(t * programsPerSubmitter + i)));
+            }
+        });
+    }
+    for (std::thread& submitter : submitters) {
+        submitter.join();
+    }
+    for (int t = 0; t < submitterCount; ++t) {
+        for (int i = 0; i < programsPerSubmitter; ++i) {
+            checkProgram(results[t][i].get(), t * programsPerSubmitter + i);
+        }
+    }
+}
+
+TEST(CompileService, destructionFinishesPendingWork) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    std::vector<std::future<CompileResult>> results;
+    {
+        CompileService service(env, 1);
+        for (int i = 0; i < 10; ++i) {
+            results.push_back(service.submit(createSource(i)));
+        }
+    }
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(std::future_status::ready, results[i].wait_for(std::chrono::seconds(0)));
+        checkProgram(results[i].get(), i);
+    }
+}
+
+TEST(CompileService, callback) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    std::vector<CompileResult> results;
+    std::vector<std::thread::id> threadIds;
+    {
+        CompileService service(env, 1);
+        // The callbacks run one after the other on the only worker.
+        for (int i = 0; i < 4; ++i) {
+            service.submit(createSource(i), [&](std::future<CompileResult> result) {
+                ASSERT_EQ(std::future_status::ready, result.wait_for(std::chrono::seconds(0)));
+                results.push_back(result.get());
+                threadIds.push_back(std::this_thread::get_id());
+            });
+        }
+        service.submit("expr a : Integer = 1 +;", [&](std::future<CompileResult> result) {
+            results.push_back(result.get());
+        });
+    }
+    ASSERT_EQ(5, results.size());
+    for (int i = 0; i < 4; ++i) {
+        checkProgram(results[i], i);
+        ASSERT_NE(std::this_thread::get_id(), threadIds[i]);
+    }
+    ASSERT_FALSE(results[4]);
+}
+
+} // namespace jex
@@ -0,0 +1,132 @@
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_contextpool.hpp>
+#include <jex_environment.hpp>
+#include <jex_errorhandling.hpp>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jex {
+
+namespace {
+const char* source =
+    "var x : Integer;\n"
+    "var s : String;\n"
+    "expr a : Integer = x * 2;\n"
+    "expr t : String = join(\"-\", s, String(a));\n";
+
+CompileResult compileWithReset(Environment& env, bool incremental = false) {
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_resetFct = true;
+    options.d_incremental = incremental;
+    return Compiler::compile(env, source, options);
+}
+} // namespace
+
+TEST(ContextPool, reuse) {
+    Environment env;
+    CompileResult res = compileWithReset(env);
+    ASSERT_TRUE(res);
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto setS = reinterpret_cast<void (*)(char*, std::string*)>(res.getFctPtr("s"));
+    auto fctA = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("a"));
+    auto fctT = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("t"));
+    ContextPool pool(res, 4);
+    std::vector<char*> rctxs;
+    for (int64_t i = 0; i < 10; ++i) {
+        rctxs.push_back(pool.acquire());
+        std::string s = "a string exceeding the small string buffer " + std::to_string(i);
+        setX(rctxs.back(), &i);
+        setS(rctxs.back(), &s);
+        fctA(rctxs.back());
+        ASSERT_EQ(s + "-" + std::to_string(2 * i), *fctT(rctxs.back()));
+    }
+    ASSERT_EQ(10, pool.getLiveCount());
+    ASSERT_EQ(10, pool.getConstructedCount());
+    for (char* rctx : rctxs) {
+        pool.release(rctx);
+    }
+    ASSERT_EQ(0, pool.getLiveCount());
+    // Released contexts are reused in their initial state.
+    char* rctx = pool.acquire();
+    ASSERT_EQ(rctxs.back(), rctx);
+    ASSERT_EQ(10, pool.getConstructedCount());
+    // Strings are cleared in place and keep their capacity.
+    const std::string& s = *reinterpret_cast<std::string*>(rctx + res.findContextSlot("s")->d_offset);
+    ASSERT_TRUE(s.empty());
+    ASSERT_LE(std::string("a string exceeding the small string buffer 9").size(), s.capacity());
+    ASSERT_EQ("-0", *fctT(rctx));
+}
+
+TEST(ContextPool, resetDirtyFlags) {
+    Environment env;
+    CompileResult res = compileWithReset(env, true);
+    ASSERT_TRUE(res);
+    auto evalDirty = reinterpret_cast<void (*)(char*)>(res.getFctPtr("__eval_dirty"));
+    auto fctA = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("a"));
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+    ContextPool pool(res);
+    char* rctx = pool.acquire();
+    int64_t x = 4;
+    setX(rctx, &x);
+    evalDirty(rctx);
+    ASSERT_EQ(8, *fctA(rctx));
+    pool.release(rctx);
+    // After the reset all exprs are dirty again.
+    rctx = pool.acquire();
+    ASSERT_EQ(0, *fctA(rctx));
+    x = 3;
+    setX(rctx, &x);
+    evalDirty(rctx);
+    ASSERT_EQ(6, *fctA(rctx));
+}
+
+TEST(ContextPool, callerBuffer) {
+    Environment env;
+    CompileResult res = compileWithReset(env);
+    ASSERT_TRUE(res);
+    auto fctT = reinterpret_cast<std::string* (*)(char*)>(res.getFctPtr("t"));
+    size_t bufferSize = ContextPool::getBufferSize(res.getContextSize(), 3);
+    std::vector<char> buffer(bufferSize + 1);
+    // Unaligned buffers are aligned by the pool.
+    ContextPool pool(reinterpret_cast<ContextPool::LifetimeFct>(res.getFctPtr("__init_rctx")),
+                     reinterpret_cast<ContextPool::LifetimeFct>(res.getFctPtr("__destruct_rctx")),
+                     nullptr, res.getContextSize(), buffer.data() + 1, bufferSize);
+    char* first = pool.acquire();
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(first) % alignof(std::max_align_t));
+    pool.acquire();
+    char* last = pool.acquire();
+    ASSERT_GE(last, buffer.data());
+    ASSERT_LE(last + res.getContextSize(), buffer.data() + buffer.size());
+    ASSERT_THROW(pool.acquire(), InternalError);
+    // Without a reset function the context is destructed and constructed again.
+    pool.release(last);
+    ASSERT_EQ(last, pool.acquire());
+    ASSERT_EQ("-0", *fctT(last));
+}
+
+TEST(ContextPool, cacheLineAligned) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_resetFct = true;
+    options.d_layout.d_splitHotCold = true;
+    options.d_layout.d_cacheLineSize = 128;
+    CompileResult res = Compiler::compile(env, source, options);
+    ASSERT_TRUE(res);
+    ASSERT_EQ(128, res.getContextAlignment());
+    ContextPool pool(res, 3);
+    for (size_t i = 0; i < 4; ++i) {
+        ASSERT_EQ(0, reinterpret_cast<uintptr_t>(pool.acquire()) % 128);
+    }
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+    ASSERT_EQ(0, reinterpret_cast<uintptr_t>(ctx->getDataPtr()) % 128);
+}
+
+} // namespace jex
@@ -0,0 +1,119 @@
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_handles.hpp>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace jex {
+
+namespace {
+// One var and one expr of each built-in type the handles map to C++ types.
+const char* source =
+    "var count : Integer;\n"
+    "var rate : Float;\n"
+    "var enabled : Bool;\n"
+    "var name : StringView;\n"
+    "expr total : Float = if(enabled, rate * Float(count), 0.0);\n"
+    "expr active : Bool = enabled && total > 1.0;\n"
+    "expr prefix : StringView = substr(name, 0, 3);\n"
+    "expr label : String = join(\":\", String(prefix), String(count));\n";
+
+CompileResult compile(Environment& env, bool lazy = false) {
+    env.addModule(BuiltInsModule());
+    CompileOptions options;
+    options.d_lazy = lazy;
+    return Compiler::compile(env, source, options);
+}
+} // namespace
+
+TEST(Handles, evaluate) {
+    for (bool lazy : {false, true}) {
+        Environment env;
+        CompileResult res = compile(env, lazy);
+        ASSERT_TRUE(res);
+        VarSetter<ArgInteger> setCount(res, "count");
+        VarSetter<ArgFloat> setRate(res, "rate");
+        VarSetter<ArgBool> setEnabled(res, "enabled");
+        VarSetter<ArgStringView> setName(res, "name");
+        ExprHandle<ArgFloat> total(res, "total");
+        ExprHandle<ArgBool> active(res, "active");
+        ExprHandle<ArgStringView> prefix(res, "prefix");
+        ExprHandle<ArgString> label(res, "label");
+        ASSERT_TRUE(setCount && setRate && setEnabled && setName && total && active && prefix && label);
+        std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+        char* rctx = ctx->getDataPtr();
+        std::string name = "answer";
+        setCount(rctx, 4);
+        setRate(rctx, 0.5);
+        setEnabled(rctx, true);
+        setName(rctx, name);
+        ASSERT_EQ(2.0, total(rctx));
+        ASSERT_TRUE(active(rctx));
+        ASSERT_EQ("ans", prefix(rctx));
+        ASSERT_EQ("ans:4", label(rctx));
+        setEnabled(rctx, false);
+        ASSERT_EQ(0.0, total(rctx));
+        ASSERT_FALSE(active(rctx));
+        // The handles call the same functions as the ones looked up by name.
+        ASSERT_EQ(res.getFctPtr("total"), reinterpret_cast<uintptr_t>(total.getFct()));
+    }
+}
+
+TEST(Handles, typeMismatch) {
+    Environment env;
+    CompileResult res = compile(env);
+    ASSERT_TRUE(res);
+    ASSERT_THROW(ExprHandle<ArgInteger>(res, "total"), InternalError);
+    ASSERT_THROW(ExprHandle<ArgFloat>(res, "active"), InternalError);
+    ASSERT_THROW(VarSetter<ArgBool>(res, "rate"), InternalError);
+    // Views and strings aren't interchangeable.
+    ASSERT_THROW(ExprHandle<ArgString>(res, "prefix"), InternalError);
+    ASSERT_THROW(ExprHandle<ArgStringView>(res, "label"), InternalError);
+    ASSERT_THROW(VarSetter<ArgString>(res, "name"), InternalError);
+    // Vars and exprs can't be confused.
+    ASSERT_THROW(ExprHandle<ArgInteger>(res, "count"), InternalError);
+    ASSERT_THROW(VarSetter<ArgFloat>(res, "total"), InternalError);
+    ASSERT_THROW(ExprHandle<ArgInteger>(res, "unknown"), InternalError);
+}
+
+TEST(Handles, resolveAll) {
+    for (bool lazy : {false, true}) {
+        Environment env;
+        CompileResult res = compile(env, lazy);
+        ASSERT_TRUE(res);
+        FctTable fcts = res.resolveAll();
+        ASSERT_EQ(res.getDefinedFcts().size(), fcts.size());
+        for (const char* name : {"count", "rate", "enabled", "name", "total", "active", "prefix", "label",
+                                 "__init_rctx", "__destruct_rctx"}) {
+            const std::vector<std::string>& defined = res.getDefinedFcts();
+            ASSERT_NE(defined.end(), std::find(defined.begin(), defined.end(), name)) << name;
+            ASSERT_EQ(res.getFctPtr(name), fcts.getFctPtr(name)) << name;
+        }
+        ASSERT_THROW(fcts.getFctPtr("unknown"), InternalError);
+        VarSetter<ArgFloat> setRate(res, fcts, "rate");
+        VarSetter<ArgBool> setEnabled(res, fcts, "enabled");
+        VarSetter<ArgStringView> setName(res, fcts, "name");
+        ExprHandle<ArgFloat> total(res, fcts, "total");
+        ExprHandle<ArgStringView> prefix(res, fcts, "prefix");
+        ExprHandle<ArgString> label(res, fcts, "label");
+        std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(res);
+        setRate(ctx->getDataPtr(), 1.5);
+        setEnabled(ctx->getDataPtr(), true);
+        setName(ctx->getDataPtr(), "xy");
+        ASSERT_EQ(0.0, total(ctx->getDataPtr()));
+        // Exprs read the stored results of the exprs they reference.
+        ASSERT_EQ("xy", prefix(ctx->getDataPtr()));
+        ASSERT_EQ("xy:0", label(ctx->getDataPtr()));
+    }
+}
+
+} // namespace jex
@@ -0,0 +1,132 @@
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_compiler.hpp>
+#include <jex_environment.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_parallelevaluator.hpp>
+
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace jex {
+
+namespace {
+const char* source =
+    "var x : Integer;\n"
+    "expr a : Integer = x * 2 + 1;\n"
+    "expr s : String = join(\"-\", String(a), \"s\");\n";
+
+size_t sumRows(const ParallelEvalStats& stats) {
+    return std::accumulate(stats.d_workers.begin(), stats.d_workers.end(), size_t(0),
+                           [](size_t sum, const ParallelEvalStats::Worker& worker) {
+                               return sum + worker.d_rows;
+                           });
+}
+} // namespace
+
+TEST(ParallelEvaluator, evaluate) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileResult res = Compiler::compile(env, source);
+    ASSERT_TRUE(res);
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto fctA = reinterpret_cast<ParallelEvaluator::ExprFct>(res.getFctPtr("a"));
+    auto fctS = reinterpret_cast<ParallelEvaluator::ExprFct>(res.getFctPtr("s"));
+    constexpr size_t count = 1000;
+    std::vector<std::unique_ptr<ExecutionContext>> ctxs;
+    std::vector<char*> rctxs;
+    for (size_t i = 0; i < count; ++i) {
+        ctxs.push_back(ExecutionContext::create(res));
+        rctxs.push_back(ctxs.back()->getDataPtr());
+        int64_t x = static_cast<int64_t>(i);
+        setX(rctxs.back(), &x);
+    }
+    ParallelEvaluator evaluator(res, 4);
+    ASSERT_EQ(4, evaluator.getThreadCount());
+    evaluator.setChunkSize(16);
+    ParallelEvalStats stats = evaluator.evaluate({fctA, fctS}, rctxs.data(), count);
+    ASSERT_EQ(16, stats.d_chunkSize);
+    ASSERT_EQ(4, stats.d_workers.size());
+    ASSERT_EQ(count, sumRows(stats));
+    size_t chunks = 0;
+    for (const ParallelEvalStats::Worker& worker : stats.d_workers) {
+        chunks += worker.d_chunks;
+        ASSERT_LE(worker.d_stolenChunks, worker.d_chunks);
+    }
+    ASSERT_EQ((count + 15) / 16, chunks);
+    for (size_t i = 0; i < count; ++i) {
+        // s reads the result of a stored by the previous call.
+        std::string expected = std::to_string(2 * i + 1) + "-s";
+        ASSERT_EQ(expected, *static_cast<std::string*>(fctS(rctxs[i])));
+    }
+    // The evaluator can be reused.
+    stats = evaluator.evaluate({fctA}, rctxs.data(), 10);
+    ASSERT_EQ(10, sumRows(stats));
+    stats = evaluator.evaluate({fctA}, rctxs.data(), 0);
+    ASSERT_EQ(0, sumRows(stats));
+}
+
+TEST(ParallelEvaluator, scratchContexts) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileResult res = Compiler::compile(env, source);
+    ASSERT_TRUE(res);
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(res.getFctPtr("x"));
+    auto fctA = reinterpret_cast<int64_t* (*)(char*)>(res.getFctPtr("a"));
+    constexpr size_t count = 5000;
+    std::vector<int64_t> input(count);
+    std::iota(input.begin(), input.end(), 0);
+    std::vector<int64_t> output(count);
+    ParallelEvaluator evaluator(res, 3);
+    ParallelEvalStats stats = evaluator.run(
+        count, 2 * sizeof(int64_t), [&](size_t begin, size_t end, ExecutionContext& scratch) {
+            for (size_t i = begin; i < end; ++i) {
+                setX(scratch.getDataPtr(), &input[i]);
+                output[i] = *fctA(scratch.getDataPtr());
+            }
+        });
+    ASSERT_EQ(count, sumRows(stats));
+    ASSERT_LE(16, stats.d_chunkSize);
+    for (size_t i = 0; i < count; ++i) {
+        ASSERT_EQ(2 * input[i] + 1, output[i]);
+    }
+}
+
+TEST(ParallelEvaluator, chunkSize) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileResult res = Compiler::compile(env, source);
+    ASSERT_TRUE(res);
+    ParallelEvaluator evaluator(res, 2);
+    // Enough chunks per worker for balancing.
+    ASSERT_EQ(125, evaluator.getChunkSize(1000, 8));
+    // Large rows are limited by the cache size, but never below the minimum.
+    ASSERT_GT(1000, evaluator.getChunkSize(1'000'000, 4096));
+    ASSERT_EQ(16, evaluator.getChunkSize(1'000'000, 1 << 30));
+    evaluator.setChunkSize(7);
+    ASSERT_EQ(7, evaluator.getChunkSize(1000, 8));
+}
+
+TEST(ParallelEvaluator, exception) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileResult res = Compiler::compile(env, source);
+    ASSERT_TRUE(res);
+    ParallelEvaluator evaluator(res, 4);
+    evaluator.setChunkSize(10);
+    auto fct = [](size_t begin, size_t, ExecutionContext&) {
+        if (begin == 500) {
+            throw std::runtime_error("failed");
+        }
+    };
+    ASSERT_THROW(evaluator.run(1000, 8, fct), std::runtime_error);
+    // The evaluator is still usable afterwards.
+    ParallelEvalStats stats = evaluator.run(1000, 8, [](size_t, size_t, ExecutionContext&) {});
+    ASSERT_EQ(1000, sumRows(stats));
+}
+
+} // namespace jex
@@ -0,0 +1,127 @@
+#include <jex_backend.hpp>
+#include <jex_builtins.hpp>
+#include <jex_environment.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_programregistry.hpp>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace jex {
+
+static std::string createSource(int i) {
+    return "var x : Integer;\n"
+           "expr a : Integer = x * " + std::to_string(i) + " + 1;\n";
+}
+
+TEST(ProgramRegistry, memoryUsage) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    ProgramRegistry registry(env, SIZE_MAX, CompileOptions{OptLevel::O0});
+    registry.add("p", createSource(1));
+    ASSERT_EQ(0, registry.getUsedBytes());
+    std::shared_ptr<const CompileResult> program = registry.get("p");
+    ASSERT_TRUE(*program);
+    MemoryUsage usage = program->getMemoryUsage();
+    ASSERT_GT(usage.d_codeBytes, 0);
+    ASSERT_EQ(usage.total(), registry.getUsedBytes());
+    // Accessing a compiled program doesn't compile it again.
+    ASSERT_EQ(program, registry.get("p"));
+    ASSERT_EQ(1, registry.getCompileCount());
+    registry.remove("p");
+    ASSERT_EQ(0, registry.getUsedBytes());
+    ASSERT_THROW(registry.get("p"), InternalError);
+}
+
+TEST(ProgramRegistry, lruEviction) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    ProgramRegistry registry(env, SIZE_MAX, CompileOptions{OptLevel::O0});
+    for (int i = 0; i < 3; ++i) {
+        registry.add("p" + std::to_string(i), createSource(i));
+    }
+    size_t programBytes = registry.get("p0")->getMemoryUsage().total();
+    registry.get("p1");
+    registry.get("p2");
+    ASSERT_EQ(3, registry.getCompileCount());
+    // Use p0, so that p1 is the least recently used program.
+    registry.get("p0");
+    // Only allow for (roughly) two programs.
+    registry.setByteBudget(programBytes * 2 + programBytes / 2);
+    ASSERT_EQ(1, registry.getEvictionCount());
+    ASSERT_LE(registry.getUsedBytes(), registry.getByteBudget());
+    registry.get("p0");
+    registry.get("p2");
+    ASSERT_EQ(3, registry.getCompileCount());
+    // p1 is recompiled transparently, evicting p0.
+    std::shared_ptr<const CompileResult> p1 = registry.get("p1");
+    ASSERT_TRUE(*p1);
+    ASSERT_EQ(4, registry.getCompileCount());
+    ASSERT_EQ(2, registry.getEvictionCount());
+    registry.get("p2");
+    ASSERT_EQ(4, registry.getCompileCount());
+    // A program exceeding the budget on its own is still kept once accessed.
+    registry.setByteBudget(0);
+    ASSERT_EQ(0, registry.getUsedBytes());
+    ASSERT_EQ(registry.get("p2"), registry.get("p2"));
+    ASSERT_EQ(5, registry.getCompileCount());
+}
+
+TEST(ProgramRegistry, compileError) {
+    Environment env;
+    ProgramRegistry registry(env, SIZE_MAX);
+    registry.add("p", "expr a = 1 +;");
+    std::shared_ptr<const CompileResult> program = registry.get("p");
+    ASSERT_FALSE(*program);
+    ASSERT_FALSE(program->getMessages().empty());
+    ASSERT_EQ(0, registry.getUsedBytes());
+}
+
+TEST(ProgramRegistry, concurrentGet) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    ProgramRegistry registry(env, SIZE_MAX, CompileOptions{OptLevel::O0});
+    registry.add("p0", createSource(0));
+    registry.add("p1", createSource(1));
+    std::vector<std::shared_ptr<const CompileResult>> programs(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < programs.size(); ++i) {
+        threads.emplace_back([&, i] { programs[i] = registry.get("p" + std::to_string(i % 2)); });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    // Every program is compiled once, concurrent requests wait for the running compilation.
+    ASSERT_EQ(2, registry.getCompileCount());
+    for (size_t i = 0; i < programs.size(); ++i) {
+        ASSERT_TRUE(*programs[i]);
+        ASSERT_EQ(programs[i % 2], programs[i]);
+    }
+    ASSERT_EQ(programs[0], registry.get("p0"));
+}
+
+TEST(ProgramRegistry, replaceWhileCompiling) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    ProgramRegistry registry(env, SIZE_MAX, CompileOptions{OptLevel::O0});
+    registry.add("p", createSource(1));
+    std::shared_ptr<const CompileResult> first;
+    std::thread thread([&] { first = registry.get("p"); });
+    registry.add("p", createSource(2));
+    thread.join();
+    ASSERT_TRUE(*first);
+    // Depending on the timing, the first get() compiled either source. A compilation of the
+    // replaced source is never stored.
+    std::shared_ptr<const CompileResult> program = registry.get("p");
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(*program);
+    auto setX = reinterpret_cast<void (*)(char*, int64_t*)>(program->getFctPtr("x"));
+    auto fctA = reinterpret_cast<int64_t* (*)(char*)>(program->getFctPtr("a"));
+    int64_t x = 1;
+    setX(ctx->getDataPtr(), &x);
+    ASSERT_EQ(3, *fctA(ctx->getDataPtr()));
+}
+
+} // namespace jex
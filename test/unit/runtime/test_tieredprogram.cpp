@@ -0,0 +1,92 @@
+#include <jex_builtins.hpp>
+#include <jex_compileservice.hpp>
+#include <jex_environment.hpp>
+#include <jex_errorhandling.hpp>
+#include <jex_executioncontext.hpp>
+#include <jex_tieredprogram.hpp>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+namespace jex {
+
+namespace {
+const char* source =
+    "var x : Integer;\n"
+    "expr a : Integer = max(x, 3) * 2 + 1;\n"
+    "expr s : String = join(\", \", String(a), \"b\");\n";
+
+using SetXFct = void (*)(char*, int64_t*);
+using AFct = int64_t* (*)(char*);
+}
+
+TEST(TieredProgram, hotSwap) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileService service(env, 1);
+    TieredProgram program(source, service, 3);
+    ASSERT_TRUE(program);
+    std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(program);
+    int64_t x = 5;
+    reinterpret_cast<SetXFct>(program.getFctPtr("x"))(ctx->getDataPtr(), &x);
+    TieredFct& fctA = program.getFct("a");
+    ASSERT_EQ(&fctA, &program.getFct("a"));
+    const uintptr_t baselinePtr = program.getBaseline().getFctPtr("a");
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_EQ(baselinePtr, fctA.getFctPtr());
+    }
+    ASSERT_FALSE(program.isOptimized());
+    // The third call makes the program hot.
+    ASSERT_EQ(11, *reinterpret_cast<AFct>(fctA.getFctPtr())(ctx->getDataPtr()));
+    program.waitOptimized();
+    ASSERT_TRUE(program.isOptimized());
+    ASSERT_EQ(3, fctA.getCallCount());
+    ASSERT_NE(baselinePtr, fctA.getFctPtr());
+    // The existing context keeps working with the optimized code.
+    ASSERT_EQ(11, *reinterpret_cast<AFct>(fctA.getFctPtr())(ctx->getDataPtr()));
+    auto fctS = reinterpret_cast<std::string* (*)(char*)>(program.getFct("s").getFctPtr());
+    ASSERT_EQ("11, b", *fctS(ctx->getDataPtr()));
+    ASSERT_THROW(program.getFct("unknown"), InternalError);
+}
+
+TEST(TieredProgram, swapDuringEvaluation) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileService service(env, 1);
+    TieredProgram program(source, service, 100);
+    TieredFct& fctA = program.getFct("a");
+    std::atomic<bool> stop{false};
+    std::atomic<bool> failed{false};
+    std::thread evaluator([&] {
+        std::unique_ptr<ExecutionContext> ctx = ExecutionContext::create(program);
+        int64_t x = 7;
+        reinterpret_cast<SetXFct>(program.getFctPtr("x"))(ctx->getDataPtr(), &x);
+        while (!stop) {
+            if (*reinterpret_cast<AFct>(fctA.getFctPtr())(ctx->getDataPtr()) != 15) {
+                failed = true;
+            }
+        }
+    });
+    while (!program.isOptimized()) {
+        std::this_thread::yield();
+    }
+    stop = true;
+    evaluator.join();
+    ASSERT_FALSE(failed);
+    ASSERT_GE(fctA.getCallCount(), 100);
+}
+
+TEST(TieredProgram, compileError) {
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileService service(env, 1);
+    TieredProgram program("expr a : Integer = ;", service, 0);
+    ASSERT_FALSE(program);
+    program.optimize();
+    program.waitOptimized();
+    ASSERT_FALSE(program.isOptimized());
+}
+
+} // namespace jex
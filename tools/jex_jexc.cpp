@@ -1,10 +1,13 @@
 #include <jex_jexc.hpp>
 
+#include <jex_backend.hpp>
 #include <jex_compiler.hpp>
+#include <jex_compilereport.hpp>
 #include <jex_environment.hpp>
 #include <jex_builtins.hpp>
 
 #include <fstream>
+#include <memory>
 #include <streambuf>
 
 using namespace jex;
@@ -22,6 +25,37 @@ int main(int /*argc*/, char *argv[]) {
         std::cerr << "Error: Couldn't read " << parser.d_fileName.value() << ".\n";
         return -1;
     }
+    Environment env;
+    env.addModule(BuiltInsModule());
+    CompileOptions options{parser.d_optLevel, parser.d_useIntrinsics, parser.d_enableConstFolding};
+    options.d_cpu = parser.d_cpu;
+    options.d_collectReport = parser.d_timeReport;
+    options.d_batchFcts = parser.d_batchFcts;
+    options.d_columnar = parser.d_columnar;
+    options.d_evalAll = parser.d_evalAll;
+    options.d_evalOutputs = parser.d_evalOutputs;
+    options.d_incremental = parser.d_incremental;
+    options.d_shareSubexprs = parser.d_shareSubexprs;
+    options.d_resetFct = parser.d_resetFct;
+    options.d_setAll = parser.d_setAll;
+    options.d_scratchSlots = parser.d_scratchSlots;
+    options.d_inPlaceResults = parser.d_inPlaceResults;
+    options.d_layout.d_splitHotCold = parser.d_splitHotCold;
+    options.d_layout.d_cacheLineSize = static_cast<size_t>(parser.d_cacheLineSize);
+    // Compile ahead of time.
+    if (parser.d_emitObj || parser.d_emitShared) {
+        try {
+            if (parser.d_emitObj) {
+                Compiler::emitObject(parser.d_outFileName.value(), env, source, options);
+            } else {
+                Compiler::emitSharedLibrary(parser.d_outFileName.value(), env, source, options);
+            }
+        } catch (std::runtime_error& err) {
+            std::cerr << err.what();
+            return -1;
+        }
+        return 0;
+    }
     // Open output stream.
     std::ostream* outStream = &std::cout;
     std::unique_ptr<std::ofstream> outFileStream;
@@ -35,10 +69,31 @@ int main(int /*argc*/, char *argv[]) {
     }
     // Print IR.
     if (parser.d_printIR) {
-        Environment env;
-        env.addModule(BuiltInsModule());
         try {
-            Compiler::printIR(*outStream, env, source, parser.d_optLevel, parser.d_useIntrinsics, parser.d_enableConstFolding);
+            Compiler::printIR(*outStream, env, source, options);
+        } catch (std::runtime_error& err) {
+            std::cerr << err.what();
+            return -1;
+        }
+    }
+    // Print context layout header.
+    if (parser.d_emitHeader) {
+        try {
+            Compiler::emitHeader(*outStream, env, source, options);
+        } catch (std::runtime_error& err) {
+            std::cerr << err.what();
+            return -1;
+        }
+    }
+    // Print compile report.
+    if (parser.d_timeReport) {
+        try {
+            CompileResult result = Compiler::compile(env, source, options);
+            if (!result) {
+                std::cerr << result;
+                return -1;
+            }
+            *outStream << *result.getReport();
         } catch (std::runtime_error& err) {
             std::cerr << err.what();
             return -1;
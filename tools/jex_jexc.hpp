@@ -7,6 +7,8 @@
 #include <iostream>
 #include <map>
 #include <optional>
+#include <string>
+#include <vector>
 
 namespace jex {
 
@@ -94,7 +96,24 @@ struct JexcCmdParser {
     bool d_enableConstFolding = true;
     std::optional<std::string> d_fileName;
     std::optional<std::string> d_outFileName;
+    std::string d_cpu;
     bool d_printIR = false;
+    bool d_emitObj = false;
+    bool d_emitShared = false;
+    bool d_timeReport = false;
+    bool d_batchFcts = false;
+    bool d_columnar = false;
+    bool d_evalAll = false;
+    std::vector<std::string> d_evalOutputs;
+    bool d_incremental = false;
+    bool d_shareSubexprs = false;
+    bool d_resetFct = false;
+    bool d_splitHotCold = false;
+    int d_cacheLineSize = 0;
+    bool d_emitHeader = false;
+    bool d_setAll = false;
+    bool d_scratchSlots = false;
+    bool d_inPlaceResults = false;
 public:
     JexcCmdParser() {
         d_parser.addOption('O', "opt-level", "Optimization level to be used. Supported levels are O0 - O2.", true,
@@ -122,6 +141,78 @@ public:
            [this](const std::string& /*in*/) {
                d_printIR = true;
            });
+        d_parser.addOption('e', "emit-obj", "Compile ahead of time into an object file.", false,
+           [this](const std::string& /*in*/) {
+               d_emitObj = true;
+           });
+        d_parser.addOption('s', "emit-shared", "Compile ahead of time into a shared library.", false,
+           [this](const std::string& /*in*/) {
+               d_emitShared = true;
+           });
+        d_parser.addOption('H', "emit-header", "Print a C++ header with the context layout.", false,
+           [this](const std::string& /*in*/) {
+               d_emitHeader = true;
+           });
+        d_parser.addOption('t', "time-report", "JIT compile and print the time and memory spent per compile phase.", false,
+           [this](const std::string& /*in*/) {
+               d_timeReport = true;
+           });
+        d_parser.addOption('b', "batch", "Generate a batch variant for each expression.", false,
+           [this](const std::string& /*in*/) {
+               d_batchFcts = true;
+           });
+        d_parser.addOption('k', "columnar", "Generate a kernel evaluating all expressions on columns.", false,
+           [this](const std::string& /*in*/) {
+               d_columnar = true;
+           });
+        d_parser.addOption('a', "eval-all", "Generate a function evaluating all expressions in dependency order.", false,
+           [this](const std::string& /*in*/) {
+               d_evalAll = true;
+           });
+        d_parser.addOption('u', "eval-output", "Generate a function evaluating the given expression and its dependencies. May be repeated.", true,
+           [this](const std::string& in) {
+               d_evalOutputs.push_back(in);
+           });
+        d_parser.addOption('r', "incremental", "Generate a function re-evaluating only the expressions affected by changed variables.", false,
+           [this](const std::string& /*in*/) {
+               d_incremental = true;
+           });
+        d_parser.addOption('x', "share-subexprs", "Compute pure calls shared by several expressions once when evaluating them together.", false,
+           [this](const std::string& /*in*/) {
+               d_shareSubexprs = true;
+           });
+        d_parser.addOption('p', "reset-fct", "Generate a function resetting a context for reuse.", false,
+           [this](const std::string& /*in*/) {
+               d_resetFct = true;
+           });
+        d_parser.addOption('n', "set-all", "Generate functions setting all variables at once.", false,
+           [this](const std::string& /*in*/) {
+               d_setAll = true;
+           });
+        d_parser.addOption('z', "scratch-slots", "Keep complex temporaries in context slots reused by every evaluation.", false,
+           [this](const std::string& /*in*/) {
+               d_scratchSlots = true;
+           });
+        d_parser.addOption('j', "in-place", "Write complex expression results into their context slots directly.", false,
+           [this](const std::string& /*in*/) {
+               d_inPlaceResults = true;
+           });
+        d_parser.addOption('y', "hot-cold", "Group value slots in front of complex slots in the context.", false,
+           [this](const std::string& /*in*/) {
+               d_splitHotCold = true;
+           });
+        d_parser.addOption('w', "cache-line", "Pad the context to multiples of the given cache line size.", true,
+           [this](const std::string& in) {
+               cmdUtils::parse(&d_cacheLineSize, in);
+               // Contexts are aligned to the cache line size, which requires a power of two.
+               if (d_cacheLineSize < 0 || (d_cacheLineSize & (d_cacheLineSize - 1)) != 0) {
+                   throw std::logic_error("Invalid range");
+               }
+           });
+        d_parser.addOption('m', "cpu", "Target CPU: 'host' or a CPU name like 'x86-64-v3'.", true,
+            [this](const std::string& in) {
+                d_cpu = in;
+            });
         d_parser.addOption('o', "output-file", "Write the output to a file.", true,
             [this](const std::string& in ) {
                 d_outFileName.emplace(in);
@@ -140,6 +231,14 @@ public:
             err << "Missing file name.\n";
             return false;
         }
+        if ((d_emitObj || d_emitShared) && !d_outFileName.has_value()) {
+            err << "Missing output file name.\n";
+            return false;
+        }
+        if (d_emitObj + d_emitShared + d_printIR + d_timeReport + d_emitHeader > 1) {
+            err << "Only one output kind may be specified.\n";
+            return false;
+        }
         return true;
     }
 };